@@ -17,6 +17,9 @@ if(Boost_FOUND)
     message(STATUS "  Libraries: ${Boost_LIBRARIES}")
 endif()
 
+# Threads - parallel translation unit analysis (Boost.Asio thread pool)
+find_package(Threads REQUIRED)
+
 # LLVM/Clang - for AST-based analysis (Phase 1+)
 # On macOS with Homebrew, LLVM is keg-only so we need to set CMAKE_PREFIX_PATH
 if(APPLE AND EXISTS /opt/homebrew/opt/llvm)
@@ -25,6 +28,16 @@ endif()
 
 find_package(LLVM REQUIRED CONFIG)
 
+# LLVM's package config only accepts an exact major.minor match, so the
+# minimum is checked here: the analysis uses PrecompiledPreamble,
+# CreateInvocationOptions, SourceManager::getFileEntryRefForID and the
+# LLVM 18 PPCallbacks::InclusionDirective signature
+set(BOOST_SAFEPROFILE_MIN_LLVM_VERSION 18)
+if(LLVM_PACKAGE_VERSION VERSION_LESS BOOST_SAFEPROFILE_MIN_LLVM_VERSION)
+    message(FATAL_ERROR
+        "LLVM ${BOOST_SAFEPROFILE_MIN_LLVM_VERSION}+ is required, found ${LLVM_PACKAGE_VERSION} at ${LLVM_DIR}")
+endif()
+
 if(LLVM_FOUND)
     message(STATUS "Found LLVM ${LLVM_PACKAGE_VERSION}")
     message(STATUS "  LLVM_DIR: ${LLVM_DIR}")
@@ -4,14 +4,49 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "ast_detector.hpp"
+#include "isolation.hpp"
+#include "invocation_cache.hpp"
+#include "compilation_database.hpp"
+#include "finding_set.hpp"
+#include "preamble.hpp"
+#include "result_cache.hpp"
+#include "intake/include_graph.hpp"
+#include "intake/repository.hpp"
+#include <boost/safeprofile/version.hpp>
+#include <clang/AST/ASTConsumer.h>
 #include <clang/ASTMatchers/ASTMatchers.h>
 #include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <clang/Tooling/Tooling.h>
+#include <clang/Frontend/CompilerInstance.h>
 #include <clang/Frontend/FrontendActions.h>
+#include <clang/Frontend/PrecompiledPreamble.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Lex/HeaderSearch.h>
+#include <clang/Lex/PPCallbacks.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Lex/PreprocessorOptions.h>
 #include <clang/Tooling/CommonOptionsParser.h>
 #include <clang/Lex/Lexer.h>
-#include <fstream>
-#include <sstream>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <map>
+#include <optional>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace boost {
 namespace safeprofile {
@@ -20,59 +55,119 @@ namespace analysis {
 using namespace clang;
 using namespace clang::ast_matchers;
 
-// Callback for handling matched AST nodes
-class NewExprCallback : public MatchFinder::MatchCallback {
-public:
-    NewExprCallback(
-        std::vector<ast_finding>& findings,
-        const fs::path& source_file,
-        const profile::rule& rule
-    ) : findings_(findings), source_file_(source_file), rule_(rule) {}
+// Key identifying a file regardless of how an #include spelled its path
+static std::string canonical_key(const fs::path& file) {
+    boost::system::error_code ec;
+    auto canonical = fs::canonical(file, ec);
+    return ec ? fs::absolute(file).string() : canonical.string();
+}
 
-    void run(const MatchFinder::MatchResult& result) override {
-        const auto* new_expr = result.Nodes.getNodeAs<CXXNewExpr>("newExpr");
-        if (!new_expr) return;
+// Decides which matched locations a TU reports and which file each finding
+// is attributed to: the main file, plus any project files (headers other
+// TUs would otherwise re-analyze, or the contents of an umbrella TU whose
+// main file is synthetic)
+class location_filter {
+public:
+    // An empty main_file reports nothing from the main file itself
+    explicit location_filter(fs::path main_file, const project_file_map* project_files = nullptr)
+        : main_file_(std::move(main_file)), project_files_(project_files) {}
+
+    // The file a finding at loc belongs to, or nullptr to drop it
+    const fs::path* attribute(const SourceManager& sm, SourceLocation loc) {
+        if (sm.isInMainFile(loc)) {
+            return main_file_.empty() ? nullptr : &main_file_;
+        }
+        if (!project_files_) {
+            return nullptr;
+        }
 
-        // Skip placement new (it has placement arguments)
-        if (new_expr->getNumPlacementArgs() > 0) {
-            return;
+        FileID id = sm.getFileID(sm.getExpansionLoc(loc));
+        auto cached = attributed_.find(id);
+        if (cached != attributed_.end()) {
+            return cached->second;
         }
 
-        // Get source location
-        const SourceManager& sm = *result.SourceManager;
-        SourceLocation loc = new_expr->getBeginLoc();
+        const fs::path* file = find(sm, id);
+        attributed_[id] = file;
+        return file;
+    }
 
-        // Skip if not in main file (avoid stdlib/headers)
-        if (!sm.isInMainFile(loc)) {
-            return;
+    // Forget cached attributions; FileIDs only mean something within the
+    // parse that assigned them
+    void reset() {
+        attributed_.clear();
+    }
+
+    // The project file behind a FileID, or nullptr
+    const fs::path* find(const SourceManager& sm, FileID id) const {
+        if (!project_files_) {
+            return nullptr;
         }
 
-        unsigned int line = sm.getExpansionLineNumber(loc);
-        unsigned int column = sm.getExpansionColumnNumber(loc);
+        auto entry = sm.getFileEntryRefForID(id);
+        if (!entry) {
+            return nullptr;
+        }
 
-        // Extract code snippet
-        std::string snippet = extractSnippet(sm, new_expr);
+        auto it = project_files_->find(sm.getFileManager().getCanonicalName(*entry).str());
+        return it == project_files_->end() ? nullptr : &it->second;
+    }
 
-        // Determine if it's array or scalar new
-        std::string message = rule_.description;
-        if (new_expr->isArray()) {
-            message += " (array form)";
+private:
+    fs::path main_file_;
+    const project_file_map* project_files_;
+    llvm::DenseMap<FileID, const fs::path*> attributed_;
+};
+
+// Base for all rule callbacks: owns the per-TU findings sink and the
+// location/snippet plumbing shared by every rule
+class RuleCallback : public MatchFinder::MatchCallback {
+public:
+    RuleCallback(
+        std::vector<ast_finding>& findings,
+        location_filter& filter,
+        const profile::rule& rule
+    ) : findings_(findings), filter_(filter), rule_(rule) {}
+
+    void onStartOfTranslationUnit() override {
+        reported_.clear();  // Locations are only meaningful within one parse
+    }
+
+protected:
+    const profile::rule& rule() const { return rule_; }
+
+    // Record a finding at loc; locations outside the TU's files are ignored
+    // (avoid stdlib/headers), and so is a second match at the same spelling
+    // and expansion location (the same code reached through a template
+    // instantiation)
+    void report(
+        const SourceManager& sm,
+        SourceLocation loc,
+        SourceRange range,
+        std::string message
+    ) {
+        const fs::path* file = filter_.attribute(sm, loc);
+        if (!file) {
+            return;
+        }
+        if (!reported_.insert({sm.getSpellingLoc(loc).getRawEncoding(),
+                               sm.getExpansionLoc(loc).getRawEncoding()}).second) {
+            return;
         }
 
         findings_.push_back(ast_finding{
-            source_file_,
-            line,
-            column,
-            message,
+            *file,
+            sm.getExpansionLineNumber(loc),
+            sm.getExpansionColumnNumber(loc),
+            std::move(message),
             rule_.id,
             rule_.level,
-            snippet
+            extract_snippet(sm, range)
         });
     }
 
 private:
-    std::string extractSnippet(const SourceManager& sm, const CXXNewExpr* expr) {
-        SourceRange range = expr->getSourceRange();
+    static std::string extract_snippet(const SourceManager& sm, SourceRange range) {
         CharSourceRange char_range = CharSourceRange::getTokenRange(range);
 
         StringRef snippet_ref = Lexer::getSourceText(char_range, sm, LangOptions());
@@ -90,110 +185,68 @@ private:
     }
 
     std::vector<ast_finding>& findings_;
-    fs::path source_file_;
+    location_filter& filter_;
     profile::rule rule_;  // Store by value to avoid dangling reference
+    std::set<std::pair<SourceLocation::UIntTy, SourceLocation::UIntTy>> reported_;  // (spelling, expansion)
 };
 
-// Callback for handling delete expressions
-class DeleteExprCallback : public MatchFinder::MatchCallback {
+// Callback for handling matched AST nodes
+class NewExprCallback : public RuleCallback {
 public:
-    DeleteExprCallback(
-        std::vector<ast_finding>& findings,
-        const fs::path& source_file,
-        const profile::rule& rule
-    ) : findings_(findings), source_file_(source_file), rule_(rule) {}
+    using RuleCallback::RuleCallback;
 
     void run(const MatchFinder::MatchResult& result) override {
-        const auto* delete_expr = result.Nodes.getNodeAs<CXXDeleteExpr>("deleteExpr");
-        if (!delete_expr) return;
-
-        // Get source location
-        const SourceManager& sm = *result.SourceManager;
-        SourceLocation loc = delete_expr->getBeginLoc();
+        const auto* new_expr = result.Nodes.getNodeAs<CXXNewExpr>("newExpr");
+        if (!new_expr) return;
 
-        // Skip if not in main file (avoid stdlib/headers)
-        if (!sm.isInMainFile(loc)) {
+        // Skip placement new (it has placement arguments)
+        if (new_expr->getNumPlacementArgs() > 0) {
             return;
         }
 
-        unsigned int line = sm.getExpansionLineNumber(loc);
-        unsigned int column = sm.getExpansionColumnNumber(loc);
-
-        // Extract code snippet
-        std::string snippet = extractSnippet(sm, delete_expr);
-
-        // Determine if it's array or scalar delete
-        std::string message = rule_.description;
-        if (delete_expr->isArrayForm()) {
+        // Determine if it's array or scalar new
+        std::string message = rule().description;
+        if (new_expr->isArray()) {
             message += " (array form)";
         }
 
-        findings_.push_back(ast_finding{
-            source_file_,
-            line,
-            column,
-            message,
-            rule_.id,
-            rule_.level,
-            snippet
-        });
+        report(*result.SourceManager, new_expr->getBeginLoc(),
+               new_expr->getSourceRange(), std::move(message));
     }
+};
 
-private:
-    std::string extractSnippet(const SourceManager& sm, const CXXDeleteExpr* expr) {
-        SourceRange range = expr->getSourceRange();
-        CharSourceRange char_range = CharSourceRange::getTokenRange(range);
+// Callback for handling delete expressions
+class DeleteExprCallback : public RuleCallback {
+public:
+    using RuleCallback::RuleCallback;
 
-        StringRef snippet_ref = Lexer::getSourceText(char_range, sm, LangOptions());
-        if (snippet_ref.empty()) {
-            return "<code unavailable>";
-        }
+    void run(const MatchFinder::MatchResult& result) override {
+        const auto* delete_expr = result.Nodes.getNodeAs<CXXDeleteExpr>("deleteExpr");
+        if (!delete_expr) return;
 
-        // Limit snippet length
-        std::string snippet = snippet_ref.str();
-        if (snippet.length() > 80) {
-            snippet = snippet.substr(0, 77) + "...";
+        // Determine if it's array or scalar delete
+        std::string message = rule().description;
+        if (delete_expr->isArrayForm()) {
+            message += " (array form)";
         }
 
-        return snippet;
+        report(*result.SourceManager, delete_expr->getBeginLoc(),
+               delete_expr->getSourceRange(), std::move(message));
     }
-
-    std::vector<ast_finding>& findings_;
-    fs::path source_file_;
-    profile::rule rule_;  // Store by value to avoid dangling reference
 };
 
 // Callback for handling C-style array declarations
-class CStyleArrayCallback : public MatchFinder::MatchCallback {
+class CStyleArrayCallback : public RuleCallback {
 public:
-    CStyleArrayCallback(
-        std::vector<ast_finding>& findings,
-        const fs::path& source_file,
-        const profile::rule& rule
-    ) : findings_(findings), source_file_(source_file), rule_(rule) {}
+    using RuleCallback::RuleCallback;
 
     void run(const MatchFinder::MatchResult& result) override {
         const auto* var_decl = result.Nodes.getNodeAs<VarDecl>("arrayDecl");
         if (!var_decl) return;
 
-        // Get source location
-        const SourceManager& sm = *result.SourceManager;
-        SourceLocation loc = var_decl->getBeginLoc();
-
-        // Skip if not in main file (avoid stdlib/headers)
-        if (!sm.isInMainFile(loc)) {
-            return;
-        }
-
-        unsigned int line = sm.getExpansionLineNumber(loc);
-        unsigned int column = sm.getExpansionColumnNumber(loc);
-
-        // Extract code snippet
-        std::string snippet = extractSnippet(sm, var_decl);
-
         // Get array type information
         const auto* array_type = var_decl->getType()->getAsArrayTypeUnsafe();
-        std::string message = rule_.description;
+        std::string message = rule().description;
 
         if (const auto* const_array = dyn_cast_or_null<ConstantArrayType>(array_type)) {
             // Fixed-size array - suggest std::array
@@ -204,71 +257,22 @@ public:
             message += " Consider std::vector<T>.";
         }
 
-        findings_.push_back(ast_finding{
-            source_file_,
-            line,
-            column,
-            message,
-            rule_.id,
-            rule_.level,
-            snippet
-        });
-    }
-
-private:
-    std::string extractSnippet(const SourceManager& sm, const VarDecl* decl) {
-        SourceRange range = decl->getSourceRange();
-        CharSourceRange char_range = CharSourceRange::getTokenRange(range);
-
-        StringRef snippet_ref = Lexer::getSourceText(char_range, sm, LangOptions());
-        if (snippet_ref.empty()) {
-            return "<code unavailable>";
-        }
-
-        // Limit snippet length
-        std::string snippet = snippet_ref.str();
-        if (snippet.length() > 80) {
-            snippet = snippet.substr(0, 77) + "...";
-        }
-
-        return snippet;
+        report(*result.SourceManager, var_decl->getBeginLoc(),
+               var_decl->getSourceRange(), std::move(message));
     }
-
-    std::vector<ast_finding>& findings_;
-    fs::path source_file_;
-    profile::rule rule_;  // Store by value to avoid dangling reference
 };
 
 // Callback for handling C-style casts
-class CStyleCastCallback : public MatchFinder::MatchCallback {
+class CStyleCastCallback : public RuleCallback {
 public:
-    CStyleCastCallback(
-        std::vector<ast_finding>& findings,
-        const fs::path& source_file,
-        const profile::rule& rule
-    ) : findings_(findings), source_file_(source_file), rule_(rule) {}
+    using RuleCallback::RuleCallback;
 
     void run(const MatchFinder::MatchResult& result) override {
         const auto* cast_expr = result.Nodes.getNodeAs<CStyleCastExpr>("cStyleCast");
         if (!cast_expr) return;
 
-        // Get source location
-        const SourceManager& sm = *result.SourceManager;
-        SourceLocation loc = cast_expr->getBeginLoc();
-
-        // Skip if not in main file (avoid stdlib/headers)
-        if (!sm.isInMainFile(loc)) {
-            return;
-        }
-
-        unsigned int line = sm.getExpansionLineNumber(loc);
-        unsigned int column = sm.getExpansionColumnNumber(loc);
-
-        // Extract code snippet
-        std::string snippet = extractSnippet(sm, cast_expr);
-
         // Build message with type information
-        std::string message = rule_.description;
+        std::string message = rule().description;
 
         // Get cast type names for better diagnostics
         QualType source_type = cast_expr->getSubExpr()->getType();
@@ -277,49 +281,15 @@ public:
         message += " Casting from '" + source_type.getAsString() +
                    "' to '" + dest_type.getAsString() + "'.";
 
-        findings_.push_back(ast_finding{
-            source_file_,
-            line,
-            column,
-            message,
-            rule_.id,
-            rule_.level,
-            snippet
-        });
-    }
-
-private:
-    std::string extractSnippet(const SourceManager& sm, const CStyleCastExpr* expr) {
-        SourceRange range = expr->getSourceRange();
-        CharSourceRange char_range = CharSourceRange::getTokenRange(range);
-
-        StringRef snippet_ref = Lexer::getSourceText(char_range, sm, LangOptions());
-        if (snippet_ref.empty()) {
-            return "<code unavailable>";
-        }
-
-        // Limit snippet length
-        std::string snippet = snippet_ref.str();
-        if (snippet.length() > 80) {
-            snippet = snippet.substr(0, 77) + "...";
-        }
-
-        return snippet;
+        report(*result.SourceManager, cast_expr->getBeginLoc(),
+               cast_expr->getSourceRange(), std::move(message));
     }
-
-    std::vector<ast_finding>& findings_;
-    fs::path source_file_;
-    profile::rule rule_;  // Store by value to avoid dangling reference
 };
 
 // Callback for detecting return of reference/pointer to local variable
-class ReturnLocalRefCallback : public MatchFinder::MatchCallback {
+class ReturnLocalRefCallback : public RuleCallback {
 public:
-    ReturnLocalRefCallback(
-        std::vector<ast_finding>& findings,
-        const fs::path& source_file,
-        const profile::rule& rule
-    ) : findings_(findings), source_file_(source_file), rule_(rule) {}
+    using RuleCallback::RuleCallback;
 
     void run(const MatchFinder::MatchResult& result) override {
         const auto* ret_stmt = result.Nodes.getNodeAs<ReturnStmt>("returnStmt");
@@ -327,305 +297,2145 @@ public:
 
         if (!ret_stmt || !decl_ref) return;
 
-        // Get source location
-        const SourceManager& sm = *result.SourceManager;
-        SourceLocation loc = ret_stmt->getBeginLoc();
-
-        // Skip if not in main file
-        if (!sm.isInMainFile(loc)) {
-            return;
-        }
-
-        unsigned int line = sm.getExpansionLineNumber(loc);
-        unsigned int column = sm.getExpansionColumnNumber(loc);
-
-        // Extract code snippet
-        std::string snippet = extractSnippet(sm, ret_stmt);
-
         // Get variable name for better diagnostics
         const auto* var_decl = dyn_cast<VarDecl>(decl_ref->getDecl());
         std::string var_name = var_decl ? var_decl->getNameAsString() : "<unknown>";
 
-        std::string message = rule_.description +
+        std::string message = rule().description +
                             " Variable '" + var_name + "' will be destroyed.";
 
-        findings_.push_back(ast_finding{
-            source_file_,
-            line,
-            column,
-            message,
-            rule_.id,
-            rule_.level,
-            snippet
-        });
+        report(*result.SourceManager, ret_stmt->getBeginLoc(),
+               ret_stmt->getSourceRange(), std::move(message));
     }
+};
 
-private:
-    std::string extractSnippet(const SourceManager& sm, const ReturnStmt* stmt) {
-        SourceRange range = stmt->getSourceRange();
-        CharSourceRange char_range = CharSourceRange::getTokenRange(range);
+// Creates a rule's callback bound to one TU's findings sink
+using callback_factory = std::unique_ptr<MatchFinder::MatchCallback> (*)(
+    std::vector<ast_finding>&, location_filter&, const profile::rule&);
 
-        StringRef snippet_ref = Lexer::getSourceText(char_range, sm, LangOptions());
-        if (snippet_ref.empty()) {
-            return "<code unavailable>";
+template <typename Callback>
+std::unique_ptr<MatchFinder::MatchCallback> make_callback(
+    std::vector<ast_finding>& findings,
+    location_filter& filter,
+    const profile::rule& rule
+) {
+    return std::make_unique<Callback>(findings, filter, rule);
+}
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// TUs with equal keys have identical compiler arguments, which are derived
+// from their compilation flags; only such TUs may share a parse
+std::string flags_key(const std::vector<std::string>& args) {
+    std::string key;
+    for (const auto& arg : args) {
+        key += arg;
+        key += '\0';
+    }
+    return key;
+}
+
+// Enforces analysis_limits for one frontend run
+// Clang has no mid-parse cancellation API, so once a limit trips the guard
+// reports a fatal diagnostic (which stops further #include processing and
+// template instantiation) and the consumer refuses further top-level decls,
+// which ends the parse
+class tu_guard {
+public:
+    explicit tu_guard(const analysis_limits& limits)
+        : limits_(limits), start_(std::chrono::steady_clock::now()) {}
+
+    void attach(DiagnosticsEngine& diags) { diags_ = &diags; }
+    void attach(const ASTContext& context) { context_ = &context; }
+
+    /// Returns true once a limit has been hit
+    bool check() {
+        if (tripped_) {
+            return true;
         }
 
-        // Limit snippet length
-        std::string snippet = snippet_ref.str();
-        if (snippet.length() > 80) {
-            snippet = snippet.substr(0, 77) + "...";
+        if (limits_.time_budget_seconds > 0.0 &&
+            seconds_since(start_) > limits_.time_budget_seconds) {
+            trip("Time budget of " + std::to_string(limits_.time_budget_seconds) + "s exceeded");
+        } else if (limits_.max_ast_memory_mb > 0 && context_ &&
+                   context_->getASTAllocatedMemory() > limits_.max_ast_memory_mb * 1024 * 1024) {
+            trip("AST size limit of " + std::to_string(limits_.max_ast_memory_mb) + " MB exceeded");
         }
 
-        return snippet;
+        return tripped_;
     }
 
-    std::vector<ast_finding>& findings_;
-    fs::path source_file_;
-    profile::rule rule_;
-};
+    bool tripped() const { return tripped_; }
+    const std::string& reason() const { return reason_; }
 
-file_analysis_result ast_detector::analyze_file(
-    const fs::path& source_file,
-    const profile::rule& rule
-) const {
-    file_analysis_result result;
-    result.file = source_file;
-    result.success = false;
+private:
+    void trip(std::string reason) {
+        tripped_ = true;
+        reason_ = std::move(reason);
 
-    std::vector<ast_finding> findings;
+        if (diags_) {
+            unsigned id = diags_->getCustomDiagID(DiagnosticsEngine::Fatal, "%0");
+            diags_->Report(id) << reason_;
+        }
+    }
 
-    // Set up match finder based on rule ID
-    MatchFinder finder;
+    analysis_limits limits_;
+    std::chrono::steady_clock::time_point start_;
+    DiagnosticsEngine* diags_ = nullptr;
+    const ASTContext* context_ = nullptr;
+    bool tripped_ = false;
+    std::string reason_;
+};
 
-    // Allocate callback on stack but ensure it lives through the analysis
-    std::unique_ptr<MatchFinder::MatchCallback> callback;
-
-    if (rule.id == "SP-OWN-001") {
-        // Naked new expression matcher
-        auto matcher = cxxNewExpr(
-            isExpansionInMainFile()
-        ).bind("newExpr");
-
-        callback = std::make_unique<NewExprCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-OWN-002") {
-        // Naked delete expression matcher
-        auto matcher = cxxDeleteExpr(
-            isExpansionInMainFile()
-        ).bind("deleteExpr");
-
-        callback = std::make_unique<DeleteExprCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-BOUNDS-001") {
-        // C-style array declaration matcher
-        auto matcher = varDecl(
-            hasType(arrayType()),
-            isExpansionInMainFile()
-        ).bind("arrayDecl");
-
-        callback = std::make_unique<CStyleArrayCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-TYPE-001") {
-        // C-style cast matcher
-        auto matcher = cStyleCastExpr(
-            isExpansionInMainFile()
-        ).bind("cStyleCast");
-
-        callback = std::make_unique<CStyleCastCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-LIFE-003") {
-        // Return reference/pointer to local variable matcher
-        // Matches: return &local_var or return local_ref
-        // Excludes parameters (they're safe to return)
-        auto matcher = returnStmt(
-            hasReturnValue(
-                anyOf(
-                    // Case 1: return &local_var (address-of local)
-                    unaryOperator(
-                        hasOperatorName("&"),
-                        hasUnaryOperand(declRefExpr(
-                            to(varDecl(
-                                hasAutomaticStorageDuration(),
-                                unless(parmVarDecl())  // Exclude parameters
-                            ))
-                        ).bind("localVar"))
-                    ),
-                    // Case 2: return local_ref (reference already)
-                    declRefExpr(
-                        to(varDecl(
-                            hasAutomaticStorageDuration(),
-                            unless(parmVarDecl())  // Exclude parameters
-                        ))
-                    ).bind("localVar")
-                )
-            ),
-            isExpansionInMainFile()
-        ).bind("returnStmt");
-
-        callback = std::make_unique<ReturnLocalRefCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else {
-        // Unsupported rule
-        result.error_message = "Unsupported rule: " + rule.id;
-        return result;
-    }
+// Polls the guard from the preprocessor, which makes progress even while
+// the parser is deep inside one huge namespace or class
+class LimitCallbacks : public PPCallbacks {
+public:
+    explicit LimitCallbacks(tu_guard& guard) : guard_(guard) {}
 
-    // Get compiler arguments (from compilation database or defaults)
-    std::vector<std::string> args;
+    void FileChanged(SourceLocation, FileChangeReason, SrcMgr::CharacteristicKind,
+                     FileID) override {
+        guard_.check();
+    }
 
-    if (compile_db_ && compile_db_->is_loaded()) {
-        auto flags_opt = compile_db_->get_flags_for_file(source_file);
-        if (flags_opt) {
-            args = build_compiler_args(*flags_opt);
-        } else {
-            // File not in compilation database, use defaults
-            args = get_default_compiler_args();
+    void MacroExpands(const Token&, const MacroDefinition&, SourceRange,
+                      const MacroArgs*) override {
+        // Reading the clock on every expansion would be measurable
+        if ((++expansions_ & 0xFF) == 0) {
+            guard_.check();
         }
-    } else {
-        args = get_default_compiler_args();
     }
 
-    return analyze_file_with_flags(source_file, rule, args);
-}
+private:
+    tu_guard& guard_;
+    unsigned int expansions_ = 0;
+};
 
-file_analysis_result ast_detector::analyze_file_with_flags(
-    const fs::path& source_file,
-    const profile::rule& rule,
-    const std::vector<std::string>& compiler_args
-) const {
-    file_analysis_result result;
-    result.file = source_file;
-    result.success = false;
+// Which files of a TU the matchers report on, and how far parsing and
+// matching are narrowed to them
+struct tu_focus {
+    match_scope scope = match_scope::main_file;
+    bool traversal_scope = false;  // Traverse only top-level decls in scope
+    bool skip_bodies = false;      // Skip parsing function bodies outside scope
+    location_filter* files = nullptr;  // With project_files: the project files in scope
+
+    // The main file, plus the project files the TU reports on; other
+    // non-system headers (-I dependencies) are out of scope
+    bool contains(const SourceManager& sm, SourceLocation loc) const {
+        loc = sm.getExpansionLoc(loc);
+        if (loc.isInvalid()) {
+            return false;
+        }
+        if (sm.isInMainFile(loc)) {
+            return true;
+        }
+        return scope == match_scope::project_files && files && files->attribute(sm, loc);
+    }
+};
 
-    std::vector<ast_finding> findings;
+// Runs the fused MatchFinder over the finished AST and times the match phase
+// With a traversal scope, only top-level declarations written in the files
+// the matchers report on are traversed, instead of everything the TU included
+class MatchConsumer : public ASTConsumer {
+public:
+    MatchConsumer(MatchFinder& finder, tu_guard& guard, double& match_seconds, tu_focus focus)
+        : finder_(finder), guard_(guard), match_seconds_(match_seconds), focus_(focus) {}
 
-    // Set up match finder (same logic as before)
-    MatchFinder finder;
-    std::unique_ptr<MatchFinder::MatchCallback> callback;
-
-    // [Matcher setup code - same as in analyze_file above]
-    if (rule.id == "SP-OWN-001") {
-        auto matcher = cxxNewExpr(isExpansionInMainFile()).bind("newExpr");
-        callback = std::make_unique<NewExprCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-OWN-002") {
-        auto matcher = cxxDeleteExpr(isExpansionInMainFile()).bind("deleteExpr");
-        callback = std::make_unique<DeleteExprCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-BOUNDS-001") {
-        auto matcher = varDecl(hasType(arrayType()), isExpansionInMainFile()).bind("arrayDecl");
-        callback = std::make_unique<CStyleArrayCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-TYPE-001") {
-        auto matcher = cStyleCastExpr(isExpansionInMainFile()).bind("cStyleCast");
-        callback = std::make_unique<CStyleCastCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else if (rule.id == "SP-LIFE-003") {
-        auto matcher = returnStmt(
-            hasReturnValue(
-                anyOf(
-                    unaryOperator(
-                        hasOperatorName("&"),
-                        hasUnaryOperand(declRefExpr(
-                            to(varDecl(
-                                hasAutomaticStorageDuration(),
-                                unless(parmVarDecl())
-                            ))
-                        ).bind("localVar"))
-                    ),
-                    declRefExpr(
-                        to(varDecl(
-                            hasAutomaticStorageDuration(),
-                            unless(parmVarDecl())
-                        ))
-                    ).bind("localVar")
-                )
-            ),
-            isExpansionInMainFile()
-        ).bind("returnStmt");
-        callback = std::make_unique<ReturnLocalRefCallback>(findings, source_file, rule);
-        finder.addMatcher(matcher, callback.get());
-    }
-    else {
-        result.error_message = "Unsupported rule: " + rule.id;
-        return result;
+    void Initialize(ASTContext& context) override {
+        guard_.attach(context);
+        context_ = &context;
     }
 
-    // Read source file content
-    std::ifstream ifs(source_file.string());
-    if (!ifs) {
-        result.error_message = "Failed to read file";
-        return result;
+    bool HandleTopLevelDecl(DeclGroupRef) override {
+        // Returning false stops the parser
+        return !guard_.check();
     }
 
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    std::string source_code = buffer.str();
+    void HandleInlineFunctionDefinition(FunctionDecl*) override {
+        guard_.check();
+    }
 
-    // Run Clang tooling with provided compiler args
-    auto factory = tooling::newFrontendActionFactory(&finder);
-    if (!tooling::runToolOnCodeWithArgs(
-        factory->create(),
-        source_code,
-        compiler_args,
-        source_file.filename().string()
-    )) {
-        // Analysis failed - compilation error
-        result.error_message = "Compilation failed (syntax error, missing includes, or type error)";
-        return result;
+    void HandleTagDeclDefinition(TagDecl*) override {
+        guard_.check();
     }
 
-    // Success!
-    result.success = true;
-    result.findings = std::move(findings);
-    return result;
-}
+    // Only asked when the frontend skips function bodies; Sema itself keeps
+    // the bodies of constexpr functions and functions with deduced types
+    bool shouldSkipFunctionBody(Decl* decl) override {
+        return !focus_.contains(context_->getSourceManager(), decl->getLocation());
+    }
 
-std::vector<ast_finding> ast_detector::analyze_files(
-    const std::vector<fs::path>& source_files,
-    const std::vector<profile::rule>& rules,
-    std::vector<file_analysis_result>& failed_files
-) const {
-    std::vector<ast_finding> all_findings;
-    failed_files.clear();
+    void HandleTranslationUnit(ASTContext& context) override {
+        if (guard_.check()) {
+            return;  // Partial AST; the TU is reported as limit_exceeded
+        }
 
-    for (const auto& file : source_files) {
-        for (const auto& rule : rules) {
-            auto result = analyze_file(file, rule);
+        auto start = std::chrono::steady_clock::now();
+        if (focus_.traversal_scope) {
+            context.setTraversalScope(scope_decls(context));
+        }
+        finder_.matchAST(context);
+        match_seconds_ = seconds_since(start);
+    }
 
-            if (result.success) {
-                // Add findings from successful analysis
-                all_findings.insert(
-                    all_findings.end(),
-                    result.findings.begin(),
-                    result.findings.end()
-                );
-            } else {
-                // Track failed file (only record once per file, not per rule)
-                bool already_recorded = false;
-                for (const auto& failed : failed_files) {
-                    if (failed.file == file) {
-                        already_recorded = true;
-                        break;
-                    }
-                }
-                if (!already_recorded) {
-                    failed_files.push_back(result);
+private:
+    std::vector<Decl*> scope_decls(ASTContext& context) const {
+        const auto& sm = context.getSourceManager();
+
+        // The main file is never precompiled, so its declarations are all
+        // local; project headers may come from a precompiled include prefix
+        auto* unit = context.getTranslationUnitDecl();
+        std::vector<Decl*> decls;
+        auto collect = [&](auto range) {
+            for (Decl* decl : range) {
+                if (focus_.contains(sm, decl->getBeginLoc()) || focus_.contains(sm, decl->getEndLoc())) {
+                    decls.push_back(decl);
                 }
             }
+        };
+        if (focus_.scope == match_scope::main_file) {
+            collect(unit->noload_decls());
+        } else {
+            collect(unit->decls());
+        }
+        return decls;
+    }
+
+    MatchFinder& finder_;
+    tu_guard& guard_;
+    double& match_seconds_;
+    tu_focus focus_;
+    ASTContext* context_ = nullptr;
+};
+
+// Records the project headers a TU enters, i.e. the edges of the include
+// graph from this TU
+class IncludeRecorder : public PPCallbacks {
+public:
+    IncludeRecorder(const SourceManager& sm, const location_filter& filter,
+                    std::vector<fs::path>& included)
+        : sm_(sm), filter_(filter), included_(included) {}
+
+    void FileChanged(SourceLocation loc, FileChangeReason reason, SrcMgr::CharacteristicKind,
+                     FileID) override {
+        if (reason != EnterFile) {
+            return;
+        }
+        if (const fs::path* header = filter_.find(sm_, sm_.getFileID(loc))) {
+            included_.push_back(*header);
+        }
+    }
+
+private:
+    const SourceManager& sm_;
+    const location_filter& filter_;
+    std::vector<fs::path>& included_;
+};
+
+// Collects every file a TU reads, including system headers and the inputs
+// of a precompiled include prefix, for the result cache
+// An #include that was not found records each path it was looked up at, so
+// the cached failure is dropped once the header appears at any of them
+class DependencyRecorder : public DependencyCollector {
+public:
+    explicit DependencyRecorder(std::string ignored_prefix)
+        : ignored_prefix_(std::move(ignored_prefix)) {}
+
+    bool needSystemDependencies() override { return true; }
+    bool addMissingFiles() override { return true; }
+
+    void attachToPreprocessor(Preprocessor& pp) override {
+        DependencyCollector::attachToPreprocessor(pp);
+        pp.addPPCallbacks(std::make_unique<MissingIncludes>(pp, *this));
+    }
+
+    bool sawDependency(StringRef file, bool from_module, bool is_system,
+                       bool is_module_file, bool is_missing) override {
+        // The PCH and its synthetic prefix header are per-run temporaries
+        if (is_module_file || (!ignored_prefix_.empty() && file.starts_with(ignored_prefix_))) {
+            return false;
+        }
+        // A missing include as spelled means nothing outside its search
+        // path; MissingIncludes adds the resolved candidates instead
+        if (is_missing && !llvm::sys::path::is_absolute(file)) {
+            return false;
+        }
+        return DependencyCollector::sawDependency(file, from_module, is_system,
+                                                  is_module_file, is_missing);
+    }
+
+private:
+    class MissingIncludes : public PPCallbacks {
+    public:
+        MissingIncludes(const Preprocessor& pp, DependencyCollector& collector)
+            : pp_(pp), collector_(collector) {}
+
+        void InclusionDirective(SourceLocation hash_loc, const Token&, StringRef file_name,
+                                bool is_angled, CharSourceRange, OptionalFileEntryRef file,
+                                StringRef, StringRef, const Module*, bool,
+                                SrcMgr::CharacteristicKind) override {
+            if (file) {
+                return;
+            }
+            auto add = [&](StringRef directory) {
+                llvm::SmallString<256> candidate(directory);
+                llvm::sys::path::append(candidate, file_name);
+                collector_.maybeAddDependency(candidate, false, false, false, true);
+            };
+
+            if (llvm::sys::path::is_absolute(file_name)) {
+                add(StringRef());
+                return;
+            }
+
+            const auto& sm = pp_.getSourceManager();
+            if (!is_angled) {
+                if (auto includer = sm.getFileEntryRefForID(sm.getFileID(sm.getExpansionLoc(hash_loc)))) {
+                    add(includer->getDir().getName());
+                }
+            }
+            const auto& search = pp_.getHeaderSearchInfo();
+            for (auto it = is_angled ? search.angled_dir_begin() : search.search_dir_begin();
+                 it != search.search_dir_end(); ++it) {
+                if (auto directory = it->getDirRef()) {
+                    add(directory->getName());
+                }
+            }
+        }
+
+    private:
+        const Preprocessor& pp_;
+        DependencyCollector& collector_;
+    };
+
+    std::string ignored_prefix_;
+};
+
+// Optional per-TU instrumentation for MatchAction
+struct tu_hooks {
+    const location_filter* filter = nullptr;     // With `included`: record project headers
+    std::vector<fs::path>* included = nullptr;
+    std::shared_ptr<DependencyCollector> dependencies;
+};
+
+class MatchAction : public ASTFrontendAction {
+public:
+    MatchAction(MatchFinder& finder, tu_guard& guard, double& match_seconds,
+                tu_focus focus, tu_hooks hooks = {})
+        : finder_(finder), guard_(guard), match_seconds_(match_seconds),
+          focus_(focus), hooks_(std::move(hooks)) {}
+
+protected:
+    void ExecuteAction() override {
+        // Read by the parser when the action runs
+        getCompilerInstance().getFrontendOpts().SkipFunctionBodies = focus_.skip_bodies;
+        ASTFrontendAction::ExecuteAction();
+    }
+
+    std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance& ci, StringRef) override {
+        guard_.attach(ci.getDiagnostics());
+        ci.getPreprocessor().addPPCallbacks(std::make_unique<LimitCallbacks>(guard_));
+        if (hooks_.filter && hooks_.included) {
+            ci.getPreprocessor().addPPCallbacks(std::make_unique<IncludeRecorder>(
+                ci.getSourceManager(), *hooks_.filter, *hooks_.included));
+        }
+        if (hooks_.dependencies) {
+            // The preprocessor already exists; the PCH reader (if any) is
+            // created later and picks the collector up from the instance
+            hooks_.dependencies->attachToPreprocessor(ci.getPreprocessor());
+            ci.addDependencyCollector(hooks_.dependencies);
+        }
+        return std::make_unique<MatchConsumer>(finder_, guard_, match_seconds_, focus_);
+    }
+
+private:
+    MatchFinder& finder_;
+    tu_guard& guard_;
+    double& match_seconds_;
+    tu_focus focus_;
+    tu_hooks hooks_;
+};
+
+// Attributes each error in an umbrella TU to the header the umbrella
+// included directly, whichever file the error was reported in
+class include_blame : public DiagnosticConsumer {
+public:
+    explicit include_blame(const location_filter& headers) : headers_(headers) {}
+
+    void HandleDiagnostic(DiagnosticsEngine::Level level, const Diagnostic& info) override {
+        DiagnosticConsumer::HandleDiagnostic(level, info);  // Keeps error counts
+
+        if (level < DiagnosticsEngine::Error || !info.hasSourceManager() ||
+            info.getLocation().isInvalid()) {
+            return;
+        }
+
+        const auto& sm = info.getSourceManager();
+        FileID id = sm.getFileID(sm.getExpansionLoc(info.getLocation()));
+
+        // Climb the include stack to the file the umbrella included
+        for (;;) {
+            SourceLocation include = sm.getIncludeLoc(id);
+            if (include.isInvalid()) {
+                return;  // The umbrella itself
+            }
+            FileID parent = sm.getFileID(include);
+            if (parent == sm.getMainFileID()) {
+                break;
+            }
+            id = parent;
+        }
+
+        if (const fs::path* header = headers_.find(sm, id)) {
+            blamed_.insert(*header);
+        }
+    }
+
+    std::vector<fs::path> blamed() const {
+        return {blamed_.begin(), blamed_.end()};
+    }
+
+private:
+    const location_filter& headers_;
+    std::set<fs::path> blamed_;
+};
+
+// What a TU the lexical prefilter skipped depends on besides its own text
+std::vector<std::string> header_dependencies(const project_file_map* project_headers) {
+    std::vector<std::string> dependencies;
+    if (project_headers) {
+        for (const auto& entry : *project_headers) {
+            dependencies.push_back(fs::absolute(entry.second).string());
+        }
+        std::sort(dependencies.begin(), dependencies.end());
+    }
+    return dependencies;
+}
+
+// Run a frontend action over a main file provided by `file_system`
+// Diagnostics go to `diagnostics` if given, otherwise to stderr
+bool run_tool(
+    std::unique_ptr<FrontendAction> action,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system,
+    const std::vector<std::string>& args,
+    const std::string& file_name,
+    DiagnosticConsumer* diagnostics = nullptr
+) {
+    if (!diagnostics) {
+        return tooling::runToolOnCodeWithArgs(std::move(action), "", file_system, args, file_name);
+    }
+
+    std::vector<std::string> command_line = {"clang-tool", "-fsyntax-only"};
+    command_line.insert(command_line.end(), args.begin(), args.end());
+    command_line.push_back(file_name);
+
+    auto files = llvm::makeIntrusiveRefCnt<FileManager>(FileSystemOptions(), file_system);
+    tooling::ToolInvocation invocation(std::move(command_line), std::move(action), files.get());
+    invocation.setDiagnosticConsumer(diagnostics);
+    return invocation.run();
+}
+
+// Run a frontend action on an invocation the driver already produced,
+// the rest of what run_tool() does
+bool run_invocation(
+    std::unique_ptr<FrontendAction> action,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system,
+    std::shared_ptr<CompilerInvocation> invocation
+) {
+    CompilerInstance compiler(std::make_shared<PCHContainerOperations>());
+    compiler.setInvocation(std::move(invocation));
+    compiler.createDiagnostics();
+    compiler.createFileManager(file_system);
+    compiler.createSourceManager(compiler.getFileManager());
+    return compiler.ExecuteAction(*action) && !compiler.getDiagnostics().hasErrorOccurred();
+}
+
+// Reads a batch's main files straight from disk and everything else through
+// the shared cache, which would otherwise keep every main file's contents
+// alive for the detector's lifetime. Expects absolute paths, as
+// working_directory_file_system passes them on.
+class main_file_bypass : public llvm::vfs::ProxyFileSystem {
+public:
+    main_file_bypass(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> cache,
+                     const std::vector<std::string>& main_files)
+        : ProxyFileSystem(std::move(cache)), disk_(llvm::vfs::getRealFileSystem()) {
+        for (const auto& file : main_files) {
+            main_files_.insert(normalized(file));
+        }
+    }
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+        return is_main_file(path) ? disk_->status(path) : ProxyFileSystem::status(path);
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(const llvm::Twine& path) override {
+        return is_main_file(path) ? disk_->openFileForRead(path) : ProxyFileSystem::openFileForRead(path);
+    }
+
+private:
+    static std::string normalized(const llvm::Twine& path) {
+        llvm::SmallString<256> result;
+        path.toVector(result);
+        llvm::sys::path::remove_dots(result, /*remove_dot_dot=*/true);
+        return result.str().str();
+    }
+
+    bool is_main_file(const llvm::Twine& path) const {
+        return main_files_.count(normalized(path)) != 0;
+    }
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> disk_;
+    std::unordered_set<std::string> main_files_;
+};
+
+// What analyze_files needs from a main file before parsing it: its content
+// hash for the result cache key and its include prefix for PCH planning.
+// Both come from one private mapping, so the shared cache never holds main
+// files; a file that cannot be read has neither.
+struct main_file_summary {
+    std::optional<std::string> hash;
+    include_prefix prefix;
+};
+
+main_file_summary summarize_main_file(const fs::path& file, bool hash, bool prefix) {
+    main_file_summary summary;
+    if (!hash && !prefix) {
+        return summary;
+    }
+
+    auto mapped = llvm::MemoryBuffer::getFile(fs::absolute(file).string(), /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (!mapped) {
+        return summary;
+    }
+    const llvm::StringRef contents = (*mapped)->getBuffer();
+
+    if (hash) {
+        // Same digest as caching_file_system::content_hash
+        llvm::SHA1 sha1;
+        sha1.update(contents);
+        summary.hash = llvm::toHex(sha1.final(), /*LowerCase=*/true);
+    }
+    if (prefix) {
+        summary.prefix = scan_include_prefix(std::string_view(contents.data(), contents.size()));
+    }
+    return summary;
+}
+
+// Hands each TU of a tooling::ClangTool run to a callback that builds its
+// MatchAction, runs it through `execute`, and records the outcome
+class batch_action_factory : public tooling::FrontendActionFactory {
+public:
+    using execute_fn = std::function<bool(std::unique_ptr<FrontendAction>)>;
+    // (main file, command's working directory, execute) -> compiled
+    using run_fn = std::function<bool(const fs::path&, const std::string&, const execute_fn&)>;
+
+    explicit batch_action_factory(run_fn run) : run_(std::move(run)) {}
+
+    bool runInvocation(std::shared_ptr<CompilerInvocation> invocation, FileManager* files,
+                       std::shared_ptr<PCHContainerOperations> pch_operations,
+                       DiagnosticConsumer* diagnostics) override {
+        const auto& inputs = invocation->getFrontendOpts().Inputs;
+        if (inputs.empty() || !inputs[0].isFile()) {
+            return false;
+        }
+
+        // ClangTool makes each command's directory the working directory
+        auto directory = files->getVirtualFileSystem().getCurrentWorkingDirectory();
+        const std::string working_directory = directory ? *directory : std::string();
+        fs::path file(inputs[0].getFile().str());
+        if (file.is_relative()) {
+            file = fs::path(working_directory) / file;
+        }
+
+        return run_(file, working_directory, [&](std::unique_ptr<FrontendAction> action) {
+            action_ = std::move(action);
+            return FrontendActionFactory::runInvocation(invocation, files, pch_operations, diagnostics);
+        });
+    }
+
+    std::unique_ptr<FrontendAction> create() override {
+        return std::move(action_);
+    }
+
+private:
+    run_fn run_;
+    std::unique_ptr<FrontendAction> action_;
+};
+
+// Cheap pre-filter on the files a matcher_set reports on; the callbacks'
+// location_filter makes the final per-file decision
+AST_POLYMORPHIC_MATCHER_P(isExpansionInScope,
+                          AST_POLYMORPHIC_SUPPORTED_TYPES(Decl, Stmt, TypeLoc),
+                          match_scope, scope) {
+    const auto& sm = Finder->getASTContext().getSourceManager();
+    auto loc = sm.getExpansionLoc(Node.getBeginLoc());
+    if (loc.isInvalid()) {
+        return false;
+    }
+
+    if (scope == match_scope::main_file) {
+        return sm.isInMainFile(loc);
+    }
+    return !sm.isInSystemHeader(loc);
+}
+
+// Matcher for locals with automatic storage (parameters are safe to return)
+auto local_variable() {
+    return varDecl(
+        hasAutomaticStorageDuration(),
+        unless(parmVarDecl())  // Exclude parameters
+    );
+}
+
+} // namespace
+
+struct matcher_set::impl {
+    struct entry {
+        profile::rule rule;
+        clang::ast_matchers::internal::DynTypedMatcher matcher;
+        callback_factory make_callback;
+        trigger_mask triggers;  // Tokens the matcher needs to fire (0: none known)
+    };
+
+    std::vector<entry> entries;
+    std::vector<profile::rule> rules;
+    std::vector<std::string> unsupported;
+    match_scope scope = match_scope::main_file;
+
+    // Register the matchers that can fire in a TU whose scan found
+    // `present` on one finder, so the TU is parsed once
+    void add_to(
+        MatchFinder& finder,
+        std::vector<std::unique_ptr<MatchFinder::MatchCallback>>& callbacks,
+        std::vector<ast_finding>& findings,
+        location_filter& filter,
+        trigger_mask present
+    ) const {
+        callbacks.reserve(entries.size());
+        for (const auto& entry : entries) {
+            if (!may_fire(entry.triggers, present)) {
+                continue;
+            }
+            callbacks.push_back(entry.make_callback(findings, filter, entry.rule));
+            finder.addDynamicMatcher(entry.matcher, callbacks.back().get());
+        }
+    }
+};
+
+matcher_set::matcher_set(const std::vector<profile::rule>& rules, match_scope scope, match_traversal traversal) {
+    auto set = std::make_shared<impl>();
+    set->scope = scope;
+
+    // A cast in a class template is otherwise reached once for the pattern
+    // and once more per instantiation
+    const bool as_spelled = traversal == match_traversal::as_spelled;
+    auto as_written = [&](clang::ast_matchers::internal::DynTypedMatcher matcher) {
+        return as_spelled ? matcher.withTraversalKind(TK_IgnoreUnlessSpelledInSource) : matcher;
+    };
+
+    for (const auto& rule : rules) {
+        if (rule.id == "SP-OWN-001") {
+            // Naked new expression matcher
+            set->entries.push_back({
+                rule,
+                as_written(cxxNewExpr(isExpansionInScope(scope)).bind("newExpr")),
+                &make_callback<NewExprCallback>,
+                triggers::new_keyword
+            });
+        }
+        else if (rule.id == "SP-OWN-002") {
+            // Naked delete expression matcher
+            set->entries.push_back({
+                rule,
+                as_written(cxxDeleteExpr(isExpansionInScope(scope)).bind("deleteExpr")),
+                &make_callback<DeleteExprCallback>,
+                triggers::delete_keyword
+            });
+        }
+        else if (rule.id == "SP-BOUNDS-001") {
+            // C-style array declaration matcher
+            set->entries.push_back({
+                rule,
+                as_written(varDecl(hasType(arrayType()), isExpansionInScope(scope)).bind("arrayDecl")),
+                &make_callback<CStyleArrayCallback>,
+                0  // Array typedefs and aliases hide the brackets
+            });
+        }
+        else if (rule.id == "SP-TYPE-001") {
+            // C-style cast matcher
+            set->entries.push_back({
+                rule,
+                as_written(cStyleCastExpr(isExpansionInScope(scope)).bind("cStyleCast")),
+                &make_callback<CStyleCastCallback>,
+                triggers::cast
+            });
+        }
+        else if (rule.id == "SP-LIFE-003") {
+            // Return reference/pointer to local variable matcher
+            // Matches: return &local_var or return local_ref
+            // Case 2 relies on seeing implicit nodes: returning a local by
+            // value wraps it in a conversion, which must keep it from
+            // matching. So this matcher always runs in Clang's default
+            // traversal and leaves out instantiations explicitly.
+            Matcher<Stmt> in_source = as_spelled
+                ? Matcher<Stmt>(unless(isInTemplateInstantiation()))
+                : Matcher<Stmt>(anything());
+            auto matcher = returnStmt(
+                hasReturnValue(
+                    anyOf(
+                        // Case 1: return &local_var (address-of local)
+                        unaryOperator(
+                            hasOperatorName("&"),
+                            hasUnaryOperand(declRefExpr(
+                                to(local_variable())
+                            ).bind("localVar"))
+                        ),
+                        // Case 2: return local_ref (reference already)
+                        declRefExpr(
+                            to(local_variable())
+                        ).bind("localVar")
+                    )
+                ),
+                isExpansionInScope(scope),
+                in_source
+            ).bind("returnStmt");
+
+            set->entries.push_back({
+                rule,
+                matcher,
+                &make_callback<ReturnLocalRefCallback>,
+                triggers::return_local
+            });
+        }
+        else {
+            set->unsupported.push_back(rule.id);
+            continue;
+        }
+
+        set->rules.push_back(rule);
+    }
+
+    impl_ = std::move(set);
+}
+
+const std::vector<profile::rule>& matcher_set::rules() const {
+    return impl_->rules;
+}
+
+const std::vector<std::string>& matcher_set::unsupported_rules() const {
+    return impl_->unsupported;
+}
+
+bool finding_less(const ast_finding& a, const ast_finding& b) {
+    return std::tie(a.file, a.line, a.column, a.rule_id, a.message, a.snippet) <
+           std::tie(b.file, b.line, b.column, b.rule_id, b.message, b.snippet);
+}
+
+std::vector<ast_finding> merge_findings(std::vector<std::vector<ast_finding>> buffers) {
+    std::size_t total = 0;
+    for (auto& buffer : buffers) {
+        std::sort(buffer.begin(), buffer.end(), finding_less);
+        total += buffer.size();
+    }
+
+    // k-way merge: the heap holds the head of each non-empty buffer
+    using cursor = std::pair<std::size_t, std::size_t>;  // (buffer, position)
+    auto later = [&](const cursor& a, const cursor& b) {
+        return finding_less(buffers[b.first][b.second], buffers[a.first][a.second]);
+    };
+    std::priority_queue<cursor, std::vector<cursor>, decltype(later)> heads(later);
+
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        if (!buffers[i].empty()) {
+            heads.emplace(i, 0);
+        }
+    }
+
+    std::vector<ast_finding> merged;
+    merged.reserve(total);
+
+    while (!heads.empty()) {
+        auto [buffer, position] = heads.top();
+        heads.pop();
+
+        merged.push_back(std::move(buffers[buffer][position]));
+        if (position + 1 < buffers[buffer].size()) {
+            heads.emplace(buffer, position + 1);
+        }
+    }
+
+    return merged;
+}
+
+file_analysis_result ast_detector::analyze_file(
+    const fs::path& source_file,
+    const profile::rule& rule
+) const {
+    matcher_set matchers({rule}, match_scope::main_file, match_traversal_);
+
+    if (matchers.empty()) {
+        // Unsupported rule
+        file_analysis_result result;
+        result.file = source_file;
+        result.success = false;
+        result.failure = failure_kind::internal_error;
+        result.error_message = "Unsupported rule: " + rule.id;
+        return result;
+    }
+
+    return analyze_file(source_file, matchers);
+}
+
+file_analysis_result ast_detector::analyze_file(
+    const fs::path& source_file,
+    const matcher_set& matchers
+) const {
+    return analyze_file_with_flags(source_file, matchers, compiler_args_for(source_file));
+}
+
+file_analysis_result ast_detector::analyze_file_with_flags(
+    const fs::path& source_file,
+    const matcher_set& matchers,
+    const std::vector<std::string>& compiler_args
+) const {
+    return analyze_tu(source_file, matchers, compiler_args, tu_options{});
+}
+
+file_analysis_result ast_detector::analyze_tu(
+    const fs::path& source_file,
+    const matcher_set& matchers,
+    const std::vector<std::string>& compiler_args,
+    const tu_options& options
+) const {
+    file_analysis_result result;
+    result.file = source_file;
+    result.success = false;
+
+    std::vector<ast_finding> findings;
+    location_filter filter(source_file, options.project_headers);
+    std::vector<fs::path> included;
+    const precompiled_header* pch = options.pch;
+
+    // Refuse oversized inputs before reading them
+    if (limits_.max_file_size_bytes > 0) {
+        boost::system::error_code ec;
+        auto size = fs::file_size(source_file, ec);
+        if (!ec && size > limits_.max_file_size_bytes) {
+            result.failure = failure_kind::limit_exceeded;
+            result.error_message = "File size of " + std::to_string(size) +
+                " bytes exceeds limit of " + std::to_string(limits_.max_file_size_bytes);
+            return result;
+        }
+    }
+
+    // Map the file (large files are not read); Clang parses the mapping in
+    // place, under the file's real path so quoted includes resolve next to it
+    const std::string file_name = fs::absolute(source_file).string();
+    auto mapped = llvm::MemoryBuffer::getFile(file_name, /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/true);
+    if (!mapped) {
+        result.failure = failure_kind::internal_error;
+        result.error_message = "Failed to read file";
+        return result;
+    }
+    const llvm::MemoryBuffer& source = **mapped;
+    const std::string_view source_code = source.getBuffer();
+
+    // Leave out the rules whose trigger tokens appear neither in the file
+    // nor in the project headers it may report on
+    const trigger_mask present = lexical_prefilter_ == lexical_prefilter::off
+        ? triggers::all
+        : scan_triggers(source_code) | options.header_triggers;
+    MatchFinder finder;
+    std::vector<std::unique_ptr<MatchFinder::MatchCallback>> callbacks;
+    matchers.impl_->add_to(finder, callbacks, findings, filter, present);
+
+    if (callbacks.empty() && !matchers.empty() && lexical_prefilter_ == lexical_prefilter::skip) {
+        // Nothing can fire, so there is nothing to parse for. The result
+        // still depends on the project headers' triggers
+        if (options.dependencies) {
+            *options.dependencies = header_dependencies(options.project_headers);
+        }
+        if (options.skipped) {
+            *options.skipped = true;
+        }
+        result.success = true;
+        return result;
+    }
+
+    // Run Clang tooling with provided compiler args, either on the file as
+    // is or with its leading includes replaced by a precompiled header
+    auto run = [&](const precompiled_header* preamble) {
+        std::vector<std::string> args = with_limit_args(compiler_args);
+
+        // The main file is served from this TU's own mapping and everything
+        // it includes goes through the shared cache. analyze_files reads
+        // main files for keys and prefixes from private mappings too, so
+        // the cache does not keep them
+        auto overlay = llvm::makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(file_cache_);
+        auto in_memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+        overlay->pushOverlay(in_memory);
+
+        std::unique_ptr<llvm::MemoryBuffer> main_buffer;
+        if (preamble) {
+            // Blanking the prefix the PCH covers is the one case that copies
+            std::string code(source_code);
+            blank_include_prefix(code, scan_include_prefix(code), preamble->headers.size());
+            main_buffer = llvm::MemoryBuffer::getMemBufferCopy(code, file_name);
+            args.push_back("-include-pch");
+            args.push_back(preamble->path.string());
+            in_memory->addFile(preamble->path.string(), 0,
+                llvm::MemoryBuffer::getMemBuffer(preamble->data->getMemBufferRef(), false));
+        } else {
+            main_buffer = llvm::MemoryBuffer::getMemBuffer(source.getMemBufferRef());
+        }
+        in_memory->addFile(file_name, 0, std::move(main_buffer));
+
+        auto start = std::chrono::steady_clock::now();
+        double match_seconds = 0.0;
+        tu_guard guard(limits_);
+
+        tu_hooks hooks;
+        hooks.filter = &filter;
+        hooks.included = &included;
+        if (options.dependencies) {
+            hooks.dependencies = std::make_shared<DependencyRecorder>(
+                preamble ? preamble->path.parent_path().string() : std::string());
+        }
+
+        // Start from the group's driver-parsed invocation where there is one
+        std::shared_ptr<CompilerInvocation> invocation;
+        if (options.invocations) {
+            std::vector<std::string> command_line = {"clang-tool", "-fsyntax-only"};
+            command_line.insert(command_line.end(), args.begin(), args.end());
+            invocation = options.invocations->instantiate(command_line, file_name, overlay);
+        }
+
+        included.clear();
+        filter.reset();
+        auto action = std::make_unique<MatchAction>(
+            finder, guard, match_seconds, tu_focus{matchers.impl_->scope, traversal_scope_, fast_parse_, &filter}, hooks);
+        bool compiled = invocation
+            ? run_invocation(std::move(action), overlay, std::move(invocation))
+            : run_tool(std::move(action), overlay, args, file_name);
+
+        // Headers read from the PCH are never entered, so the recorder does
+        // not see them; the PCH's recorded inputs stand in for them
+        if (preamble && options.project_headers) {
+            for (const auto& input : preamble->inputs) {
+                auto it = options.project_headers->find(canonical_key(input.path));
+                if (it != options.project_headers->end()) {
+                    included.push_back(it->second);
+                }
+            }
+        }
+
+        if (options.dependencies) {
+            // Absolute, minus the in-memory main file itself
+            options.dependencies->clear();
+            for (const auto& dependency : hooks.dependencies->getDependencies()) {
+                if (dependency != file_name) {
+                    options.dependencies->push_back(fs::absolute(dependency).string());
+                }
+            }
+            std::sort(options.dependencies->begin(), options.dependencies->end());
+            options.dependencies->erase(
+                std::unique(options.dependencies->begin(), options.dependencies->end()),
+                options.dependencies->end());
+        }
+
+        result.timing.match_seconds += match_seconds;
+        result.timing.parse_seconds += std::max(0.0, seconds_since(start) - match_seconds);
+
+        if (guard.tripped()) {
+            result.failure = failure_kind::limit_exceeded;
+            result.error_message = guard.reason();
+            return false;
+        }
+        if (!compiled) {
+            result.failure = failure_kind::compilation_error;
+            result.error_message = "Compilation failed (syntax error, missing includes, or type error)";
+            return false;
+        }
+        result.failure = failure_kind::none;
+        return true;
+    };
+
+    // Use the PCH only if the file still starts with the prefix it covers
+    if (pch) {
+        auto prefix = scan_include_prefix(source_code);
+        if (prefix.headers.size() < pch->headers.size() ||
+            !std::equal(pch->headers.begin(), pch->headers.end(), prefix.headers.begin())) {
+            pch = nullptr;
+        }
+    }
+
+    bool compiled = run(pch);
+    if (!compiled && pch && result.failure == failure_kind::compilation_error) {
+        // The PCH is only an optimization; the plain parse is authoritative
+        findings.clear();
+        compiled = run(nullptr);
+    }
+
+    if (!compiled) {
+        return result;
+    }
+
+    // Success!
+    result.success = true;
+    result.findings = std::move(findings);
+    if (options.included) {
+        *options.included = std::move(included);
+    }
+    return result;
+}
+
+std::vector<ast_detector::batch_result> ast_detector::analyze_batch(
+    const std::vector<fs::path>& source_files,
+    const matcher_set& matchers,
+    const compile_commands_database& database,
+    const project_file_map* project_headers,
+    const std::vector<trigger_mask>& header_triggers,
+    bool record_dependencies
+) const {
+    std::vector<batch_result> results(source_files.size());
+    std::vector<trigger_mask> present(source_files.size(), triggers::all);
+    std::unordered_map<std::string, std::size_t> positions;
+    std::vector<std::pair<std::size_t, std::size_t>> duplicates;  // (copy, original)
+    std::vector<std::string> to_parse;
+
+    for (std::size_t i = 0; i < source_files.size(); ++i) {
+        const auto& file = source_files[i];
+        auto& result = results[i].result;
+        result.file = file;
+        result.success = false;
+        result.failure = failure_kind::compilation_error;
+        result.error_message = "Compilation failed (syntax error, missing includes, or type error)";
+
+        if (limits_.max_file_size_bytes > 0) {
+            boost::system::error_code ec;
+            auto size = fs::file_size(file, ec);
+            if (!ec && size > limits_.max_file_size_bytes) {
+                result.failure = failure_kind::limit_exceeded;
+                result.error_message = "File size of " + std::to_string(size) +
+                    " bytes exceeds limit of " + std::to_string(limits_.max_file_size_bytes);
+                continue;
+            }
+        }
+
+        const std::string file_name = fs::absolute(file).string();
+        if (lexical_prefilter_ != lexical_prefilter::off) {
+            auto mapped = llvm::MemoryBuffer::getFile(file_name, /*IsText=*/false,
+                                                      /*RequiresNullTerminator=*/true);
+            if (!mapped) {
+                result.failure = failure_kind::internal_error;
+                result.error_message = "Failed to read file";
+                continue;
+            }
+            present[i] = scan_triggers((*mapped)->getBuffer()) | header_triggers[i];
+        }
+
+        if (lexical_prefilter_ == lexical_prefilter::skip && !matchers.empty()) {
+            bool can_fire = false;
+            for (const auto& entry : matchers.impl_->entries) {
+                can_fire = can_fire || may_fire(entry.triggers, present[i]);
+            }
+            if (!can_fire) {
+                results[i].skipped = true;
+                results[i].dependencies = header_dependencies(project_headers);
+                result.success = true;
+                result.failure = failure_kind::none;
+                result.error_message.clear();
+                continue;
+            }
+        }
+
+        // A file listed twice is parsed once, under its one command
+        auto [position, inserted] = positions.emplace(canonical_key(file), i);
+        if (!inserted) {
+            duplicates.emplace_back(i, position->second);
+            continue;
+        }
+        to_parse.push_back(file_name);
+    }
+
+    if (to_parse.empty()) {
+        return results;
+    }
+
+    // One FileManager for the whole batch; ClangTool moves the working
+    // directory to each command's, which the view keeps apart from the
+    // process's own. Main files are each read once, so they skip the cache
+    tooling::ClangTool tool(database, to_parse, std::make_shared<PCHContainerOperations>(),
+                            llvm::makeIntrusiveRefCnt<working_directory_file_system>(
+                                llvm::makeIntrusiveRefCnt<main_file_bypass>(file_cache_, to_parse)));
+    std::vector<std::string> extra_args = with_limit_args({
+        "-Wno-everything",
+        "-ferror-limit=100",
+        "-fno-caret-diagnostics"
+    });
+    tool.appendArgumentsAdjuster(tooling::getInsertArgumentAdjuster(
+        extra_args, tooling::ArgumentInsertPosition::END));
+    tool.setPrintErrorMessage(false);
+
+    batch_action_factory factory([&](const fs::path& file, const std::string& directory,
+                                     const batch_action_factory::execute_fn& execute) {
+        auto position = positions.find(canonical_key(file));
+        if (position == positions.end()) {
+            return false;
+        }
+        batch_result& batch = results[position->second];
+        file_analysis_result& result = batch.result;
+        const std::string file_name = file.string();
+
+        std::vector<ast_finding> findings;
+        location_filter filter(result.file, project_headers);
+        MatchFinder finder;
+        std::vector<std::unique_ptr<MatchFinder::MatchCallback>> callbacks;
+        matchers.impl_->add_to(finder, callbacks, findings, filter, present[position->second]);
+
+        auto start = std::chrono::steady_clock::now();
+        double match_seconds = 0.0;
+        tu_guard guard(limits_);
+
+        tu_hooks hooks;
+        hooks.filter = &filter;
+        hooks.included = &batch.included;
+        if (record_dependencies) {
+            hooks.dependencies = std::make_shared<DependencyRecorder>(std::string());
+        }
+
+        batch.included.clear();
+        bool compiled = execute(std::make_unique<MatchAction>(
+            finder, guard, match_seconds, tu_focus{matchers.impl_->scope, traversal_scope_, fast_parse_, &filter}, hooks));
+
+        if (record_dependencies) {
+            // Absolute against the command's directory, minus the main file
+            batch.dependencies.clear();
+            for (const auto& dependency : hooks.dependencies->getDependencies()) {
+                fs::path path = fs::absolute(fs::path(dependency), fs::path(directory));
+                if (path.lexically_normal() != file.lexically_normal()) {
+                    batch.dependencies.push_back(path.string());
+                }
+            }
+            std::sort(batch.dependencies.begin(), batch.dependencies.end());
+            batch.dependencies.erase(
+                std::unique(batch.dependencies.begin(), batch.dependencies.end()),
+                batch.dependencies.end());
+        }
+
+        result.timing.match_seconds = match_seconds;
+        result.timing.parse_seconds = std::max(0.0, seconds_since(start) - match_seconds);
+
+        if (guard.tripped()) {
+            result.failure = failure_kind::limit_exceeded;
+            result.error_message = guard.reason();
+            return false;
+        }
+        if (!compiled) {
+            return false;
+        }
+
+        result.success = true;
+        result.failure = failure_kind::none;
+        result.error_message.clear();
+        result.findings = std::move(findings);
+        return true;
+    });
+
+    // Failed TUs are recorded in their results; the exit code adds nothing
+    tool.run(&factory);
+    for (const auto& [copy, original] : duplicates) {
+        results[copy] = results[original];
+        results[copy].result.file = source_files[copy];
+    }
+    return results;
+}
+
+struct buffer_preamble::impl {
+    std::optional<PrecompiledPreamble> preamble;
+    std::vector<std::string> args;  // Compiler arguments it was built with
+};
+
+buffer_preamble::buffer_preamble() : impl_(std::make_unique<impl>()) {}
+
+buffer_preamble::~buffer_preamble() = default;
+
+file_analysis_result ast_detector::analyze_buffer(
+    const fs::path& source_file,
+    const std::string& contents,
+    const matcher_set& matchers,
+    buffer_preamble& preamble
+) const {
+    file_analysis_result result;
+    result.file = source_file;
+    result.success = false;
+    preamble.reused_ = false;
+
+    std::vector<ast_finding> findings;
+    location_filter filter(source_file);
+    MatchFinder finder;
+    std::vector<std::unique_ptr<MatchFinder::MatchCallback>> callbacks;
+    callbacks.reserve(matchers.impl_->entries.size());
+
+    for (const auto& entry : matchers.impl_->entries) {
+        callbacks.push_back(entry.make_callback(findings, filter, entry.rule));
+        finder.addDynamicMatcher(entry.matcher, callbacks.back().get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const std::string file_name = fs::absolute(source_file).string();
+    const std::vector<std::string> args = with_limit_args(compiler_args_for(source_file));
+    std::vector<const char*> command_line = {"clang-tool", "-fsyntax-only"};
+    for (const auto& arg : args) {
+        command_line.push_back(arg.c_str());
+    }
+    command_line.push_back(file_name.c_str());
+
+    // Errors only decide success; nothing is printed
+    IgnoringDiagConsumer ignore;
+    auto diagnostics = CompilerInstance::createDiagnostics(new DiagnosticOptions(), &ignore, false);
+    CreateInvocationOptions invocation_options;
+    invocation_options.Diags = diagnostics;
+    invocation_options.VFS = file_cache_;
+    std::shared_ptr<CompilerInvocation> invocation = createInvocation(command_line, invocation_options);
+    if (!invocation) {
+        result.failure = failure_kind::compilation_error;
+        result.error_message = "Invalid compiler arguments";
+        return result;
+    }
+
+    // Reuse the preamble unless its directives, arguments or inputs changed
+    auto buffer = llvm::MemoryBuffer::getMemBuffer(contents, file_name);
+    auto bounds = ComputePreambleBounds(invocation->getLangOpts(), buffer->getMemBufferRef(), 0);
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system = file_cache_;
+    auto pch_operations = std::make_shared<PCHContainerOperations>();
+
+    auto& state = *preamble.impl_;
+    preamble.reused_ = state.preamble && state.args == args &&
+        state.preamble->CanReuse(*invocation, buffer->getMemBufferRef(), bounds, *file_system);
+    if (!preamble.reused_) {
+        state.preamble.reset();
+        state.args = args;
+
+        PreambleCallbacks preamble_callbacks;
+        auto built = PrecompiledPreamble::Build(
+            *invocation, buffer.get(), bounds, *diagnostics, file_system, pch_operations,
+            /*StoreInMemory=*/true, /*StoragePath=*/"", preamble_callbacks);
+        if (built) {
+            state.preamble.emplace(std::move(*built));
+        }
+        // Otherwise the whole buffer is parsed; a broken #include then
+        // fails the analysis below like any compilation error
+    }
+
+    // The buffer stands in for the file on disk; the instance owns it
+    auto main_buffer = llvm::MemoryBuffer::getMemBuffer(contents, file_name);
+    if (state.preamble) {
+        state.preamble->AddImplicitPreamble(*invocation, file_system, main_buffer.release());
+    } else {
+        invocation->getPreprocessorOpts().addRemappedFile(file_name, main_buffer.release());
+    }
+
+    CompilerInstance compiler(pch_operations);
+    compiler.setInvocation(std::move(invocation));
+    compiler.createDiagnostics(&ignore, false);
+    compiler.createFileManager(file_system);
+
+    double match_seconds = 0.0;
+    tu_guard guard(limits_);
+    MatchAction action(finder, guard, match_seconds, tu_focus{matchers.impl_->scope, traversal_scope_, fast_parse_, &filter});
+    bool compiled = compiler.ExecuteAction(action) && !compiler.getDiagnostics().hasErrorOccurred();
+
+    result.timing.match_seconds = match_seconds;
+    result.timing.parse_seconds = std::max(0.0, seconds_since(start) - match_seconds);
+
+    if (guard.tripped()) {
+        result.failure = failure_kind::limit_exceeded;
+        result.error_message = guard.reason();
+        return result;
+    }
+    if (!compiled) {
+        result.failure = failure_kind::compilation_error;
+        result.error_message = "Compilation failed (syntax error, missing includes, or type error)";
+        return result;
+    }
+
+    result.success = true;
+    result.findings = std::move(findings);
+    return result;
+}
+
+std::vector<std::string> ast_detector::with_limit_args(std::vector<std::string> args) const {
+    if (limits_.max_template_depth > 0) {
+        args.push_back("-ftemplate-depth=" + std::to_string(limits_.max_template_depth));
+    }
+    return args;
+}
+
+file_analysis_result ast_detector::analyze_umbrella(
+    const std::vector<fs::path>& headers,
+    const matcher_set& matchers,
+    const std::vector<std::string>& compiler_args,
+    std::vector<fs::path>& offending
+) const {
+    const std::string file_name = "safeprofile-umbrella.cpp";
+
+    file_analysis_result result;
+    result.file = file_name;
+    result.success = false;
+    offending.clear();
+
+    project_file_map project_files;
+    std::string code;
+    for (const auto& header : headers) {
+        project_files.emplace(canonical_key(header), header);
+        code += "#include \"" + fs::absolute(header).generic_string() + "\"\n";
+    }
+
+    std::vector<ast_finding> findings;
+    location_filter filter(fs::path(), &project_files);
+
+    MatchFinder finder;
+    std::vector<std::unique_ptr<MatchFinder::MatchCallback>> callbacks;
+    callbacks.reserve(matchers.impl_->entries.size());
+
+    for (const auto& entry : matchers.impl_->entries) {
+        callbacks.push_back(entry.make_callback(findings, filter, entry.rule));
+        finder.addDynamicMatcher(entry.matcher, callbacks.back().get());
+    }
+
+    auto overlay = llvm::makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(file_cache_);
+    auto in_memory = llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+    overlay->pushOverlay(in_memory);
+    in_memory->addFile(file_name, 0, llvm::MemoryBuffer::getMemBufferCopy(code, file_name));
+
+    // The umbrella does the work of one TU per header
+    analysis_limits limits = limits_;
+    limits.time_budget_seconds *= static_cast<double>(headers.size());
+    limits.max_ast_memory_mb *= headers.size();
+
+    auto start = std::chrono::steady_clock::now();
+    double match_seconds = 0.0;
+    tu_guard guard(limits);
+    include_blame blame(filter);
+
+    bool compiled = run_tool(
+        std::make_unique<MatchAction>(finder, guard, match_seconds, tu_focus{matchers.impl_->scope, traversal_scope_, fast_parse_, &filter}),
+        overlay,
+        with_limit_args(compiler_args),
+        file_name,
+        &blame
+    );
+
+    result.timing.match_seconds = match_seconds;
+    result.timing.parse_seconds = std::max(0.0, seconds_since(start) - match_seconds);
+
+    if (guard.tripped()) {
+        result.failure = failure_kind::limit_exceeded;
+        result.error_message = guard.reason();
+        return result;
+    }
+
+    if (!compiled) {
+        result.failure = failure_kind::compilation_error;
+        result.error_message = "Umbrella TU failed to compile";
+        offending = blame.blamed();
+        return result;
+    }
+
+    result.success = true;
+    result.findings = std::move(findings);
+    return result;
+}
+
+std::vector<ast_finding> ast_detector::analyze_umbrellas(
+    const std::vector<fs::path>& source_files,
+    const std::vector<std::vector<std::string>>& tu_args,
+    const std::vector<profile::rule>& rules,
+    std::vector<bool>& covered,
+    std::size_t workers
+) const {
+    const matcher_set matchers(rules, match_scope::project_files, match_traversal_);
+
+    // Group headers by their exact compiler arguments
+    std::map<std::string, std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < source_files.size(); ++i) {
+        if (!intake::repository::is_header(source_files[i])) {
+            continue;
+        }
+
+        // Oversized headers are left to fail their own size check
+        if (limits_.max_file_size_bytes > 0) {
+            boost::system::error_code ec;
+            auto size = fs::file_size(source_files[i], ec);
+            if (ec || size > limits_.max_file_size_bytes) {
+                continue;
+            }
+        }
+
+        groups[flags_key(tu_args[i])].push_back(i);
+    }
+
+    std::vector<std::vector<std::size_t>> work;
+    for (auto& group : groups) {
+        if (group.second.size() >= 2) {
+            work.push_back(std::move(group.second));
+        }
+    }
+
+    std::vector<std::vector<ast_finding>> findings(work.size());
+    std::vector<std::vector<std::size_t>> analyzed(work.size());  // Per group, set once
+
+    auto run_group = [&](std::size_t g) {
+        std::vector<std::size_t> members = work[g];
+        const auto& args = tu_args[members.front()];
+
+        // Each failed attempt drops the headers that broke it
+        for (int attempt = 0; attempt < 4 && members.size() >= 2; ++attempt) {
+            std::vector<fs::path> headers;
+            for (auto index : members) {
+                headers.push_back(source_files[index]);
+            }
+
+            std::vector<fs::path> offending;
+            file_analysis_result result;
+            try {
+                result = analyze_umbrella(headers, matchers, args, offending);
+            } catch (const std::exception&) {
+                return;
+            }
+
+            if (result.success) {
+                analyzed[g] = std::move(members);
+                findings[g] = std::move(result.findings);
+                return;
+            }
+
+            if (result.failure != failure_kind::compilation_error || offending.empty()) {
+                return;
+            }
+
+            std::set<fs::path> excluded(offending.begin(), offending.end());
+            members.erase(
+                std::remove_if(members.begin(), members.end(), [&](std::size_t index) {
+                    return excluded.count(source_files[index]) > 0;
+                }),
+                members.end());
+        }
+    };
+
+    if (isolate_) {
+        // One forked worker per group, all forked from this thread. Blame
+        // does not cross the process boundary, so a failed isolated
+        // umbrella falls back to standalone parsing
+        std::vector<std::vector<fs::path>> headers(work.size());
+        std::size_t next = 0;
+        run_isolated_pool(workers, memory_limit_mb_,
+            [&]() -> std::optional<isolated_job> {
+                if (next == work.size()) {
+                    return std::nullopt;
+                }
+                const std::size_t g = next++;
+                for (auto index : work[g]) {
+                    headers[g].push_back(source_files[index]);
+                }
+                isolated_job job;
+                job.source_file = headers[g].front();
+                job.analyze = [&, g] {
+                    std::vector<fs::path> offending;
+                    worker_output output;
+                    output.result = analyze_umbrella(headers[g], matchers, tu_args[work[g].front()], offending);
+                    return output;
+                };
+                job.timeout_seconds = limits_.time_budget_seconds * 2.0 * static_cast<double>(headers[g].size());
+                job.tag = g;
+                return job;
+            },
+            [&](const isolated_job& job, worker_output output) {
+                if (output.result.success) {
+                    analyzed[job.tag] = work[job.tag];
+                    findings[job.tag] = std::move(output.result.findings);
+                }
+            });
+    } else if (workers <= 1 || work.size() <= 1) {
+        for (std::size_t g = 0; g < work.size(); ++g) {
+            run_group(g);
+        }
+    } else {
+        boost::asio::thread_pool pool(std::min(workers, work.size()));
+        for (std::size_t g = 0; g < work.size(); ++g) {
+            boost::asio::post(pool, [&, g] { run_group(g); });
+        }
+        pool.join();
+    }
+
+    std::vector<ast_finding> result;
+    for (std::size_t g = 0; g < work.size(); ++g) {
+        for (auto index : analyzed[g]) {
+            covered[index] = true;
+        }
+        result.insert(result.end(),
+                      std::make_move_iterator(findings[g].begin()),
+                      std::make_move_iterator(findings[g].end()));
+    }
+    return result;
+}
+
+std::vector<ast_finding> ast_detector::analyze_files(
+    const std::vector<fs::path>& source_files,
+    const std::vector<profile::rule>& rules,
+    std::vector<file_analysis_result>& failed_files,
+    analysis_statistics* stats
+) const {
+    failed_files.clear();
+
+    // Matchers are immutable; build them once and share across all TUs
+    const matcher_set matchers(rules, match_scope::main_file, match_traversal_);
+    if (matchers.empty()) {
+        return {};
+    }
+
+    auto run_start = std::chrono::steady_clock::now();
+    const file_cache_statistics cache_before = file_cache_->statistics();
+    const std::size_t hits_before = result_cache_ ? result_cache_->hits() : 0;
+    const std::size_t misses_before = result_cache_ ? result_cache_->misses() : 0;
+
+    // ClangTool mode runs each entry's full command line, or the default
+    // arguments for files without one
+    std::unique_ptr<compile_commands_database> database;
+    if (clang_tool_) {
+        std::vector<std::string> extra_args;
+        for (const auto& include_path : additional_include_paths_) {
+            extra_args.push_back("-I" + include_path);
+        }
+        database = std::make_unique<compile_commands_database>(
+            compile_db_, get_default_compiler_args(), std::move(extra_args));
+    }
+
+    std::vector<std::vector<std::string>> tu_args;
+    tu_args.reserve(source_files.size());
+    for (const auto& file : source_files) {
+        if (database) {
+            // Only keys the result cache; the command's directory is part of it
+            auto command = database->getCompileCommands(fs::absolute(file).string()).front();
+            command.CommandLine.push_back(command.Directory);
+            tu_args.push_back(std::move(command.CommandLine));
+        } else {
+            tu_args.push_back(compiler_args_for(file));
+        }
+    }
+
+    // Header-only libraries: parse headers together first; anything an
+    // umbrella did not cover is analyzed on its own below
+    std::vector<bool> covered(source_files.size(), false);
+    std::vector<ast_finding> umbrella_findings;
+    if (umbrella_headers_ && !clang_tool_) {
+        umbrella_findings = analyze_umbrellas(
+            source_files, tu_args, rules, covered, effective_jobs());
+    }
+
+    std::vector<std::size_t> pending;  // Indices of files still to analyze
+    std::vector<fs::path> pending_files;
+    std::vector<std::vector<std::string>> pending_args;
+    for (std::size_t i = 0; i < source_files.size(); ++i) {
+        if (!covered[i]) {
+            pending.push_back(i);
+            pending_files.push_back(source_files[i]);
+            pending_args.push_back(tu_args[i]);
+        }
+    }
+
+    const std::size_t workers = std::max<std::size_t>(
+        std::min<std::size_t>(effective_jobs(), pending.size()), 1);
+
+    // Longest-first scheduling only matters when there is more than one worker
+    const std::vector<double> costs = workers > 1
+        ? estimate_costs(pending_files, cost_history_.get())
+        : std::vector<double>(pending.size(), 0.0);
+
+    // TUs with identical arguments form a group, scheduled back-to-back
+    // and sharing one driver-parsed invocation
+    std::vector<std::size_t> groups;
+    groups.reserve(pending.size());
+    {
+        std::unordered_map<std::string, std::size_t> group_ids;
+        for (const auto& args : pending_args) {
+            groups.push_back(group_ids.emplace(flags_key(args), group_ids.size()).first->second);
+        }
+    }
+    invocation_cache invocations;
+    const bool reuse_invocations = invocation_reuse_ && !isolate_ && !clang_tool_;
+
+    // Headers are analyzed through the TUs that include them where possible;
+    // findings in them go through a shared set, since several TUs may see them
+    project_file_map project_headers;
+    std::vector<std::size_t> source_slots;
+    std::vector<std::size_t> header_slots;
+    for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+        if (header_deduplication_ && intake::repository::is_header(pending_files[slot])) {
+            project_headers.emplace(canonical_key(pending_files[slot]), pending_files[slot]);
+            header_slots.push_back(slot);
+        } else {
+            source_slots.push_back(slot);
+        }
+    }
+    const matcher_set project_matchers = project_headers.empty()
+        ? matchers
+        : matcher_set(rules, match_scope::project_files, match_traversal_);
+    finding_set header_findings;
+
+    // Everything besides the TU's own inputs that shapes its result. Which
+    // files are project headers is not part of it: each entry records the
+    // ones it read, so adding or removing an unrelated header keeps it
+    std::string run_digest;
+    if (result_cache_) {
+        hash_builder hash;
+        hash.add(version::string);
+        hash.add(std::to_string(static_cast<int>(match_traversal_))).add(fast_parse_ ? "fast" : "full");
+        hash.add(lexical_prefilter_ == lexical_prefilter::skip ? "skip" : "parse");
+        for (const auto& rule : matchers.rules()) {
+            hash.add(rule.id).add(rule.pattern).add(std::to_string(static_cast<int>(rule.level)));
+        }
+        run_digest = hash.hex();
+    }
+
+    // Most files a TU reads are not project headers; comparing file names
+    // first avoids resolving each of them
+    std::unordered_set<std::string> header_names;
+    for (const auto& entry : project_headers) {
+        header_names.insert(entry.second.filename().string());
+    }
+    auto is_project_header = [&](const fs::path& file) {
+        return header_names.count(file.filename().string()) != 0 &&
+            project_headers.count(canonical_key(file)) != 0;
+    };
+    const bool plan_preambles = precompiled_preambles_ && !clang_tool_ && pending.size() > 1;
+    std::vector<main_file_summary> main_files;
+    main_files.reserve(pending.size());
+    for (const auto& file : pending_files) {
+        main_files.push_back(summarize_main_file(file, result_cache_ != nullptr, plan_preambles));
+    }
+
+    auto cache_key = [&](const fs::path& file, const std::optional<std::string>& contents,
+                         const std::vector<std::string>& args) {
+        if (!contents) {
+            return std::string();
+        }
+
+        hash_builder hash;
+        hash.add(run_digest).add(*contents).add(result_cache_->portable(fs::absolute(file).string()));
+        for (const auto& arg : with_limit_args(args)) {
+            hash.add(result_cache_->portable(arg));
+        }
+        return hash.hex();
+    };
+
+    // Keys are known before any parsing, so a remote cache can answer
+    // while earlier TUs are still being analyzed. Not when isolating: the
+    // prefetch threads could hold a lock at the moment a worker is forked
+    std::vector<std::string> cache_keys(pending.size());
+    if (result_cache_) {
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            cache_keys[slot] = cache_key(pending_files[slot], main_files[slot].hash, pending_args[slot]);
+        }
+        if (!isolate_) {
+            result_cache_->prefetch(cache_keys, file_cache_);
+        }
+    }
+
+    // Parse include prefixes shared by TUs with identical flags once,
+    // as precompiled headers
+    preamble_set& preambles = *preambles_;
+    preamble_plan plan;
+    if (plan_preambles) {
+        std::vector<include_prefix> prefixes;
+        prefixes.reserve(main_files.size());
+        for (auto& summary : main_files) {
+            prefixes.push_back(std::move(summary.prefix));
+        }
+        plan = plan_preamble_use(prefixes, pending_args);
+        std::vector<std::vector<std::string>> build_args;
+        build_args.reserve(pending_args.size());
+        for (const auto& args : pending_args) {
+            build_args.push_back(with_limit_args(args));
+        }
+        preambles.build(plan, build_args, file_cache_, workers);
+    }
+    auto preamble_for = [&](std::size_t slot) -> const precompiled_header* {
+        if (slot >= plan.assignment.size() || !plan.assignment[slot]) {
+            return nullptr;
+        }
+        return preambles.find(*plan.assignment[slot]);
+    };
+
+    // A TU may report findings in the project headers it reaches, so its
+    // prefilter also admits the triggers found in those. Reachability comes
+    // from the lexical include scan, which errs towards extra edges
+    std::vector<trigger_mask> header_triggers(pending.size(), 0);
+    if (lexical_prefilter_ != lexical_prefilter::off && !header_slots.empty()) {
+        std::unordered_map<std::string, trigger_mask> own;  // key: pending file
+        for (auto slot : header_slots) {
+            auto buffer = file_cache_->getBufferForFile(fs::absolute(pending_files[slot]).string());
+            own[pending_files[slot].string()] = buffer ? scan_triggers((*buffer)->getBuffer()) : triggers::all;
+        }
+
+        std::vector<fs::path> include_paths;
+        for (const auto& args : pending_args) {
+            for (const auto& arg : args) {
+                if (arg.size() > 2 && arg.compare(0, 2, "-I") == 0) {
+                    include_paths.emplace_back(arg.substr(2));
+                }
+            }
+        }
+        std::sort(include_paths.begin(), include_paths.end());
+        include_paths.erase(std::unique(include_paths.begin(), include_paths.end()), include_paths.end());
+        const auto graph = intake::include_graph::build(pending_files, include_paths);
+
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            std::unordered_set<std::string> seen;
+            std::vector<fs::path> stack = graph.includes(pending_files[slot]);
+            while (!stack.empty()) {
+                fs::path file = std::move(stack.back());
+                stack.pop_back();
+                if (!seen.insert(file.string()).second) {
+                    continue;
+                }
+                auto it = own.find(file.string());
+                if (it != own.end()) {
+                    header_triggers[slot] |= it->second;
+                }
+                for (auto& next : graph.includes(file)) {
+                    stack.push_back(std::move(next));
+                }
+            }
+        }
+    }
+    std::atomic<std::size_t> lexically_skipped{0};
+
+    // Each worker appends to its own buffers; nothing is shared while
+    // analysis runs, and the merge below restores a deterministic order
+    std::vector<std::vector<ast_finding>> finding_buffers(workers);
+    std::vector<std::vector<file_analysis_result>> failure_buffers(workers);
+    std::vector<double> busy_seconds(workers, 0.0);
+    std::vector<tu_timing> timings(source_files.size());  // one slot per file
+    std::vector<std::vector<fs::path>> included(workers);  // Project headers seen
+
+    // Stores only deterministic outcomes
+    auto store = [&](const std::string& key, const file_analysis_result& analyzed,
+                     const std::vector<fs::path>& entered,
+                     const std::vector<std::string>& dependencies) {
+        if (!key.empty() &&
+            (analyzed.success || analyzed.failure == failure_kind::compilation_error)) {
+            cached_result entry;
+            entry.result = analyzed;
+            entry.result.timing = tu_timing{};
+            entry.included = entered;
+            for (const auto& dependency : dependencies) {
+                if (is_project_header(dependency)) {
+                    entry.attributed.emplace_back(dependency);
+                }
+            }
+            result_cache_->store(key, dependencies, entry, *file_cache_);
+        }
+    };
+
+    auto collect = [&](std::size_t worker, std::size_t slot, file_analysis_result result,
+                       const std::vector<fs::path>& entered, bool skipped) {
+        const std::size_t index = pending[slot];
+        const auto& file = source_files[index];
+
+        timings[index] = result.timing;
+        if (skipped) {
+            ++lexically_skipped;
+        }
+
+        if (result.success) {
+            // Anything in a project header may also come from another TU
+            const bool is_project_header =
+                !project_headers.empty() && intake::repository::is_header(file);
+            auto& buffer = finding_buffers[worker];
+            for (auto& finding : result.findings) {
+                if (is_project_header || finding.file != file) {
+                    header_findings.insert(std::move(finding));
+                } else {
+                    buffer.push_back(std::move(finding));
+                }
+            }
+            included[worker].insert(included[worker].end(), entered.begin(), entered.end());
+        } else {
+            failure_buffers[worker].push_back(std::move(result));
+        }
+    };
+
+    auto options_for = [&](std::size_t slot) {
+        tu_options options;
+        options.pch = preamble_for(slot);
+        options.header_triggers = header_triggers[slot];
+        if (!project_headers.empty()) {
+            options.project_headers = &project_headers;
+        }
+        if (reuse_invocations) {
+            options.invocations = &invocations;
+        }
+        return options;
+    };
+
+    // Returns what the cache stores, so an isolated worker's result is
+    // stored by this process rather than from inside the worker
+    auto analyze_slot = [&](std::size_t slot, tu_options options) {
+        const std::size_t index = pending[slot];
+        worker_output output;
+        if (!project_headers.empty()) {
+            options.included = &output.included;
+        }
+        if (!cache_keys[slot].empty()) {
+            options.dependencies = &output.dependencies;
+        }
+        output.result = analyze_tu(source_files[index], project_matchers, tu_args[index], options);
+        return output;
+    };
+
+    // Unchanged TUs are answered from the result cache without Clang
+    auto answer_from_cache = [&](std::size_t worker, std::size_t slot) {
+        const std::string& key = cache_keys[slot];
+        if (key.empty()) {
+            return false;
+        }
+        auto cached = result_cache_->lookup(key, *file_cache_, is_project_header);
+        if (!cached) {
+            return false;
+        }
+        collect(worker, slot, std::move(cached->result), cached->included, false);
+        return true;
+    };
+
+    auto finish = [&](std::size_t worker, std::size_t slot, worker_output output, bool skipped) {
+        store(cache_keys[slot], output.result, output.included, output.dependencies);
+        collect(worker, slot, std::move(output.result), output.included, skipped);
+    };
+
+    auto analyze_into = [&](std::size_t worker, std::size_t slot) {
+        const auto& file = source_files[pending[slot]];
+        bool skipped = false;
+        worker_output output;
+        try {
+            if (answer_from_cache(worker, slot)) {
+                return;
+            }
+            tu_options options = options_for(slot);
+            options.skipped = &skipped;
+            output = analyze_slot(slot, options);
+        } catch (const std::exception& e) {
+            // Never let one TU take down the pool
+            output = worker_output{};
+            output.result.file = file;
+            output.result.success = false;
+            output.result.failure = failure_kind::internal_error;
+            output.result.error_message = std::string("Analysis aborted: ") + e.what();
+        }
+        finish(worker, slot, std::move(output), skipped);
+    };
+
+    // Isolation: this thread alone forks up to `workers` processes and
+    // polls them, since a child forked while another thread held a lock
+    // could block on it forever. Isolation is the backstop for work
+    // cooperative cancellation cannot interrupt
+    auto run_isolated_phase = [&](const std::vector<std::size_t>& slots) {
+        std::vector<std::size_t> order = slots;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return costs[a] > costs[b];
+        });
+
+        std::size_t next = 0;
+        run_isolated_pool(workers, memory_limit_mb_,
+            [&]() -> std::optional<isolated_job> {
+                while (next < order.size()) {
+                    const std::size_t slot = order[next++];
+                    if (answer_from_cache(0, slot)) {
+                        continue;
+                    }
+                    isolated_job job;
+                    job.source_file = source_files[pending[slot]];
+                    job.analyze = [&, slot] { return analyze_slot(slot, options_for(slot)); };
+                    job.timeout_seconds = limits_.time_budget_seconds * 2.0;
+                    job.tag = slot;
+                    return job;
+                }
+                return std::nullopt;
+            },
+            [&](const isolated_job& job, worker_output output) {
+                busy_seconds[0] += output.result.timing.total();
+                finish(0, job.tag, std::move(output), false);
+            });
+    };
+
+    // ClangTool mode: each worker runs its share of a phase as one batch,
+    // after answering what it can from the result cache
+    auto run_batches = [&](const std::vector<std::size_t>& slots) {
+        std::vector<std::size_t> order = slots;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return costs[a] > costs[b];
+        });
+
+        // Longest first, each to the least loaded worker
+        std::vector<std::vector<std::size_t>> shares(workers);
+        std::vector<double> load(workers, 0.0);
+        for (auto slot : order) {
+            std::size_t least = 0;
+            for (std::size_t w = 1; w < workers; ++w) {
+                if (std::make_pair(load[w], shares[w].size()) <
+                    std::make_pair(load[least], shares[least].size())) {
+                    least = w;
+                }
+            }
+            load[least] += costs[slot];
+            shares[least].push_back(slot);
+        }
+
+        // Within a share, TUs with the same arguments run back-to-back
+        for (auto& share : shares) {
+            std::stable_sort(share.begin(), share.end(), [&](std::size_t a, std::size_t b) {
+                return groups[a] < groups[b];
+            });
+        }
+
+        auto run_share = [&](std::size_t worker) {
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::size_t> misses;
+            std::vector<fs::path> files;
+            for (auto slot : shares[worker]) {
+                const std::string& key = cache_keys[slot];
+                std::optional<cached_result> cached;
+                if (!key.empty()) {
+                    cached = result_cache_->lookup(key, *file_cache_, is_project_header);
+                }
+                if (cached) {
+                    collect(worker, slot, std::move(cached->result), cached->included, false);
+                } else {
+                    misses.push_back(slot);
+                    files.push_back(source_files[pending[slot]]);
+                }
+            }
+
+            if (!files.empty()) {
+                std::vector<trigger_mask> reached;
+                reached.reserve(misses.size());
+                for (auto slot : misses) {
+                    reached.push_back(header_triggers[slot]);
+                }
+                std::vector<batch_result> batch;
+                try {
+                    batch = analyze_batch(files, project_matchers, *database,
+                                          project_headers.empty() ? nullptr : &project_headers,
+                                          reached, static_cast<bool>(result_cache_));
+                } catch (const std::exception& e) {
+                    // Never let one batch take down the pool
+                    batch.resize(files.size());
+                    for (std::size_t i = 0; i < files.size(); ++i) {
+                        batch[i].result.file = files[i];
+                        batch[i].result.success = false;
+                        batch[i].result.failure = failure_kind::internal_error;
+                        batch[i].result.error_message = std::string("Analysis aborted: ") + e.what();
+                    }
+                }
+
+                for (std::size_t i = 0; i < misses.size(); ++i) {
+                    auto& tu = batch[i];
+                    store(cache_keys[misses[i]], tu.result, tu.included, tu.dependencies);
+                    collect(worker, misses[i], std::move(tu.result), tu.included, tu.skipped);
+                }
+            }
+
+            busy_seconds[worker] += seconds_since(start);
+        };
+
+        if (workers == 1) {
+            run_share(0);
+        } else {
+            boost::asio::thread_pool pool(workers);
+            for (std::size_t w = 0; w < workers; ++w) {
+                boost::asio::post(pool, [&, w] { run_share(w); });
+            }
+            pool.join();
+        }
+    };
+
+    std::size_t steals = 0;
+    auto run_phase = [&](const std::vector<std::size_t>& slots) {
+        if (isolate_) {
+            run_isolated_phase(slots);
+            return;
+        }
+
+        std::vector<double> phase_costs;
+        std::vector<std::size_t> phase_groups;
+        phase_costs.reserve(slots.size());
+        phase_groups.reserve(slots.size());
+        for (auto slot : slots) {
+            phase_costs.push_back(costs[slot]);
+            phase_groups.push_back(groups[slot]);
+        }
+        work_queue queue(phase_costs, phase_groups, workers);
+
+        auto run_worker = [&](std::size_t worker) {
+            while (auto item = queue.next(worker)) {
+                auto start = std::chrono::steady_clock::now();
+                analyze_into(worker, slots[*item]);
+                busy_seconds[worker] += seconds_since(start);
+            }
+        };
+
+        if (workers == 1) {
+            run_worker(0);
+        } else {
+            boost::asio::thread_pool pool(workers);
+
+            for (std::size_t w = 0; w < workers; ++w) {
+                boost::asio::post(pool, [&, w] { run_worker(w); });
+            }
+
+            pool.join();
+        }
+
+        steals += queue.steals();
+    };
+
+    // Non-header files first, so the include graph is known before any
+    // header would be parsed on its own
+    if (clang_tool_) {
+        run_batches(source_slots);
+    } else {
+        run_phase(source_slots);
+    }
+
+    std::set<fs::path> covered_headers;
+    for (const auto& headers : included) {
+        covered_headers.insert(headers.begin(), headers.end());
+    }
+
+    std::vector<std::size_t> uncovered_slots;
+    for (auto slot : header_slots) {
+        if (covered_headers.count(pending_files[slot]) == 0) {
+            uncovered_slots.push_back(slot);
+        }
+    }
+    if (clang_tool_) {
+        run_batches(uncovered_slots);
+    } else {
+        run_phase(uncovered_slots);
+    }
+
+    if (cost_history_) {
+        for (std::size_t i = 0; i < source_files.size(); ++i) {
+            if (timings[i].total() > 0.0) {
+                cost_history_->record(source_files[i], timings[i]);
+            }
+        }
+    }
+
+    if (stats) {
+        stats->translation_units = source_files.size();
+        stats->workers = workers;
+        stats->steals = steals;
+        stats->wall_seconds = seconds_since(run_start);
+        stats->busy_seconds = 0.0;
+        for (double busy : busy_seconds) {
+            stats->busy_seconds += busy;
+        }
+        stats->parse_seconds = 0.0;
+        stats->match_seconds = 0.0;
+        for (const auto& timing : timings) {
+            stats->parse_seconds += timing.parse_seconds;
+            stats->match_seconds += timing.match_seconds;
+        }
+
+        stats->preambles = preambles.size();
+        stats->preambles_reused = preambles.reused();
+        stats->preamble_tus = 0;
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            if (preamble_for(slot)) {
+                ++stats->preamble_tus;
+            }
+        }
+        stats->umbrella_headers = source_files.size() - pending.size();
+        stats->covered_headers = header_slots.size() - uncovered_slots.size();
+        stats->lexically_skipped = lexically_skipped.load();
+        stats->invocation_templates = invocations.size();
+        stats->invocations_reused = invocations.reused();
+        stats->duplicate_findings = header_findings.duplicates();
+        if (result_cache_) {
+            stats->cache_hits = result_cache_->hits() - hits_before;
+            stats->cache_misses = result_cache_->misses() - misses_before;
+        }
+
+        const file_cache_statistics cache_after = file_cache_->statistics();
+        stats->file_cache.lookups = cache_after.lookups - cache_before.lookups;
+        stats->file_cache.hits = cache_after.hits - cache_before.hits;
+    }
+
+    for (auto& buffer : failure_buffers) {
+        failed_files.insert(
+            failed_files.end(),
+            std::make_move_iterator(buffer.begin()),
+            std::make_move_iterator(buffer.end())
+        );
+    }
+    std::sort(failed_files.begin(), failed_files.end(),
+              [](const file_analysis_result& a, const file_analysis_result& b) {
+                  return a.file < b.file;
+              });
+
+    finding_buffers.push_back(std::move(umbrella_findings));
+    finding_buffers.push_back(header_findings.take());
+    return merge_findings(std::move(finding_buffers));
+}
+
+preamble_plan ast_detector::plan_preamble_use(
+    const std::vector<include_prefix>& prefixes,
+    const std::vector<std::vector<std::string>>& tu_args
+) const {
+    std::vector<std::string> flag_keys;
+    flag_keys.reserve(tu_args.size());
+    for (const auto& args : tu_args) {
+        flag_keys.push_back(flags_key(args));
+    }
+
+    return plan_preambles(flag_keys, prefixes);
+}
+
+std::vector<std::string> ast_detector::refresh_file_cache() const {
+    // Precompiled prefixes check their own inputs when next reused
+    return file_cache_->refresh();
+}
+
+unsigned int ast_detector::effective_jobs() const {
+    if (jobs_ > 0) {
+        return jobs_;
+    }
+
+    // hardware_concurrency() may return 0 if it cannot be determined
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<std::string> ast_detector::compiler_args_for(const fs::path& source_file) const {
+    // Get compiler arguments (from compilation database or defaults)
+    if (compile_db_ && compile_db_->is_loaded()) {
+        auto flags_opt = compile_db_->get_flags_for_file(source_file);
+        if (flags_opt) {
+            return build_compiler_args(*flags_opt);
         }
+        // File not in compilation database, use defaults
     }
 
-    return all_findings;
+    return get_default_compiler_args();
 }
 
 std::vector<std::string> ast_detector::get_default_compiler_args() const {
@@ -8,10 +8,16 @@
 
 #include "profile/rule.hpp"
 #include "intake/compile_commands.hpp"
+#include "analysis/file_cache.hpp"
+#include "analysis/lexical_scan.hpp"
+#include "analysis/preamble.hpp"
+#include "analysis/scheduler.hpp"
 #include <boost/filesystem.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 namespace boost {
 namespace safeprofile {
@@ -30,12 +36,149 @@ struct ast_finding {
     std::string snippet;  // Code snippet showing the violation
 };
 
+/// Why a file could not be analyzed
+enum class failure_kind {
+    none,               // Analysis succeeded
+    compilation_error,  // Clang could not build an AST
+    crashed,            // Isolated worker process died (signal or abnormal exit)
+    out_of_memory,      // Isolated worker exceeded its memory cap
+    limit_exceeded,     // Time, file size or AST size limit hit (see analysis_limits)
+    internal_error      // Unreadable file or exception inside the analyzer
+};
+
+/// Per-TU resource limits for untrusted inputs (0 = unlimited)
+struct analysis_limits {
+    double time_budget_seconds = 0.0;       // Wall clock per TU
+    std::uintmax_t max_file_size_bytes = 0; // Main file size, checked before parsing
+    std::size_t max_ast_memory_mb = 0;      // Memory allocated for the AST
+    unsigned int max_template_depth = 0;    // Instantiation depth (-ftemplate-depth)
+};
+
 /// Analysis result for a single file
 struct file_analysis_result {
     fs::path file;
     bool success;  // true if analysis succeeded, false if compilation failed
+    failure_kind failure = failure_kind::none;  // reason if success == false
     std::string error_message;  // populated if success == false
     std::vector<ast_finding> findings;  // populated if success == true
+    tu_timing timing;  // Time spent parsing and matching this file
+};
+
+/// Project files by canonical path (symlinks and ".." resolved)
+using project_file_map = std::unordered_map<std::string, fs::path>;
+
+/// Statistics for one analyze_files() run
+struct analysis_statistics {
+    std::size_t translation_units = 0;
+    std::size_t workers = 0;
+    std::size_t steals = 0;       // TUs taken from another worker's queue
+    double wall_seconds = 0.0;    // Elapsed time for the whole run
+    double busy_seconds = 0.0;    // Sum of per-TU analysis time over all workers
+    double parse_seconds = 0.0;   // Sum of per-TU time in the Clang frontend
+    double match_seconds = 0.0;   // Sum of per-TU time running the matchers
+    file_cache_statistics file_cache;  // Header stat/read lookups during the run
+    std::size_t preambles = 0;    // Shared include prefixes precompiled
+    std::size_t preamble_tus = 0; // TUs that started from a precompiled prefix
+    std::size_t preambles_reused = 0;  // Precompiled prefixes kept from an earlier run
+    std::size_t umbrella_headers = 0;  // Headers analyzed inside an umbrella TU
+    std::size_t covered_headers = 0;   // Headers skipped: already analyzed via an #include
+    std::size_t duplicate_findings = 0;  // Header findings reported by more than one TU
+    std::size_t cache_hits = 0;    // TUs answered from the result cache
+    std::size_t cache_misses = 0;  // TUs the result cache had to analyze
+    std::size_t lexically_skipped = 0;  // TUs not parsed: no rule's trigger tokens appear
+    std::size_t invocation_templates = 0;  // Distinct command lines run through the driver
+    std::size_t invocations_reused = 0;    // TUs that started from a copied invocation
+
+    /// busy / (wall * workers); 1.0 means no worker ever sat idle
+    double parallel_efficiency() const {
+        if (wall_seconds <= 0.0 || workers == 0) {
+            return 0.0;
+        }
+        return busy_seconds / (wall_seconds * static_cast<double>(workers));
+    }
+};
+
+/// Canonical finding order: (file, line, column, rule_id), with message and
+/// snippet as tie-breakers so the order is total
+bool finding_less(const ast_finding& a, const ast_finding& b);
+
+/// Merge per-worker finding buffers into one list in canonical order
+/// Buffers may be unsorted; the result is independent of how findings
+/// were distributed across buffers
+std::vector<ast_finding> merge_findings(std::vector<std::vector<ast_finding>> buffers);
+
+class ast_detector;
+class result_cache;
+class compile_commands_database;
+class invocation_cache;
+
+/// Which files a matcher set reports findings in
+enum class match_scope {
+    main_file,      // Only the TU's main file (the default)
+    project_files   // The main file plus the project files its filter knows; used for
+                    // umbrella TUs and header deduplication
+};
+
+/// Which AST nodes a matcher set visits
+enum class match_traversal {
+    as_spelled,  // Only code as written: no template instantiations or implicit nodes (the default)
+    all_nodes    // Clang's default: every template instantiation and implicit node too
+};
+
+/// How analyze_files() uses a lexical scan of each TU before parsing it
+enum class lexical_prefilter {
+    off,    // Register every matcher
+    prune,  // Register only the matchers whose trigger tokens appear (the default)
+    skip    // Also skip parsing TUs in which no matcher can fire
+};
+
+/// Immutable set of AST matchers for a list of profile rules
+/// Built once per run and shared read-only across all translation units,
+/// so every TU is parsed once and matched against every rule in one pass
+class matcher_set {
+public:
+    explicit matcher_set(
+        const std::vector<profile::rule>& rules,
+        match_scope scope = match_scope::main_file,
+        match_traversal traversal = match_traversal::as_spelled
+    );
+
+    /// Rules that have an AST matcher, in profile order
+    const std::vector<profile::rule>& rules() const;
+
+    /// IDs of rules that have no AST matcher (skipped during analysis)
+    const std::vector<std::string>& unsupported_rules() const;
+
+    /// True if no rule in the set can be matched
+    bool empty() const { return rules().empty(); }
+
+private:
+    friend class ast_detector;
+    struct impl;
+    std::shared_ptr<const impl> impl_;
+};
+
+/// Precompiled preamble of one open editor buffer
+/// Holds Clang's PrecompiledPreamble for the buffer's leading block of
+/// preprocessor directives (includes, include guard, macros) between
+/// ast_detector::analyze_buffer() calls, so an edit below that block
+/// re-parses only the rest of the file.
+class buffer_preamble {
+public:
+    buffer_preamble();
+    ~buffer_preamble();
+
+    buffer_preamble(const buffer_preamble&) = delete;
+    buffer_preamble& operator=(const buffer_preamble&) = delete;
+
+    /// True if the last analysis started from the preamble built earlier
+    bool reused() const { return reused_; }
+
+private:
+    friend class ast_detector;
+    struct impl;
+    std::unique_ptr<impl> impl_;
+    bool reused_ = false;
 };
 
 /// AST-based detector using Clang LibTooling
@@ -54,33 +197,291 @@ public:
         additional_include_paths_ = paths;
     }
 
-    /// Analyze a single source file using AST
+    /// Set the number of translation units analyzed concurrently
+    /// 0 (the default) uses the hardware concurrency
+    void set_jobs(unsigned int jobs) {
+        jobs_ = jobs;
+    }
+
+    /// Number of worker threads analyze_files() will use
+    /// (with process isolation: worker processes, forked from one thread)
+    unsigned int effective_jobs() const;
+
+    /// Pick up on-disk changes before another analyze_files() run
+    /// The detector's file cache and precompiled prefixes outlive a run, and
+    /// the cache is a snapshot: edits made after a file was first read are
+    /// not seen. A long-lived detector calls this between runs; only entries
+    /// for files whose size, modification time or identity changed are
+    /// dropped, so everything else stays warm. Returns the changed paths.
+    std::vector<std::string> refresh_file_cache() const;
+
+    /// Set per-file timings from earlier runs
+    /// analyze_files() schedules the most expensive TUs first using this
+    /// history (or a size/include heuristic for unknown files), then records
+    /// the timings it measured back into it
+    void set_cost_history(std::shared_ptr<cost_history> history) {
+        cost_history_ = std::move(history);
+    }
+
+    /// Analyze each TU in a forked worker process
+    /// A crash or runaway allocation then fails only that file; a non-zero
+    /// memory_limit_mb caps how far each worker's address space (RLIMIT_AS)
+    /// may grow beyond what it inherits. Up to effective_jobs() workers run
+    /// at once; all are forked and polled from the calling thread, since
+    /// forking from a multithreaded process is unsafe
+    void set_process_isolation(bool enabled, std::size_t memory_limit_mb = 0) {
+        isolate_ = enabled;
+        memory_limit_mb_ = memory_limit_mb;
+    }
+
+    /// Set per-TU limits
+    /// Time and AST size are enforced by cooperatively cancelling the Clang
+    /// frontend; in process isolation mode a worker that overruns its time
+    /// budget by 2x is also killed. Files that hit a limit fail with
+    /// failure_kind::limit_exceeded.
+    void set_limits(const analysis_limits& limits) {
+        limits_ = limits;
+    }
+
+    /// Precompile include prefixes shared by several TUs (default: on)
+    /// analyze_files() groups TUs by their compiler arguments, finds the
+    /// longest run of leading #include <...> lines each shares with others
+    /// in its group, and builds one PCH per prefix for the run. A TU that
+    /// fails to compile with its PCH is retried without it.
+    void set_precompiled_preambles(bool enabled) {
+        precompiled_preambles_ = enabled;
+    }
+
+    /// Parse headers together as umbrella TUs (default: off)
+    /// For header-only libraries, analyze_files() builds one synthetic TU per
+    /// set of compiler arguments that includes every discovered header, parses
+    /// it once, and attributes each finding to the header it is written in.
+    /// Headers whose inclusion breaks the umbrella are parsed standalone.
+    void set_umbrella_headers(bool enabled) {
+        umbrella_headers_ = enabled;
+    }
+
+    /// Analyze project headers through the TUs that include them (default: on)
+    /// analyze_files() parses non-header files first, recording which of the
+    /// discovered headers each one includes and reporting findings in those
+    /// headers too. Headers already covered that way are not parsed again on
+    /// their own; findings several TUs report in the same header are merged.
+    void set_header_deduplication(bool enabled) {
+        header_deduplication_ = enabled;
+    }
+
+    /// Traverse only declarations written in the files a TU reports on (default: on)
+    /// Every matcher already ignores code outside those files; with this
+    /// set, matching also skips walking the declarations of everything the
+    /// TU included (the standard library, Boost, other dependencies).
+    /// Findings are the same either way.
+    void set_traversal_scope(bool enabled) {
+        traversal_scope_ = enabled;
+    }
+
+    /// Which AST nodes analyze_files() matches (default: as spelled)
+    /// By default each construct is matched once, where it is written;
+    /// match_traversal::all_nodes also visits every template instantiation
+    /// and compiler-generated node. Either way, repeated matches at the same
+    /// location are reported once.
+    void set_match_traversal(match_traversal traversal) {
+        match_traversal_ = traversal;
+    }
+
+    /// Skip parsing function bodies outside the reported files (default: off)
+    /// The standard library's and Boost's inline function bodies are then
+    /// only skimmed for their braces, not parsed and checked. Clang still
+    /// parses bodies it needs for the reported code: those of constexpr
+    /// functions and of functions with a deduced return type. Errors inside
+    /// skipped bodies go unnoticed, so a file can succeed that would fail
+    /// a full parse. Precompiled include prefixes are built in full.
+    void set_fast_parse(bool enabled) {
+        fast_parse_ = enabled;
+    }
+
+    /// Scan each TU with the raw lexer before parsing it (default: prune)
+    /// A rule whose matcher needs a token that appears neither in the file
+    /// nor in a project header it reports on (`new`, `delete`, a C-style
+    /// cast, `return &x` or `return x;`) is left out of that TU; an all-caps
+    /// name that could be a macro keeps every rule in. Findings are the same
+    /// either way. lexical_prefilter::skip also reports a TU in which no rule
+    /// can fire as analyzed without parsing it, so its compilation errors go
+    /// unnoticed.
+    void set_lexical_prefilter(lexical_prefilter mode) {
+        lexical_prefilter_ = mode;
+    }
+
+    /// Parse each distinct command line with the driver once (default: on)
+    /// analyze_files() groups TUs by their compiler arguments, turns each
+    /// group's arguments into a -cc1 CompilerInvocation once and gives every
+    /// TU a copy with its own main file, instead of running the driver per
+    /// TU. The work queue also keeps each group together, so a worker goes
+    /// through TUs with the same include paths back-to-back. Not used with
+    /// process isolation.
+    void set_invocation_reuse(bool enabled) {
+        invocation_reuse_ = enabled;
+    }
+
+    /// Run TUs through tooling::ClangTool over the compilation database (default: off)
+    /// Each worker hands its share of the TUs to one ClangTool run, which
+    /// compiles every file with the entry's full command line (forced
+    /// includes, target flags, warnings options and all) in the entry's own
+    /// working directory, and shares one FileManager across the share.
+    /// Files without an entry get the default arguments. Precompiled include
+    /// prefixes, umbrella headers and process isolation are not used in
+    /// this mode.
+    void set_clang_tool(bool enabled) {
+        clang_tool_ = enabled;
+    }
+
+    /// Reuse per-TU results from earlier runs
+    /// analyze_files() skips Clang entirely for a TU whose contents, transitive
+    /// includes, compiler arguments, rules and tool version are unchanged;
+    /// cached compilation failures are reported as before
+    void set_result_cache(std::shared_ptr<result_cache> cache) {
+        result_cache_ = std::move(cache);
+    }
+
+    /// Analyze a single source file against a single rule
     /// Returns result with success status and findings (or error message)
     file_analysis_result analyze_file(
         const fs::path& source_file,
         const profile::rule& rule
     ) const;
 
+    /// Analyze a single source file against every rule in a matcher set
+    /// The file is parsed once; findings for all rules come from one pass
+    file_analysis_result analyze_file(
+        const fs::path& source_file,
+        const matcher_set& matchers
+    ) const;
+
     /// Analyze a single source file with explicit compiler flags
     /// Used internally when compilation database is available
     file_analysis_result analyze_file_with_flags(
         const fs::path& source_file,
-        const profile::rule& rule,
+        const matcher_set& matchers,
         const std::vector<std::string>& compiler_args
     ) const;
 
+    /// Analyze the unsaved contents of a file, as an editor holds them
+    /// The buffer stands in for the file on disk; the compiler arguments are
+    /// the file's own (see set_compilation_database). The preamble is built
+    /// on the first call and rebuilt only when the directives it covers,
+    /// the arguments, or a file it read has changed.
+    file_analysis_result analyze_buffer(
+        const fs::path& source_file,
+        const std::string& contents,
+        const matcher_set& matchers,
+        buffer_preamble& preamble
+    ) const;
+
     /// Analyze multiple source files
+    /// Translation units are analyzed concurrently on effective_jobs() workers,
+    /// longest-first with work stealing; findings are returned in canonical
+    /// order (see finding_less) and failed files sorted by path, so output is
+    /// identical to a serial run
     /// Returns findings from all successfully analyzed files
     /// Files that fail to compile are tracked separately
     std::vector<ast_finding> analyze_files(
         const std::vector<fs::path>& source_files,
         const std::vector<profile::rule>& rules,
-        std::vector<file_analysis_result>& failed_files  // OUT: files that failed analysis
+        std::vector<file_analysis_result>& failed_files,  // OUT: files that failed analysis
+        analysis_statistics* stats = nullptr               // OUT (optional): run statistics
     ) const;
 
 private:
     std::shared_ptr<intake::compile_commands_reader> compile_db_;
     std::vector<std::string> additional_include_paths_;  // Inferred include paths
+    unsigned int jobs_ = 0;  // 0 = hardware concurrency
+    std::shared_ptr<cost_history> cost_history_;  // Optional scheduling history
+    bool isolate_ = false;              // Analyze TUs in forked workers
+    std::size_t memory_limit_mb_ = 0;   // Per-worker cap (0 = unlimited)
+    analysis_limits limits_;
+    bool precompiled_preambles_ = true;
+    bool umbrella_headers_ = false;
+    bool header_deduplication_ = true;
+    bool traversal_scope_ = true;
+    match_traversal match_traversal_ = match_traversal::as_spelled;
+    bool fast_parse_ = false;
+    lexical_prefilter lexical_prefilter_ = lexical_prefilter::prune;
+    bool invocation_reuse_ = true;
+    bool clang_tool_ = false;
+    std::shared_ptr<result_cache> result_cache_;  // Optional persistent results
+
+    /// Per-TU inputs and outputs of analyze_tu() beyond the file itself
+    struct tu_options {
+        const precompiled_header* pch = nullptr;           // Precompiled include prefix
+        const project_file_map* project_headers = nullptr; // Also report findings in these
+        std::vector<fs::path>* included = nullptr;         // OUT: project headers entered
+        std::vector<std::string>* dependencies = nullptr;  // OUT: every file read
+        trigger_mask header_triggers = 0;                  // Found in the project headers it reaches
+        bool* skipped = nullptr;                           // OUT: not parsed, nothing could fire
+        invocation_cache* invocations = nullptr;           // Driver-parsed templates to copy
+    };
+    // Shared by every tool invocation, and kept across runs
+    llvm::IntrusiveRefCntPtr<caching_file_system> file_cache_ =
+        llvm::makeIntrusiveRefCnt<caching_file_system>();
+    std::shared_ptr<preamble_set> preambles_ = std::make_shared<preamble_set>();
+
+    /// Analyze one TU, optionally starting from a precompiled include prefix
+    file_analysis_result analyze_tu(
+        const fs::path& source_file,
+        const matcher_set& matchers,
+        const std::vector<std::string>& compiler_args,
+        const tu_options& options
+    ) const;
+
+    /// Outcome of one TU of analyze_batch()
+    struct batch_result {
+        file_analysis_result result;
+        std::vector<fs::path> included;         // Project headers entered
+        std::vector<std::string> dependencies;  // Every file read
+        bool skipped = false;                   // Not parsed, nothing could fire
+    };
+
+    /// Analyze TUs in one tooling::ClangTool run, with the commands `database`
+    /// gives; results are in the order of `source_files`
+    std::vector<batch_result> analyze_batch(
+        const std::vector<fs::path>& source_files,
+        const matcher_set& matchers,
+        const compile_commands_database& database,
+        const project_file_map* project_headers,
+        const std::vector<trigger_mask>& header_triggers,  // One per source file
+        bool record_dependencies
+    ) const;
+
+    /// Parse several headers as one synthetic TU
+    /// On a compilation error, `offending` receives the headers whose
+    /// inclusion produced errors
+    file_analysis_result analyze_umbrella(
+        const std::vector<fs::path>& headers,
+        const matcher_set& matchers,
+        const std::vector<std::string>& compiler_args,
+        std::vector<fs::path>& offending
+    ) const;
+
+    /// Analyze headers with identical arguments as umbrella TUs
+    /// Sets covered[i] for each header whose findings came from an umbrella
+    std::vector<ast_finding> analyze_umbrellas(
+        const std::vector<fs::path>& source_files,
+        const std::vector<std::vector<std::string>>& tu_args,
+        const std::vector<profile::rule>& rules,
+        std::vector<bool>& covered,
+        std::size_t workers
+    ) const;
+
+    /// Assign TUs to shared include prefixes, given each TU's scanned prefix
+    preamble_plan plan_preamble_use(
+        const std::vector<include_prefix>& prefixes,
+        const std::vector<std::vector<std::string>>& tu_args
+    ) const;
+
+    /// Append arguments implied by the per-TU limits
+    std::vector<std::string> with_limit_args(std::vector<std::string> args) const;
+
+    /// Select compiler arguments for a file (compilation database or defaults)
+    std::vector<std::string> compiler_args_for(const fs::path& source_file) const;
 
     /// Build default compiler arguments if no compilation database available
     std::vector<std::string> get_default_compiler_args() const;
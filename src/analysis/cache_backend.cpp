@@ -0,0 +1,173 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "cache_backend.hpp"
+#include <boost/safeprofile/version.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+constexpr std::size_t max_blob_bytes = 64 * 1024 * 1024;
+
+} // namespace
+
+directory_backend::directory_backend(fs::path directory) : directory_(std::move(directory)) {}
+
+std::optional<std::string> directory_backend::get(const std::string& key) {
+    std::ifstream ifs((directory_ / key.substr(0, 2) / key).string(), std::ios::binary);
+    if (!ifs) {
+        return std::nullopt;
+    }
+
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+void directory_backend::put(const std::string& key, const std::string& data) {
+    auto path = directory_ / key.substr(0, 2) / key;
+    boost::system::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    // Readers never see a partial blob
+    auto temp = fs::path(path.string() + fs::unique_path(".%%%%%%%%.tmp").string());
+    {
+        std::ofstream ofs(temp.string(), std::ios::binary);
+        if (!ofs) {
+            return;  // Caching is best effort
+        }
+        ofs << data;
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+    }
+}
+
+http_backend::http_backend(const std::string& url, double timeout_seconds)
+    : url_(url), timeout_seconds_(timeout_seconds) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        throw std::runtime_error("Remote cache URL must start with http://: " + url);
+    }
+
+    std::string rest = url.substr(scheme.size());
+    std::size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    if (slash != std::string::npos) {
+        prefix_ = rest.substr(slash);
+        while (!prefix_.empty() && prefix_.back() == '/') {
+            prefix_.pop_back();
+        }
+    }
+
+    std::size_t colon = authority.rfind(':');
+    host_ = authority.substr(0, colon);
+    port_ = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+    if (host_.empty() || port_.empty() ||
+        port_.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::runtime_error("Malformed remote cache URL: " + url);
+    }
+}
+
+std::optional<http_backend::response> http_backend::send(
+    bool put,
+    const std::string& key,
+    const std::string& body
+) {
+    if (!available()) {
+        return std::nullopt;
+    }
+
+    try {
+        boost::asio::io_context io;
+        tcp::resolver resolver(io);
+        beast::tcp_stream stream(io);
+        beast::error_code ec;
+
+        // tcp_stream deadlines only apply to asynchronous operations, so
+        // each step is started asynchronously and driven to completion
+        auto complete = [&] {
+            io.restart();
+            io.run();
+            if (ec) {
+                throw beast::system_error(ec);
+            }
+        };
+
+        auto endpoints = resolver.resolve(host_, port_);
+        stream.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeout_seconds_)));
+        stream.async_connect(endpoints, [&](beast::error_code e, const tcp::endpoint&) { ec = e; });
+        complete();
+
+        http::request<http::string_body> request{put ? http::verb::put : http::verb::get,
+                                                 prefix_ + "/cas/" + key, 11};
+        request.set(http::field::host, host_);
+        request.set(http::field::user_agent, std::string("boost-safeprofile/") + version::string);
+        if (put) {
+            request.set(http::field::content_type, "application/octet-stream");
+            request.body() = body;
+        }
+        request.prepare_payload();
+        http::async_write(stream, request, [&](beast::error_code e, std::size_t) { ec = e; });
+        complete();
+
+        beast::flat_buffer buffer;
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(max_blob_bytes);
+        http::async_read(stream, buffer, parser, [&](beast::error_code e, std::size_t) { ec = e; });
+        complete();
+
+        beast::error_code ignored;
+        stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+
+        response result;
+        result.status = parser.get().result_int();
+        result.body = std::move(parser.get().body());
+        if (result.status >= 500) {
+            throw std::runtime_error("server error");
+        }
+
+        consecutive_failures_ = 0;
+        return result;
+    } catch (const std::exception&) {
+        ++failures_;
+        ++consecutive_failures_;
+        return std::nullopt;
+    }
+}
+
+std::optional<std::string> http_backend::get(const std::string& key) {
+    auto result = send(false, key, std::string());
+    if (!result || result->status != 200) {
+        return std::nullopt;
+    }
+    return std::move(result->body);
+}
+
+void http_backend::put(const std::string& key, const std::string& data) {
+    send(true, key, data);
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
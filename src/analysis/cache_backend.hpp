@@ -0,0 +1,98 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_CACHE_BACKEND_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_CACHE_BACKEND_HPP
+
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+/// Blob store behind result_cache
+/// Keys are lowercase hex digests. Implementations are called from
+/// several analysis threads at once and never throw from get()/put():
+/// an unreachable store behaves like an empty one.
+class cache_backend {
+public:
+    virtual ~cache_backend() = default;
+
+    /// Blob stored under a key, or nullopt if absent or unreachable
+    virtual std::optional<std::string> get(const std::string& key) = 0;
+
+    /// Store a blob (best effort)
+    virtual void put(const std::string& key, const std::string& data) = 0;
+
+    /// Directory or URL, for messages
+    virtual std::string describe() const = 0;
+};
+
+/// Blobs as files under a directory: <dir>/<key[0:2]>/<key>
+/// Written via temp file + rename, so concurrent runs may share it
+class directory_backend : public cache_backend {
+public:
+    explicit directory_backend(fs::path directory);
+
+    std::optional<std::string> get(const std::string& key) override;
+    void put(const std::string& key, const std::string& data) override;
+    std::string describe() const override { return directory_.string(); }
+
+private:
+    fs::path directory_;
+};
+
+/// Content-addressed store over plain HTTP/1.1
+/// GET <url>/cas/<key> answers 200 with the blob or 404; PUT stores the
+/// request body under the key. Every request has a deadline; after
+/// max_failures consecutive errors the backend stops contacting the
+/// server for the rest of the run, so an outage costs a few timeouts
+/// rather than one per translation unit.
+class http_backend : public cache_backend {
+public:
+    static constexpr std::size_t max_failures = 3;
+
+    /// url: http://host[:port][/prefix]
+    /// Throws std::runtime_error for other schemes or a malformed URL
+    explicit http_backend(const std::string& url, double timeout_seconds = 2.0);
+
+    std::optional<std::string> get(const std::string& key) override;
+    void put(const std::string& key, const std::string& data) override;
+    std::string describe() const override { return url_; }
+
+    /// False once the server has been given up on
+    bool available() const { return consecutive_failures_.load() < max_failures; }
+
+    /// Requests that failed (timeouts, connection or server errors)
+    std::size_t failures() const { return failures_.load(); }
+
+private:
+    struct response {
+        unsigned int status = 0;
+        std::string body;
+    };
+
+    std::optional<response> send(bool put, const std::string& key, const std::string& body);
+
+    std::string url_;
+    std::string host_;
+    std::string port_;
+    std::string prefix_;
+    double timeout_seconds_;
+    std::atomic<std::size_t> consecutive_failures_{0};
+    std::atomic<std::size_t> failures_{0};
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_CACHE_BACKEND_HPP
@@ -0,0 +1,63 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "compilation_database.hpp"
+#include <boost/filesystem.hpp>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+compile_commands_database::compile_commands_database(
+    std::shared_ptr<const intake::compile_commands_reader> reader,
+    std::vector<std::string> fallback_args,
+    std::vector<std::string> extra_args
+) : reader_(std::move(reader)),
+    fallback_args_(std::move(fallback_args)),
+    extra_args_(std::move(extra_args)) {}
+
+std::vector<clang::tooling::CompileCommand> compile_commands_database::getCompileCommands(
+    llvm::StringRef file_path
+) const {
+    if (reader_ && reader_->is_loaded()) {
+        auto flags = reader_->get_flags_for_file(fs::path(file_path.str()));
+        if (flags && !flags->arguments.empty()) {
+            std::vector<std::string> command_line = flags->arguments;
+            command_line.insert(command_line.end(), extra_args_.begin(), extra_args_.end());
+            return {clang::tooling::CompileCommand(
+                flags->working_directory, flags->file, std::move(command_line), "")};
+        }
+    }
+
+    std::vector<std::string> command_line = {"clang-tool"};
+    command_line.insert(command_line.end(), fallback_args_.begin(), fallback_args_.end());
+    command_line.push_back(file_path.str());
+    return {clang::tooling::CompileCommand(
+        fs::current_path().string(), file_path.str(), std::move(command_line), "")};
+}
+
+std::vector<std::string> compile_commands_database::getAllFiles() const {
+    if (!reader_ || !reader_->is_loaded()) {
+        return {};
+    }
+    return reader_->files();
+}
+
+std::vector<clang::tooling::CompileCommand> compile_commands_database::getAllCompileCommands() const {
+    std::vector<clang::tooling::CompileCommand> commands;
+    for (const auto& file : getAllFiles()) {
+        auto file_commands = getCompileCommands(file);
+        commands.insert(commands.end(),
+                        std::make_move_iterator(file_commands.begin()),
+                        std::make_move_iterator(file_commands.end()));
+    }
+    return commands;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
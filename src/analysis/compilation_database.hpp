@@ -0,0 +1,49 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_COMPILATION_DATABASE_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_COMPILATION_DATABASE_HPP
+
+#include "intake/compile_commands.hpp"
+#include <clang/Tooling/CompilationDatabase.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// tooling::CompilationDatabase over a compile_commands_reader
+/// Each file has exactly one command (the reader keeps the last entry
+/// listed for a file): the entry's full command line in its own working
+/// directory, with `extra_args` appended. A file without an entry (or
+/// every file, if the reader is null or not loaded) gets `fallback_args`
+/// in the current directory, so tooling::ClangTool never skips a file.
+class compile_commands_database : public clang::tooling::CompilationDatabase {
+public:
+    compile_commands_database(
+        std::shared_ptr<const intake::compile_commands_reader> reader,
+        std::vector<std::string> fallback_args,
+        std::vector<std::string> extra_args = {}
+    );
+
+    std::vector<clang::tooling::CompileCommand> getCompileCommands(llvm::StringRef file_path) const override;
+
+    std::vector<std::string> getAllFiles() const override;
+
+    std::vector<clang::tooling::CompileCommand> getAllCompileCommands() const override;
+
+private:
+    std::shared_ptr<const intake::compile_commands_reader> reader_;
+    std::vector<std::string> fallback_args_;
+    std::vector<std::string> extra_args_;
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_COMPILATION_DATABASE_HPP
@@ -4,58 +4,97 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "detector.hpp"
-#include <fstream>
-#include <sstream>
+#include "lexical_scan.hpp"
+#include <llvm/Support/MemoryBuffer.h>
+#include <algorithm>
 
 namespace boost {
 namespace safeprofile {
 namespace analysis {
 
+namespace {
+
+// Trigger whose tokens a rule's candidates are, or 0 if it needs an AST
+trigger_mask trigger_for(const std::string& rule_id) {
+    if (rule_id == "SP-OWN-001") {
+        return triggers::new_keyword;
+    }
+    if (rule_id == "SP-OWN-002") {
+        return triggers::delete_keyword;
+    }
+    if (rule_id == "SP-TYPE-001") {
+        return triggers::cast;
+    }
+    return 0;
+}
+
+} // namespace
+
 std::vector<finding> detector::analyze(
-    const std::vector<intake::source_file>& sources,
+    const std::vector<fs::path>& files,
     const std::vector<profile::rule>& rules) const {
 
     std::vector<finding> findings;
 
-    // For each source file
-    for (const auto& source : sources) {
-        // Apply each rule
-        for (const auto& rule : rules) {
-            auto file_findings = search_file(source.path, rule);
-            findings.insert(findings.end(), file_findings.begin(), file_findings.end());
-        }
+    for (const auto& file : files) {
+        auto file_findings = scan_file(file, rules);
+        findings.insert(findings.end(), file_findings.begin(), file_findings.end());
     }
 
     return findings;
 }
 
-std::vector<finding> detector::search_file(
+std::vector<finding> detector::scan_file(
     const fs::path& file_path,
-    const profile::rule& rule) const {
+    const std::vector<profile::rule>& rules) const {
 
     std::vector<finding> findings;
 
-    std::ifstream file(file_path.string());
-    if (!file.is_open()) {
+    trigger_mask wanted = 0;
+    for (const auto& rule : rules) {
+        wanted |= trigger_for(rule.id);
+    }
+    if (wanted == 0) {
+        return findings;
+    }
+
+    // Large files are mapped rather than read
+    auto buffer = llvm::MemoryBuffer::getFile(file_path.string(), /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/true);
+    if (!buffer) {
         return findings;  // Skip files we can't open
     }
+    const llvm::StringRef text = (*buffer)->getBuffer();
 
-    std::string line;
-    int line_number = 0;
+    // Matches come in source order, so lines are counted in one pass
+    std::size_t line_start = 0;
+    int line_number = 1;
+    for (const auto& match : find_triggers(text)) {
+        if ((match.trigger & wanted) == 0) {
+            continue;
+        }
+
+        for (std::size_t pos = text.find('\n', line_start); pos < match.offset;
+             pos = text.find('\n', line_start)) {
+            line_start = pos + 1;
+            ++line_number;
+        }
+        std::size_t line_end = std::min(text.find('\n', match.offset), text.size());
+        llvm::StringRef line = text.slice(line_start, line_end).rtrim("\r");
 
-    while (std::getline(file, line)) {
-        ++line_number;
+        for (const auto& rule : rules) {
+            if (trigger_for(rule.id) != match.trigger) {
+                continue;
+            }
 
-        // Phase 0: Simple substring search for the pattern
-        size_t pos = line.find(rule.pattern);
-        if (pos != std::string::npos) {
             finding f;
             f.rule_id = rule.id;
             f.file_path = file_path;
             f.line_number = line_number;
-            f.column_number = static_cast<int>(pos) + 1;  // 1-based column
-            f.snippet = line;
+            f.column_number = static_cast<int>(match.offset - line_start) + 1;  // 1-based column
+            f.snippet = line.trim().str();
             f.severity = rule.level;
+            f.lexical = true;
 
             findings.push_back(f);
         }
@@ -26,24 +26,30 @@ struct finding {
     int column_number;             // Column number (1-based)
     std::string snippet;           // Code snippet showing violation
     profile::severity severity;    // Severity level from rule
+    bool lexical = false;          // Token-level candidate from a file without an AST
 };
 
-/// Simple keyword-based detector (Phase 0 stub)
+/// Token-level triage for files Clang could not parse
+/// Scans each file with the raw lexer (see find_triggers()): no
+/// preprocessing, no includes, no types. Comments, literals and directives
+/// are skipped, but a `new`, `delete` or C-style cast is reported wherever
+/// it is written, including in code a failed parse would have rejected or
+/// an #if would have excluded. Findings are candidates, marked lexical.
 class detector {
 public:
     detector() = default;
 
-    /// Analyze source files against rules
-    /// Phase 0: Simple keyword search in file contents
+    /// Report SP-OWN-001, SP-OWN-002 and SP-TYPE-001 candidates in files
+    /// Other rules need an AST and are ignored; unreadable files are skipped
     std::vector<finding> analyze(
-        const std::vector<intake::source_file>& sources,
+        const std::vector<fs::path>& files,
         const std::vector<profile::rule>& rules) const;
 
 private:
-    /// Search a single file for a pattern
-    std::vector<finding> search_file(
+    /// Scan a single file for every rule's trigger tokens
+    std::vector<finding> scan_file(
         const fs::path& file_path,
-        const profile::rule& rule) const;
+        const std::vector<profile::rule>& rules) const;
 };
 
 } // namespace analysis
@@ -0,0 +1,282 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "file_cache.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <mutex>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+/// A file whose contents live in the cache
+/// Hands out non-owning views of the cached buffer, so no bytes are copied
+class cached_file : public llvm::vfs::File {
+public:
+    cached_file(llvm::vfs::Status status, std::shared_ptr<llvm::MemoryBuffer> contents)
+        : status_(std::move(status)), contents_(std::move(contents)) {}
+
+    llvm::ErrorOr<llvm::vfs::Status> status() override {
+        return status_;
+    }
+
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getBuffer(
+        const llvm::Twine& /*name*/,
+        int64_t /*file_size*/,
+        bool requires_null_terminator,
+        bool /*is_volatile*/
+    ) override {
+        return llvm::MemoryBuffer::getMemBuffer(
+            contents_->getMemBufferRef(), requires_null_terminator);
+    }
+
+    std::error_code close() override {
+        return {};
+    }
+
+private:
+    llvm::vfs::Status status_;
+    std::shared_ptr<llvm::MemoryBuffer> contents_;
+};
+
+} // anonymous namespace
+
+caching_file_system::caching_file_system()
+    : caching_file_system(llvm::vfs::createPhysicalFileSystem()) {}
+
+caching_file_system::caching_file_system(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base)
+    : ProxyFileSystem(std::move(base)) {}
+
+std::optional<caching_file_system::stat_entry>
+caching_file_system::cached_status(const std::string& path) const {
+    std::shared_lock lock(mutex_);
+    auto it = stats_.find(path);
+    if (it == stats_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+caching_file_system::stat_entry caching_file_system::lookup_status(const std::string& path) {
+    ++lookups_;
+    if (auto cached = cached_status(path)) {
+        ++hits_;
+        return *cached;
+    }
+
+    stat_entry entry;
+    auto result = ProxyFileSystem::status(path);
+    if (result) {
+        entry.status = *result;
+    } else {
+        entry.error = result.getError();
+    }
+
+    std::unique_lock lock(mutex_);
+    // Another thread may have raced us; keep whichever landed first
+    return stats_.emplace(path, std::move(entry)).first->second;
+}
+
+llvm::ErrorOr<llvm::vfs::Status> caching_file_system::status(const llvm::Twine& path) {
+    std::string key = path.str();
+
+    // Relative paths depend on a working directory; don't cache them
+    if (!llvm::sys::path::is_absolute(key)) {
+        return ProxyFileSystem::status(path);
+    }
+
+    auto entry = lookup_status(key);
+    if (entry.error) {
+        return entry.error;
+    }
+    return llvm::vfs::Status::copyWithNewName(entry.status, key);
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+caching_file_system::openFileForRead(const llvm::Twine& path) {
+    std::string key = path.str();
+
+    if (!llvm::sys::path::is_absolute(key)) {
+        return ProxyFileSystem::openFileForRead(path);
+    }
+
+    auto entry = lookup_status(key);
+    if (entry.error) {
+        return entry.error;
+    }
+    auto status = llvm::vfs::Status::copyWithNewName(entry.status, key);
+
+    ++lookups_;
+    {
+        std::shared_lock lock(mutex_);
+        auto it = contents_.find(key);
+        if (it != contents_.end()) {
+            ++hits_;
+            return std::make_unique<cached_file>(status, it->second);
+        }
+    }
+
+    auto buffer = getUnderlyingFS().getBufferForFile(key);
+    if (!buffer) {
+        return buffer.getError();
+    }
+    std::shared_ptr<llvm::MemoryBuffer> contents = std::move(*buffer);
+
+    std::unique_lock lock(mutex_);
+    contents = contents_.emplace(key, std::move(contents)).first->second;
+    return std::make_unique<cached_file>(status, contents);
+}
+
+std::optional<std::string> caching_file_system::content_hash(const std::string& path) {
+    {
+        std::shared_lock lock(mutex_);
+        auto it = hashes_.find(path);
+        if (it != hashes_.end()) {
+            return it->second;
+        }
+    }
+
+    auto buffer = getBufferForFile(path);
+    if (!buffer) {
+        return std::nullopt;
+    }
+
+    llvm::SHA1 sha1;
+    sha1.update((*buffer)->getBuffer());
+    std::string hash = llvm::toHex(sha1.final(), /*LowerCase=*/true);
+
+    std::unique_lock lock(mutex_);
+    return hashes_.emplace(path, std::move(hash)).first->second;
+}
+
+std::error_code caching_file_system::setCurrentWorkingDirectory(const llvm::Twine& /*path*/) {
+    // Changing the shared base would affect every concurrent TU
+    return std::make_error_code(std::errc::operation_not_permitted);
+}
+
+file_cache_statistics caching_file_system::statistics() const {
+    file_cache_statistics result;
+    result.lookups = lookups_.load();
+    result.hits = hits_.load();
+    return result;
+}
+
+bool caching_file_system::same_entry(const stat_entry& a, const stat_entry& b) {
+    if (a.error || b.error) {
+        return static_cast<bool>(a.error) == static_cast<bool>(b.error);
+    }
+    return a.status.getUniqueID() == b.status.getUniqueID() &&
+           a.status.getSize() == b.status.getSize() &&
+           a.status.getLastModificationTime() == b.status.getLastModificationTime();
+}
+
+std::vector<std::string> caching_file_system::refresh() {
+    std::vector<std::pair<std::string, stat_entry>> snapshot;
+    {
+        std::shared_lock lock(mutex_);
+        snapshot.assign(stats_.begin(), stats_.end());
+    }
+
+    // Stat without holding the lock; analysis may continue meanwhile
+    std::vector<std::string> changed;
+    for (const auto& [path, entry] : snapshot) {
+        stat_entry current;
+        auto result = ProxyFileSystem::status(path);
+        if (result) {
+            current.status = *result;
+        } else {
+            current.error = result.getError();
+        }
+        if (!same_entry(entry, current)) {
+            changed.push_back(path);
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    for (const auto& path : changed) {
+        stats_.erase(path);
+        contents_.erase(path);
+        hashes_.erase(path);
+    }
+    return changed;
+}
+
+void caching_file_system::clear() {
+    std::unique_lock lock(mutex_);
+    stats_.clear();
+    contents_.clear();
+    hashes_.clear();
+}
+
+working_directory_file_system::working_directory_file_system(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base
+) : ProxyFileSystem(std::move(base)) {
+    llvm::SmallString<256> current;
+    if (!llvm::sys::fs::current_path(current)) {
+        directory_ = current.str().str();
+    }
+}
+
+std::string working_directory_file_system::absolute(const llvm::Twine& path) const {
+    llvm::SmallString<256> result;
+    path.toVector(result);
+    if (!llvm::sys::path::is_absolute(result)) {
+        llvm::SmallString<256> prefixed(directory_);
+        llvm::sys::path::append(prefixed, result);
+        result = std::move(prefixed);
+    }
+    llvm::sys::path::remove_dots(result, /*remove_dot_dot=*/false);
+    return result.str().str();
+}
+
+llvm::ErrorOr<llvm::vfs::Status> working_directory_file_system::status(const llvm::Twine& path) {
+    return ProxyFileSystem::status(absolute(path));
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+working_directory_file_system::openFileForRead(const llvm::Twine& path) {
+    return ProxyFileSystem::openFileForRead(absolute(path));
+}
+
+llvm::vfs::directory_iterator working_directory_file_system::dir_begin(
+    const llvm::Twine& dir,
+    std::error_code& ec
+) {
+    return ProxyFileSystem::dir_begin(absolute(dir), ec);
+}
+
+std::error_code working_directory_file_system::getRealPath(
+    const llvm::Twine& path,
+    llvm::SmallVectorImpl<char>& output
+) const {
+    return ProxyFileSystem::getRealPath(absolute(path), output);
+}
+
+llvm::ErrorOr<std::string> working_directory_file_system::getCurrentWorkingDirectory() const {
+    return directory_;
+}
+
+std::error_code working_directory_file_system::setCurrentWorkingDirectory(const llvm::Twine& path) {
+    auto target = absolute(path);
+    auto entry = status(target);
+    if (!entry) {
+        return entry.getError();
+    }
+    if (!entry->isDirectory()) {
+        return std::make_error_code(std::errc::not_a_directory);
+    }
+    directory_ = std::move(target);
+    return {};
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
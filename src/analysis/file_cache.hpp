@@ -0,0 +1,123 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_FILE_CACHE_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_FILE_CACHE_HPP
+
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// Hit/miss counters for caching_file_system
+struct file_cache_statistics {
+    std::size_t lookups = 0;  // status() and openFileForRead() calls served
+    std::size_t hits = 0;     // ...answered from memory
+
+    double hit_rate() const {
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+/// Thread-safe, process-wide caching overlay over the real file system
+/// Every TU in a run re-stats and re-reads the same standard library and
+/// Boost headers, and include-path probing stats dozens of missing paths per
+/// #include. This file system remembers stat results (including failures)
+/// and file contents for absolute paths, so each is touched on disk once and
+/// then served from memory to every tool invocation on every thread.
+/// Contents are treated as a snapshot: changes on disk after the first read
+/// are not observed until clear() is called.
+class caching_file_system : public llvm::vfs::ProxyFileSystem {
+public:
+    caching_file_system();
+    explicit caching_file_system(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base);
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override;
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(const llvm::Twine& path) override;
+
+    /// The cache is shared across threads, so its working directory is fixed
+    std::error_code setCurrentWorkingDirectory(const llvm::Twine& path) override;
+
+    /// Hex SHA-1 of a file's contents, read (and remembered) through the cache
+    /// Returns nullopt if the file cannot be read
+    std::optional<std::string> content_hash(const std::string& path);
+
+    /// Snapshot of hit/miss counters since construction
+    file_cache_statistics statistics() const;
+
+    /// Drop every cached entry
+    void clear();
+
+    /// Re-stat every cached path and drop the entries of files that changed
+    /// (size, modification time, identity, or whether they exist)
+    /// Returns the changed paths
+    std::vector<std::string> refresh();
+
+private:
+    struct stat_entry {
+        std::error_code error;
+        llvm::vfs::Status status;
+    };
+
+    static bool same_entry(const stat_entry& a, const stat_entry& b);
+
+    std::optional<stat_entry> cached_status(const std::string& path) const;
+    stat_entry lookup_status(const std::string& path);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, stat_entry> stats_;
+    std::unordered_map<std::string, std::shared_ptr<llvm::MemoryBuffer>> contents_;
+    std::unordered_map<std::string, std::string> hashes_;
+
+    std::atomic<std::size_t> lookups_{0};
+    std::atomic<std::size_t> hits_{0};
+};
+
+/// View of a shared file system with a working directory of its own
+/// caching_file_system refuses to change directory, since every thread
+/// shares it. Tools that change directory per TU (tooling::ClangTool) go
+/// through one of these instead: relative paths are made absolute here, so
+/// the shared cache below only ever sees absolute ones.
+class working_directory_file_system : public llvm::vfs::ProxyFileSystem {
+public:
+    /// Starts in the process's current directory
+    explicit working_directory_file_system(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base);
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override;
+
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+    openFileForRead(const llvm::Twine& path) override;
+
+    llvm::vfs::directory_iterator dir_begin(const llvm::Twine& dir, std::error_code& ec) override;
+
+    std::error_code getRealPath(const llvm::Twine& path, llvm::SmallVectorImpl<char>& output) const override;
+
+    llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+
+    std::error_code setCurrentWorkingDirectory(const llvm::Twine& path) override;
+
+private:
+    std::string absolute(const llvm::Twine& path) const;
+
+    std::string directory_;
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_FILE_CACHE_HPP
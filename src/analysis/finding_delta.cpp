@@ -0,0 +1,117 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "finding_delta.hpp"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+// Clang may spell a header differently than directory discovery did
+std::string normalized(const fs::path& path) {
+    return fs::absolute(path).lexically_normal().generic_string();
+}
+
+bool failure_less(const file_analysis_result& a, const file_analysis_result& b) {
+    return a.file < b.file;
+}
+
+} // namespace
+
+template <class InScope>
+finding_delta tracked_findings::apply(
+    InScope in_scope,
+    std::vector<ast_finding> findings,
+    std::vector<file_analysis_result> failed
+) {
+    finding_delta delta;
+
+    // Findings: old and new within the scope, each in canonical order
+    std::vector<ast_finding> before;
+    std::vector<ast_finding> kept;
+    for (auto& finding : findings_) {
+        (in_scope(finding.file) ? before : kept).push_back(std::move(finding));
+    }
+    std::vector<ast_finding> after;
+    for (auto& finding : findings) {
+        if (in_scope(finding.file)) {
+            after.push_back(std::move(finding));
+        }
+    }
+    std::sort(after.begin(), after.end(), finding_less);
+
+    std::set_difference(after.begin(), after.end(), before.begin(), before.end(),
+                        std::back_inserter(delta.added), finding_less);
+    std::set_difference(before.begin(), before.end(), after.begin(), after.end(),
+                        std::back_inserter(delta.resolved), finding_less);
+
+    findings_.clear();
+    std::merge(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()),
+               std::make_move_iterator(after.begin()), std::make_move_iterator(after.end()),
+               std::back_inserter(findings_), finding_less);
+
+    // Failures: keyed by file, compared by message
+    std::map<std::string, std::string> failing_before;
+    std::vector<file_analysis_result> still_failing;
+    for (auto& failure : failures_) {
+        if (in_scope(failure.file)) {
+            failing_before[normalized(failure.file)] = failure.error_message;
+        } else {
+            still_failing.push_back(std::move(failure));
+        }
+    }
+
+    std::set<std::string> failing_after;
+    for (auto& failure : failed) {
+        auto key = normalized(failure.file);
+        failing_after.insert(key);
+        auto previous = failing_before.find(key);
+        if (previous == failing_before.end() || previous->second != failure.error_message) {
+            delta.failed.push_back(failure);
+        }
+        still_failing.push_back(std::move(failure));
+    }
+    for (const auto& entry : failing_before) {
+        if (!failing_after.count(entry.first)) {
+            delta.recovered.emplace_back(entry.first);
+        }
+    }
+
+    std::sort(still_failing.begin(), still_failing.end(), failure_less);
+    std::sort(delta.failed.begin(), delta.failed.end(), failure_less);
+    failures_ = std::move(still_failing);
+    return delta;
+}
+
+finding_delta tracked_findings::update(
+    const std::vector<fs::path>& scope,
+    std::vector<ast_finding> findings,
+    std::vector<file_analysis_result> failed
+) {
+    std::set<std::string> files;
+    for (const auto& path : scope) {
+        files.insert(normalized(path));
+    }
+    for (const auto& failure : failed) {
+        files.insert(normalized(failure.file));
+    }
+    return apply([&](const fs::path& file) { return files.count(normalized(file)) > 0; },
+                 std::move(findings), std::move(failed));
+}
+
+finding_delta tracked_findings::replace(std::vector<ast_finding> findings, std::vector<file_analysis_result> failed) {
+    return apply([](const fs::path&) { return true; }, std::move(findings), std::move(failed));
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,70 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_FINDING_DELTA_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_FINDING_DELTA_HPP
+
+#include "analysis/ast_detector.hpp"
+#include <boost/filesystem.hpp>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+/// Difference between two reports on the same tree
+struct finding_delta {
+    std::vector<ast_finding> added;               // Canonical order
+    std::vector<ast_finding> resolved;            // Canonical order
+    std::vector<file_analysis_result> failed;     // Newly failing, or failing differently
+    std::vector<fs::path> recovered;              // Failed before; analyzed or gone now
+
+    bool empty() const {
+        return added.empty() && resolved.empty() && failed.empty() && recovered.empty();
+    }
+};
+
+/// A tree's findings and failures, kept current by partial re-analysis
+/// Each update names the files it re-analyzed (plus any that were
+/// deleted); what was recorded for those files is replaced, and the rest
+/// is kept. Findings a run reports outside that scope, such as those in
+/// unchanged headers an analyzed TU includes, are left as recorded.
+class tracked_findings {
+public:
+    /// Replace what is recorded for the files in `scope`
+    finding_delta update(
+        const std::vector<fs::path>& scope,
+        std::vector<ast_finding> findings,
+        std::vector<file_analysis_result> failed
+    );
+
+    /// Replace everything: the whole tree was re-analyzed
+    finding_delta replace(std::vector<ast_finding> findings, std::vector<file_analysis_result> failed);
+
+    /// Current findings in canonical order
+    const std::vector<ast_finding>& findings() const { return findings_; }
+
+    /// Current failures, sorted by file
+    const std::vector<file_analysis_result>& failures() const { return failures_; }
+
+private:
+    template <class InScope>
+    finding_delta apply(
+        InScope in_scope,
+        std::vector<ast_finding> findings,
+        std::vector<file_analysis_result> failed
+    );
+
+    std::vector<ast_finding> findings_;
+    std::vector<file_analysis_result> failures_;
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_FINDING_DELTA_HPP
@@ -0,0 +1,69 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "finding_set.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+std::string finding_key(const ast_finding& finding) {
+    std::string key = finding.file.string();
+    key += '\0';
+    key += std::to_string(finding.line);
+    key += ':';
+    key += std::to_string(finding.column);
+    key += '\0';
+    key += finding.rule_id;
+    return key;
+}
+
+} // anonymous namespace
+
+finding_set::finding_set(std::size_t shards) {
+    shards_.resize(std::max<std::size_t>(shards, 1));
+    for (auto& s : shards_) {
+        s = std::make_unique<shard>();
+    }
+}
+
+bool finding_set::insert(ast_finding finding) {
+    std::string key = finding_key(finding);
+    auto& s = *shards_[std::hash<std::string>{}(key) % shards_.size()];
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto [it, inserted] = s.findings.try_emplace(std::move(key), finding);
+    if (inserted) {
+        return true;
+    }
+
+    ++duplicates_;
+    if (finding_less(finding, it->second)) {
+        it->second = std::move(finding);
+    }
+    return false;
+}
+
+std::vector<ast_finding> finding_set::take() {
+    std::vector<ast_finding> result;
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        for (auto& entry : s->findings) {
+            result.push_back(std::move(entry.second));
+        }
+        s->findings.clear();
+    }
+
+    std::sort(result.begin(), result.end(), finding_less);
+    return result;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
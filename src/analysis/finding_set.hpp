@@ -0,0 +1,53 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_FINDING_SET_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_FINDING_SET_HPP
+
+#include "analysis/ast_detector.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// Concurrent set of findings keyed by (file, line, column, rule_id)
+/// Collects findings in shared headers, which several TUs may report.
+/// Sharded by key hash so workers rarely contend. When two TUs report the
+/// same key, the one that sorts first (finding_less) is kept, so the result
+/// does not depend on which TU got there first.
+class finding_set {
+public:
+    explicit finding_set(std::size_t shards = 64);
+
+    /// Add a finding; returns false if its key was already present
+    bool insert(ast_finding finding);
+
+    /// Number of insert() calls that hit an existing key
+    std::size_t duplicates() const { return duplicates_.load(); }
+
+    /// Move all findings out, in canonical order
+    std::vector<ast_finding> take();
+
+private:
+    struct shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, ast_finding> findings;
+    };
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    std::atomic<std::size_t> duplicates_{0};
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_FINDING_SET_HPP
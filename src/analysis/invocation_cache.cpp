@@ -0,0 +1,78 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "invocation_cache.hpp"
+#include <clang/Frontend/Utils.h>
+#include <boost/filesystem.hpp>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+std::shared_ptr<clang::CompilerInvocation> invocation_cache::instantiate(
+    const std::vector<std::string>& args,
+    const std::string& file_name,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system
+) {
+    std::string key;
+    for (const auto& arg : args) {
+        key += arg;
+        key += '\0';
+    }
+    key += boost::filesystem::path(file_name).extension().string();
+
+    std::shared_ptr<const clang::CompilerInvocation> prototype;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = templates_.find(key);
+        if (it != templates_.end()) {
+            prototype = it->second;
+        }
+    }
+
+    if (prototype) {
+        reused_.fetch_add(1);
+    } else {
+        // Built outside the lock; two threads racing on a new group both
+        // run the driver, and the first to finish provides the template
+        std::vector<const char*> argv;
+        argv.reserve(args.size() + 1);
+        for (const auto& arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(file_name.c_str());
+
+        clang::CreateInvocationOptions options;
+        options.VFS = file_system;
+        std::shared_ptr<clang::CompilerInvocation> built = clang::createInvocation(argv, options);
+        if (!built) {
+            return nullptr;
+        }
+        // Let each instance free its AST, as tooling::ToolInvocation does
+        built->getFrontendOpts().DisableFree = false;
+        built->getCodeGenOpts().DisableFree = false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        prototype = templates_.emplace(key, std::move(built)).first->second;
+    }
+
+    auto invocation = std::make_shared<clang::CompilerInvocation>(*prototype);
+    auto& inputs = invocation->getFrontendOpts().Inputs;
+    if (inputs.size() != 1) {
+        return nullptr;
+    }
+    inputs[0] = clang::FrontendInputFile(file_name, inputs[0].getKind(), inputs[0].isSystem());
+    invocation->getCodeGenOpts().MainFileName = boost::filesystem::path(file_name).filename().string();
+    return invocation;
+}
+
+std::size_t invocation_cache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return templates_.size();
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,57 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_INVOCATION_CACHE_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_INVOCATION_CACHE_HPP
+
+#include <clang/Frontend/CompilerInvocation.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// Driver-parsed compiler invocations for one analyze_files() run
+/// TUs with identical arguments differ only in their main file, so the
+/// driver turns each distinct command line into a -cc1 CompilerInvocation
+/// once; every TU then starts from a copy with its own file as the input.
+/// Templates are keyed by the arguments and the main file's extension,
+/// which decides the input language. Safe to share between threads.
+class invocation_cache {
+public:
+    /// A fresh invocation that compiles `file_name` with `args`
+    /// `args` is the full command line without the file, tool name first.
+    /// The first TU of a group builds the template through the driver,
+    /// which probes `file_system` for the file and the toolchain. Returns
+    /// null if the driver rejects the command line.
+    std::shared_ptr<clang::CompilerInvocation> instantiate(
+        const std::vector<std::string>& args,
+        const std::string& file_name,
+        llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system
+    );
+
+    /// Number of command lines the driver parsed
+    std::size_t size() const;
+
+    /// Number of invocations copied from an existing template
+    std::size_t reused() const { return reused_.load(); }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const clang::CompilerInvocation>> templates_;
+    std::atomic<std::size_t> reused_{0};
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_INVOCATION_CACHE_HPP
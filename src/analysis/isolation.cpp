@@ -0,0 +1,427 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "isolation.hpp"
+#include "result_json.hpp"
+#include <llvm/Support/ErrorHandling.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BOOST_SAFEPROFILE_HAS_FORK 1
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+#ifdef BOOST_SAFEPROFILE_HAS_FORK
+
+namespace {
+
+// Child exit codes (the parent only trusts a payload from exit code 0)
+constexpr int exit_out_of_memory = 86;
+constexpr int exit_internal_error = 87;
+
+[[noreturn]] void exit_on_oom() {
+    _exit(exit_out_of_memory);
+}
+
+[[noreturn]] void exit_on_llvm_oom(void*, const char*, bool) {
+    _exit(exit_out_of_memory);
+}
+
+bool write_all(int fd, const std::string& data) {
+    const char* ptr = data.data();
+    std::size_t remaining = data.size();
+
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, ptr, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+// Address space the calling process already maps, in bytes (0 if unknown)
+// Uses only raw system calls, as it runs between fork() and the analysis
+rlim_t mapped_address_space() {
+#ifdef __linux__
+    int fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    char buffer[128];
+    ssize_t got = ::read(fd, buffer, sizeof(buffer));
+    ::close(fd);
+
+    // The first field is the total program size in pages
+    rlim_t pages = 0;
+    for (ssize_t i = 0; i < got && buffer[i] >= '0' && buffer[i] <= '9'; ++i) {
+        pages = pages * 10 + static_cast<rlim_t>(buffer[i] - '0');
+    }
+    long page_size = ::sysconf(_SC_PAGESIZE);
+    return page_size > 0 ? pages * static_cast<rlim_t>(page_size) : 0;
+#else
+    return 0;
+#endif
+}
+
+std::string encode(const worker_output& output) {
+    json::array included;
+    for (const auto& path : output.included) {
+        included.emplace_back(path.string());
+    }
+    json::array dependencies;
+    for (const auto& path : output.dependencies) {
+        dependencies.emplace_back(path);
+    }
+
+    json::object value;
+    value["result"] = to_json(output.result);
+    value["included"] = std::move(included);
+    value["dependencies"] = std::move(dependencies);
+    return json::serialize(value);
+}
+
+worker_output decode(const std::string& payload) {
+    json::value value = json::parse(payload);
+    const auto& object = value.as_object();
+
+    worker_output output;
+    output.result = result_from_json(object.at("result"));
+    for (const auto& path : object.at("included").as_array()) {
+        output.included.emplace_back(path.as_string().c_str());
+    }
+    for (const auto& path : object.at("dependencies").as_array()) {
+        output.dependencies.emplace_back(path.as_string().c_str());
+    }
+    return output;
+}
+
+// Runs in the forked child; never returns
+[[noreturn]] void run_child(
+    int write_fd,
+    const std::function<worker_output()>& analyze,
+    std::size_t memory_limit_mb
+) {
+    if (memory_limit_mb > 0) {
+        // The child starts with the parent's mappings; the cap bounds only
+        // what the analysis adds on top of them
+        rlim_t bytes = mapped_address_space() +
+                       static_cast<rlim_t>(memory_limit_mb) * 1024 * 1024;
+        struct rlimit limit{bytes, bytes};
+        setrlimit(RLIMIT_AS, &limit);
+    }
+
+    // Allocation failure under the cap must be reported, not mistaken
+    // for a crash
+    std::set_new_handler(exit_on_oom);
+    llvm::install_bad_alloc_error_handler(exit_on_llvm_oom);
+
+    try {
+        std::string payload = encode(analyze());
+        _exit(write_all(write_fd, payload) ? 0 : exit_internal_error);
+    } catch (const std::bad_alloc&) {
+        _exit(exit_out_of_memory);
+    } catch (...) {
+        _exit(exit_internal_error);
+    }
+}
+
+worker_output worker_failure(
+    const fs::path& source_file,
+    failure_kind kind,
+    std::string message
+) {
+    worker_output output;
+    output.result.file = source_file;
+    output.result.success = false;
+    output.result.failure = kind;
+    output.result.error_message = std::move(message);
+    return output;
+}
+
+// A forked worker whose pipe the parent is still reading
+struct running_worker {
+    isolated_job job;
+    pid_t pid = -1;
+    int fd = -1;
+    std::string payload;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
+
+// Why the parent stopped reading a worker's pipe
+enum class read_status {
+    complete,   // EOF: the child closed its end
+    timed_out,  // The job's deadline passed first
+    failed      // poll() or read() failed
+};
+
+// Fork a worker for its job; returns the failure if none could be started
+std::optional<worker_output> start_worker(running_worker& worker, std::size_t memory_limit_mb) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return worker_failure(worker.job.source_file, failure_kind::internal_error,
+                              std::string("Failed to create worker pipe: ") + std::strerror(errno));
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        int err = errno;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return worker_failure(worker.job.source_file, failure_kind::internal_error,
+                              std::string("Failed to fork worker: ") + std::strerror(err));
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        run_child(fds[1], worker.job.analyze, memory_limit_mb);
+    }
+
+    ::close(fds[1]);
+    worker.pid = pid;
+    worker.fd = fds[0];
+    if (worker.job.timeout_seconds > 0.0) {
+        worker.deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(worker.job.timeout_seconds));
+    }
+    return std::nullopt;
+}
+
+// Reap a worker the parent has stopped reading and decode its outcome
+worker_output finish_worker(
+    running_worker& worker,
+    read_status read,
+    int read_error,
+    std::size_t memory_limit_mb
+) {
+    const fs::path& source_file = worker.job.source_file;
+    ::close(worker.fd);
+
+    // A child whose pipe can no longer be read must not be waited for
+    // without a deadline either
+    if (read != read_status::complete) {
+        ::kill(worker.pid, SIGKILL);
+    }
+
+    int status = 0;
+    while (::waitpid(worker.pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return worker_failure(source_file, failure_kind::internal_error,
+                                  "Lost track of worker process");
+        }
+    }
+
+    if (read == read_status::failed) {
+        return worker_failure(source_file, failure_kind::internal_error,
+                              std::string("Failed to read worker result: ") + std::strerror(read_error));
+    }
+    if (read == read_status::timed_out) {
+        return worker_failure(source_file, failure_kind::limit_exceeded,
+            "Worker killed after exceeding hard time limit of " +
+            std::to_string(worker.job.timeout_seconds) + "s");
+    }
+
+    if (WIFSIGNALED(status)) {
+        int sig = WTERMSIG(status);
+        std::string message = "Worker crashed (signal " + std::to_string(sig) +
+                              ": " + ::strsignal(sig) + ")";
+        if (sig == SIGKILL) {
+            // The kernel OOM killer is the usual sender of an unexplained SIGKILL
+            message += "; possibly killed for exceeding available memory";
+        }
+        return worker_failure(source_file, failure_kind::crashed, message);
+    }
+
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    if (code == exit_out_of_memory) {
+        return worker_failure(source_file, failure_kind::out_of_memory,
+            "Worker exceeded memory limit" +
+            (memory_limit_mb > 0 ? " of " + std::to_string(memory_limit_mb) + " MB" : std::string()));
+    }
+    if (code != 0) {
+        return worker_failure(source_file, failure_kind::crashed,
+                              "Worker exited abnormally (status " + std::to_string(code) + ")");
+    }
+
+    try {
+        return decode(worker.payload);
+    } catch (const std::exception& e) {
+        return worker_failure(source_file, failure_kind::internal_error,
+                              std::string("Malformed worker result: ") + e.what());
+    }
+}
+
+} // namespace
+
+file_analysis_result run_isolated(
+    const fs::path& source_file,
+    const std::function<file_analysis_result()>& analyze,
+    std::size_t memory_limit_mb,
+    double timeout_seconds
+) {
+    return run_isolated(source_file, std::function<worker_output()>([&] {
+        worker_output output;
+        output.result = analyze();
+        return output;
+    }), memory_limit_mb, timeout_seconds).result;
+}
+
+worker_output run_isolated(
+    const fs::path& source_file,
+    const std::function<worker_output()>& analyze,
+    std::size_t memory_limit_mb,
+    double timeout_seconds
+) {
+    std::optional<isolated_job> job = isolated_job{source_file, analyze, timeout_seconds, 0};
+    worker_output output;
+    run_isolated_pool(1, memory_limit_mb,
+        [&] { return std::exchange(job, std::nullopt); },
+        [&](const isolated_job&, worker_output finished) { output = std::move(finished); });
+    return output;
+}
+
+void run_isolated_pool(
+    std::size_t parallel,
+    std::size_t memory_limit_mb,
+    const std::function<std::optional<isolated_job>()>& next,
+    const std::function<void(const isolated_job&, worker_output)>& done
+) {
+    using clock = std::chrono::steady_clock;
+    parallel = std::max<std::size_t>(parallel, 1);
+
+    std::vector<running_worker> running;
+    bool exhausted = false;
+    for (;;) {
+        while (!exhausted && running.size() < parallel) {
+            auto job = next();
+            if (!job) {
+                exhausted = true;
+                break;
+            }
+            running_worker worker;
+            worker.job = std::move(*job);
+            if (auto failure = start_worker(worker, memory_limit_mb)) {
+                done(worker.job, std::move(*failure));
+            } else {
+                running.push_back(std::move(worker));
+            }
+        }
+        if (running.empty()) {
+            return;
+        }
+
+        // Sleep until a pipe has data or the nearest deadline passes
+        const auto now = clock::now();
+        long long wait_ms = 1000;
+        std::vector<pollfd> fds;
+        fds.reserve(running.size());
+        for (const auto& worker : running) {
+            fds.push_back(pollfd{worker.fd, POLLIN, 0});
+            if (worker.deadline != clock::time_point::max()) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    worker.deadline - now).count();
+                wait_ms = std::clamp<long long>(remaining, 0, wait_ms);
+            }
+        }
+        int ready = ::poll(fds.data(), fds.size(), static_cast<int>(wait_ms));
+        const int poll_error = (ready < 0 && errno != EINTR) ? errno : 0;
+
+        std::vector<running_worker> waiting;
+        std::vector<std::pair<isolated_job, worker_output>> finished;
+        for (std::size_t i = 0; i < running.size(); ++i) {
+            running_worker& worker = running[i];
+            std::optional<read_status> read;
+            int read_error = poll_error;
+
+            if (poll_error != 0) {
+                read = read_status::failed;
+            } else if (ready > 0 && fds[i].revents != 0) {
+                char chunk[65536];
+                ssize_t got = ::read(worker.fd, chunk, sizeof(chunk));
+                if (got > 0) {
+                    worker.payload.append(chunk, static_cast<std::size_t>(got));
+                } else if (got == 0) {
+                    read = read_status::complete;
+                } else if (errno != EINTR && errno != EAGAIN) {
+                    read = read_status::failed;
+                    read_error = errno;
+                }
+            }
+            if (!read && clock::now() >= worker.deadline) {
+                read = read_status::timed_out;
+            }
+
+            if (read) {
+                worker_output output = finish_worker(worker, *read, read_error, memory_limit_mb);
+                finished.emplace_back(std::move(worker.job), std::move(output));
+            } else {
+                waiting.push_back(std::move(worker));
+            }
+        }
+        running = std::move(waiting);
+
+        for (auto& [job, output] : finished) {
+            done(job, std::move(output));
+        }
+    }
+}
+
+#else
+
+file_analysis_result run_isolated(
+    const fs::path&,
+    const std::function<file_analysis_result()>& analyze,
+    std::size_t,
+    double
+) {
+    return analyze();
+}
+
+worker_output run_isolated(
+    const fs::path&,
+    const std::function<worker_output()>& analyze,
+    std::size_t,
+    double
+) {
+    return analyze();
+}
+
+void run_isolated_pool(
+    std::size_t,
+    std::size_t,
+    const std::function<std::optional<isolated_job>()>& next,
+    const std::function<void(const isolated_job&, worker_output)>& done
+) {
+    while (auto job = next()) {
+        done(*job, job->analyze());
+    }
+}
+
+#endif
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
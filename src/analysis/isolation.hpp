@@ -0,0 +1,78 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_ISOLATION_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_ISOLATION_HPP
+
+#include "analysis/ast_detector.hpp"
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// What an isolated worker sends back to the parent process
+struct worker_output {
+    file_analysis_result result;
+    std::vector<fs::path> included;         // Project headers the TU entered
+    std::vector<std::string> dependencies;  // Files it read, for the result cache
+};
+
+/// Run one file's analysis in a forked worker process
+/// The child caps its address space (RLIMIT_AS) at what it inherited plus
+/// memory_limit_mb (0 = none), runs analyze and sends the result back over
+/// a pipe. If the child crashes, runs out of memory or exits abnormally,
+/// the returned result is a failure for source_file with failure_kind and
+/// error_message describing why; the calling process is unaffected. A
+/// child still running after timeout_seconds (0 = no timeout) is killed
+/// and reported as failure_kind::limit_exceeded.
+/// Must be called while the process has a single thread: the child of a
+/// multithreaded fork may block forever on a lock another thread held.
+/// On platforms without fork() the analysis runs in-process.
+file_analysis_result run_isolated(
+    const fs::path& source_file,
+    const std::function<file_analysis_result()>& analyze,
+    std::size_t memory_limit_mb,
+    double timeout_seconds = 0.0
+);
+
+/// run_isolated() for an analysis that also reports what the TU included
+/// and read; on failure only `result` is set
+worker_output run_isolated(
+    const fs::path& source_file,
+    const std::function<worker_output()>& analyze,
+    std::size_t memory_limit_mb,
+    double timeout_seconds = 0.0
+);
+
+/// One analysis for run_isolated_pool()
+struct isolated_job {
+    fs::path source_file;
+    std::function<worker_output()> analyze;
+    double timeout_seconds = 0.0;  // 0 = no timeout
+    std::size_t tag = 0;           // The caller's, handed back to `done`
+};
+
+/// Run jobs in forked workers, up to `parallel` at a time
+/// Each job runs as in run_isolated(). The calling thread forks every
+/// worker and polls all of their pipes, so it must be the process's only
+/// thread. `next` is asked for another job whenever a worker is free
+/// (nullopt: no more); `done` gets each job's output, in the calling
+/// process and in completion order.
+void run_isolated_pool(
+    std::size_t parallel,
+    std::size_t memory_limit_mb,
+    const std::function<std::optional<isolated_job>()>& next,
+    const std::function<void(const isolated_job&, worker_output)>& done
+);
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_ISOLATION_HPP
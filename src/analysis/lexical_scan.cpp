@@ -0,0 +1,262 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "lexical_scan.hpp"
+#include <clang/Basic/LangOptions.h>
+#include <clang/Lex/Lexer.h>
+#include <llvm/ADT/StringSet.h>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+using clang::tok::TokenKind;
+namespace tok = clang::tok;
+
+struct raw_token {
+    TokenKind kind;
+    llvm::StringRef text;  // Identifiers and keywords only
+    std::size_t offset;    // Of the token's first character in the source
+};
+
+clang::LangOptions scan_language() {
+    clang::LangOptions options;
+    options.CPlusPlus = true;
+    options.CPlusPlus11 = true;  // Raw string literals
+    options.CPlusPlus14 = true;
+    options.CPlusPlus17 = true;
+    options.CPlusPlus20 = true;
+    options.LineComment = true;
+    options.Digraphs = true;
+    options.Bool = true;
+    return options;
+}
+
+/// Lex everything outside of directives, plus #define bodies; collects the
+/// names the text #defines itself
+std::vector<raw_token> lex(std::string_view source, llvm::StringSet<>& defined) {
+    static const clang::LangOptions language = scan_language();
+    clang::Lexer lexer(clang::SourceLocation(), language,
+                       source.data(), source.data(), source.data() + source.size());
+
+    std::vector<raw_token> tokens;
+    tokens.reserve(source.size() / 4);
+
+    clang::Token token;
+    enum { code, directive, skipped, define_name } state = code;
+    for (;;) {
+        lexer.LexFromRawLexer(token);
+        if (token.is(tok::eof)) {
+            break;
+        }
+
+        if (token.isAtStartOfLine()) {
+            state = code;
+            if (token.is(tok::hash)) {
+                state = directive;
+                continue;
+            }
+        } else if (state == directive) {
+            // #include, #if and friends: nothing in them is code
+            bool define = token.is(tok::raw_identifier) && token.getRawIdentifier() == "define";
+            state = define ? define_name : skipped;
+            continue;
+        } else if (state == skipped) {
+            continue;
+        } else if (state == define_name) {
+            // Kept as a token, so a parameter list does not look like a cast
+            if (token.is(tok::raw_identifier)) {
+                defined.insert(token.getRawIdentifier());
+            }
+            state = code;  // The body is scanned like code
+        }
+
+        const char* end = lexer.getBufferLocation();
+        raw_token raw{token.getKind(), {}, static_cast<std::size_t>(end - source.data()) - token.getLength()};
+        if (token.is(tok::raw_identifier)) {
+            raw.text = token.getRawIdentifier();
+        }
+        tokens.push_back(raw);
+    }
+    return tokens;
+}
+
+bool is_name(const raw_token& token) {
+    return token.kind == tok::raw_identifier;
+}
+
+bool is_name(const raw_token& token, llvm::StringRef text) {
+    return token.kind == tok::raw_identifier && token.text == text;
+}
+
+// All-caps identifiers are macros by convention; reserved names (__LINE__)
+// are the compiler's own
+bool looks_like_macro(llvm::StringRef name) {
+    if (name.size() < 2 || name.starts_with("__")) {
+        return false;
+    }
+    bool letter = false;
+    for (char c : name) {
+        if (c >= 'A' && c <= 'Z') {
+            letter = true;
+        } else if (!(c == '_' || (c >= '0' && c <= '9'))) {
+            return false;
+        }
+    }
+    return letter;
+}
+
+// Keywords after which a parenthesized expression begins an operand,
+// including the alternative operator spellings
+bool starts_operand_context(const raw_token& token) {
+    static const char* const keywords[] = {
+        "return", "case", "throw", "co_return", "co_yield", "co_await", "else", "do",
+        "delete", "new", "and", "or", "not", "xor", "bitand", "bitor", "compl"
+    };
+    for (const char* keyword : keywords) {
+        if (token.text == keyword) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool starts_operand(const raw_token& token) {
+    switch (token.kind) {
+        case tok::raw_identifier:
+        case tok::numeric_constant:
+        case tok::char_constant:
+        case tok::wide_char_constant:
+        case tok::utf8_char_constant:
+        case tok::utf16_char_constant:
+        case tok::utf32_char_constant:
+        case tok::string_literal:
+        case tok::wide_string_literal:
+        case tok::utf8_string_literal:
+        case tok::utf16_string_literal:
+        case tok::utf32_string_literal:
+        case tok::l_paren:
+        case tok::star:
+        case tok::amp:
+        case tok::plus:
+        case tok::minus:
+        case tok::exclaim:
+        case tok::tilde:
+        case tok::plusplus:
+        case tok::minusminus:
+        case tok::coloncolon:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Could tokens[open] start a C-style cast: `(` type-id `)` operand?
+bool looks_like_cast(const std::vector<raw_token>& tokens, std::size_t open) {
+    if (open > 0) {
+        const raw_token& before = tokens[open - 1];
+        // f(x), if (x), sizeof(T), x[i](y): calls, conditions and operators
+        if ((is_name(before) && !starts_operand_context(before)) || before.kind == tok::r_square) {
+            return false;
+        }
+    }
+
+    // A type-id: names, scopes, template arguments, pointers, references,
+    // and the parentheses of function pointer types
+    std::size_t depth = 0;
+    std::size_t i = open + 1;
+    for (; i < tokens.size(); ++i) {
+        TokenKind kind = tokens[i].kind;
+        if (kind == tok::r_paren) {
+            if (depth == 0) {
+                break;
+            }
+            --depth;
+        } else if (kind == tok::l_paren) {
+            ++depth;
+        } else if (kind != tok::raw_identifier && kind != tok::coloncolon && kind != tok::less &&
+                   kind != tok::greater && kind != tok::greatergreater && kind != tok::comma &&
+                   kind != tok::star && kind != tok::amp && kind != tok::ampamp &&
+                   kind != tok::numeric_constant && kind != tok::l_square && kind != tok::r_square &&
+                   kind != tok::ellipsis) {
+            return false;
+        }
+    }
+    if (i == open + 1 || i + 1 >= tokens.size()) {
+        return false;  // () or unbalanced
+    }
+    // A lambda is an operand too: (void)[&] { ... }()
+    return starts_operand(tokens[i + 1]) || tokens[i + 1].kind == tok::l_square;
+}
+
+/// Call visit(trigger, token) for every trigger in source order, until it
+/// returns false
+template <typename Visit>
+void for_each_trigger(const std::vector<raw_token>& tokens, const llvm::StringSet<>& defined, Visit visit) {
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        const raw_token& token = tokens[i];
+        const raw_token* before = i > 0 ? &tokens[i - 1] : nullptr;
+        const raw_token* after = i + 1 < tokens.size() ? &tokens[i + 1] : nullptr;
+
+        trigger_mask trigger = 0;
+        if (is_name(token, "new")) {
+            trigger = triggers::new_keyword;
+        } else if (is_name(token, "delete")) {
+            if (!before || before->kind != tok::equal) {
+                trigger = triggers::delete_keyword;
+            }
+        } else if (is_name(token, "return")) {
+            if (after && (after->kind == tok::amp ||
+                          (is_name(*after) && i + 2 < tokens.size() && tokens[i + 2].kind == tok::semi))) {
+                trigger = triggers::return_local;
+            }
+        } else if (token.kind == tok::l_paren) {
+            if (looks_like_cast(tokens, i)) {
+                trigger = triggers::cast;
+            }
+        } else if (is_name(token) && looks_like_macro(token.text) && !defined.contains(token.text)) {
+            trigger = triggers::macro;
+        }
+
+        if (trigger != 0 && !visit(trigger, token)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+trigger_mask scan_triggers(std::string_view source) {
+    llvm::StringSet<> defined;
+    auto tokens = lex(source, defined);
+
+    trigger_mask found = 0;
+    for_each_trigger(tokens, defined, [&](trigger_mask trigger, const raw_token&) {
+        found |= trigger;
+        return found != triggers::all;
+    });
+    return found;
+}
+
+std::vector<lexical_match> find_triggers(std::string_view source) {
+    llvm::StringSet<> defined;
+    auto tokens = lex(source, defined);
+
+    std::vector<lexical_match> matches;
+    for_each_trigger(tokens, defined, [&](trigger_mask trigger, const raw_token& token) {
+        if (trigger != triggers::macro) {
+            matches.push_back({trigger, token.offset});
+        }
+        return true;
+    });
+    return matches;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,61 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_LEXICAL_SCAN_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_LEXICAL_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+/// Set of rule trigger tokens (see triggers::)
+using trigger_mask = std::uint32_t;
+
+/// Token patterns without which a rule's AST matcher cannot fire
+namespace triggers {
+constexpr trigger_mask new_keyword = 1u << 0;     // `new`
+constexpr trigger_mask delete_keyword = 1u << 1;  // `delete`, other than `= delete`
+constexpr trigger_mask cast = 1u << 2;            // `(` type `)` before an operand
+constexpr trigger_mask return_local = 1u << 3;    // `return &...` or `return name;`
+constexpr trigger_mask macro = 1u << 4;           // A macro defined elsewhere may expand to anything
+constexpr trigger_mask all = new_keyword | delete_keyword | cast | return_local | macro;
+} // namespace triggers
+
+/// Scan source text with Clang's raw lexer (no preprocessing, no includes)
+/// Comments, literals and the insides of directives other than #define
+/// are ignored. Macros cannot be expanded, so an all-caps name that is not
+/// #defined in the same text counts as triggers::macro; a lowercase macro
+/// from a header that expands to a trigger is not noticed.
+/// `source` must be followed by a NUL character, as std::string and
+/// llvm::MemoryBuffer contents are.
+trigger_mask scan_triggers(std::string_view source);
+
+/// One trigger token found by find_triggers()
+struct lexical_match {
+    trigger_mask trigger;  // A single triggers:: bit, never triggers::macro
+    std::size_t offset;    // Byte offset of the token (`(` for a cast)
+};
+
+/// Every trigger in `source`, in source order
+/// Same scan and requirements as scan_triggers(); names that may be macros
+/// are not matches.
+std::vector<lexical_match> find_triggers(std::string_view source);
+
+/// True if a rule requiring any of `required` (0: nothing lexical) can
+/// fire in text whose scan found `present`
+inline bool may_fire(trigger_mask required, trigger_mask present) {
+    return required == 0 || (present & (required | triggers::macro)) != 0;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_LEXICAL_SCAN_HPP
@@ -0,0 +1,397 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "preamble.hpp"
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Tooling/Tooling.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <fstream>
+#include <unordered_map>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+    const char* whitespace = " \t\r\f\v";
+    auto begin = text.find_first_not_of(whitespace);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    auto end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+/// Records every file a PCH build reads, system headers included
+class input_collector : public clang::DependencyCollector {
+public:
+    bool needSystemDependencies() override { return true; }
+};
+
+/// Emits a PCH to a fixed path regardless of the -fsyntax-only tooling args
+class generate_pch_action : public clang::GeneratePCHAction {
+public:
+    generate_pch_action(std::string output, std::shared_ptr<input_collector> inputs)
+        : output_(std::move(output)), inputs_(std::move(inputs)) {}
+
+protected:
+    std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
+        clang::CompilerInstance& ci,
+        llvm::StringRef in_file
+    ) override {
+        ci.getFrontendOpts().OutputFile = output_;
+        inputs_->attachToPreprocessor(ci.getPreprocessor());
+        ci.addDependencyCollector(inputs_);
+        return GeneratePCHAction::CreateASTConsumer(ci, in_file);
+    }
+
+private:
+    std::string output_;
+    std::shared_ptr<input_collector> inputs_;
+};
+
+std::string preamble_key(const std::vector<std::string>& args, const std::vector<std::string>& headers) {
+    std::string key;
+    for (const auto& arg : args) {
+        key += arg;
+        key += '\0';
+    }
+    key += '\n';
+    for (const auto& header : headers) {
+        key += header;
+        key += '\0';
+    }
+    return key;
+}
+
+bool same_file(const llvm::vfs::Status& a, const llvm::vfs::Status& b) {
+    return a.getUniqueID() == b.getUniqueID() &&
+           a.getSize() == b.getSize() &&
+           a.getLastModificationTime() == b.getLastModificationTime();
+}
+
+// Whether every input still looks the way it did when the PCH was built
+bool up_to_date(const precompiled_header& pch, llvm::vfs::FileSystem& file_system) {
+    for (const auto& input : pch.inputs) {
+        auto status = file_system.status(input.path);
+        if (!status || !same_file(*status, input.status)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void remove_files(const precompiled_header& pch) {
+    boost::system::error_code ec;
+    fs::remove(pch.path, ec);
+    fs::remove(fs::path(pch.path).replace_extension(".hpp"), ec);
+}
+
+} // anonymous namespace
+
+include_prefix scan_include_prefix(std::string_view source) {
+    include_prefix result;
+    bool in_comment = false;  // Inside a /* */ comment spanning lines
+    std::size_t pos = 0;
+
+    while (pos < source.size()) {
+        std::size_t eol = source.find('\n', pos);
+        if (eol == std::string_view::npos) {
+            eol = source.size();
+        }
+        std::string_view line = source.substr(pos, eol - pos);
+        std::size_t line_start = pos;
+        pos = eol + 1;
+
+        // Line continuations are rare here and not worth handling
+        if (!trim(line).empty() && trim(line).back() == '\\') {
+            break;
+        }
+
+        // Skip comments, tracking where the remaining text starts
+        std::size_t offset = 0;
+        for (;;) {
+            if (in_comment) {
+                auto close = line.find("*/", offset);
+                if (close == std::string_view::npos) {
+                    offset = line.size();
+                    break;
+                }
+                in_comment = false;
+                offset = close + 2;
+            }
+            offset = std::min(line.size(), line.find_first_not_of(" \t\r\f\v", offset));
+            std::string_view rest = line.substr(offset);
+            if (starts_with(rest, "//")) {
+                offset = line.size();
+            } else if (starts_with(rest, "/*")) {
+                in_comment = true;
+                offset += 2;
+                continue;
+            }
+            break;
+        }
+
+        std::string_view rest = trim(line.substr(offset));
+        if (rest.empty()) {
+            continue;
+        }
+        if (rest.front() != '#') {
+            break;
+        }
+
+        std::string_view directive = trim(rest.substr(1));
+        if (directive == "pragma once" || starts_with(directive, "pragma once ")) {
+            continue;
+        }
+        if (!starts_with(directive, "include")) {
+            break;
+        }
+
+        std::string_view target = trim(directive.substr(7));
+        auto close = target.find('>');
+        if (target.empty() || target.front() != '<' || close == std::string_view::npos) {
+            break;
+        }
+        std::string_view tail = trim(target.substr(close + 1));
+        if (!tail.empty() && !starts_with(tail, "//")) {
+            break;
+        }
+
+        result.headers.emplace_back(target.substr(0, close + 1));
+        result.directives.emplace_back(line_start + line.find('#', offset), eol);
+    }
+
+    return result;
+}
+
+void blank_include_prefix(std::string& source, const include_prefix& prefix, std::size_t count) {
+    for (std::size_t i = 0; i < count && i < prefix.directives.size(); ++i) {
+        auto [begin, end] = prefix.directives[i];
+        for (std::size_t p = begin; p < end && p < source.size(); ++p) {
+            if (source[p] != '\r') {
+                source[p] = ' ';
+            }
+        }
+    }
+}
+
+preamble_plan plan_preambles(
+    const std::vector<std::string>& flag_keys,
+    const std::vector<include_prefix>& prefixes,
+    std::size_t min_shared
+) {
+    preamble_plan plan;
+    plan.assignment.resize(prefixes.size());
+    min_shared = std::max<std::size_t>(min_shared, 2);
+
+    // Key for the first `depth` headers of a TU, within its flag group
+    auto prefix_keys = [&](std::size_t tu) {
+        std::vector<std::string> keys;
+        std::string key = flag_keys[tu];
+        key += '\x1e';
+        for (const auto& header : prefixes[tu].headers) {
+            key += header;
+            key += '\n';
+            keys.push_back(key);
+        }
+        return keys;
+    };
+
+    std::unordered_map<std::string, std::size_t> counts;
+    for (std::size_t tu = 0; tu < prefixes.size(); ++tu) {
+        for (auto& key : prefix_keys(tu)) {
+            ++counts[key];
+        }
+    }
+
+    std::unordered_map<std::string, std::size_t> index;
+    for (std::size_t tu = 0; tu < prefixes.size(); ++tu) {
+        auto keys = prefix_keys(tu);
+        for (std::size_t depth = keys.size(); depth > 0; --depth) {
+            const auto& key = keys[depth - 1];
+            if (counts[key] < min_shared) {
+                continue;
+            }
+
+            auto [it, inserted] = index.emplace(key, plan.preambles.size());
+            if (inserted) {
+                preamble_plan::preamble preamble;
+                preamble.representative = tu;
+                preamble.headers.assign(
+                    prefixes[tu].headers.begin(),
+                    prefixes[tu].headers.begin() + static_cast<std::ptrdiff_t>(depth));
+                plan.preambles.push_back(std::move(preamble));
+            }
+            ++plan.preambles[it->second].users;
+            plan.assignment[tu] = it->second;
+            break;
+        }
+    }
+
+    // A prefix picked by only one TU (because the others went deeper)
+    // saves nothing
+    std::vector<std::optional<std::size_t>> renumber(plan.preambles.size());
+    std::vector<preamble_plan::preamble> kept;
+    for (std::size_t i = 0; i < plan.preambles.size(); ++i) {
+        if (plan.preambles[i].users >= 2) {
+            renumber[i] = kept.size();
+            kept.push_back(std::move(plan.preambles[i]));
+        }
+    }
+    for (auto& assigned : plan.assignment) {
+        if (assigned) {
+            assigned = renumber[*assigned];
+        }
+    }
+    plan.preambles = std::move(kept);
+
+    return plan;
+}
+
+preamble_set::preamble_set()
+    : directory_(fs::temp_directory_path() / fs::unique_path("safeprofile-pch-%%%%-%%%%-%%%%")) {}
+
+preamble_set::~preamble_set() {
+    boost::system::error_code ec;
+    fs::remove_all(directory_, ec);
+}
+
+void preamble_set::build(
+    const preamble_plan& plan,
+    const std::vector<std::vector<std::string>>& tu_args,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system,
+    std::size_t workers
+) {
+    // PCHs from earlier builds, by what they were built from
+    std::unordered_map<std::string, std::unique_ptr<precompiled_header>> previous;
+    for (auto& header : headers_) {
+        if (header) {
+            std::string key = header->key;
+            previous.emplace(std::move(key), std::move(header));
+        }
+    }
+
+    headers_.clear();
+    headers_.resize(plan.preambles.size());
+    reused_ = 0;
+
+    std::vector<std::size_t> to_build;
+    for (std::size_t i = 0; i < plan.preambles.size(); ++i) {
+        const auto& preamble = plan.preambles[i];
+        auto it = previous.find(preamble_key(tu_args[preamble.representative], preamble.headers));
+        if (it != previous.end() && up_to_date(*it->second, *file_system)) {
+            headers_[i] = std::move(it->second);
+            previous.erase(it);
+            ++reused_;
+        } else {
+            to_build.push_back(i);
+        }
+    }
+    for (const auto& stale : previous) {
+        remove_files(*stale.second);
+    }
+    if (to_build.empty()) {
+        return;
+    }
+
+    fs::create_directories(directory_);
+    const std::size_t first_id = next_id_;
+    next_id_ += to_build.size();
+
+    auto build_one = [&](std::size_t n) {
+        const std::size_t i = to_build[n];
+        const auto& preamble = plan.preambles[i];
+        auto stem = directory_ / ("prefix-" + std::to_string(first_id + n));
+        auto header_path = fs::path(stem).replace_extension(".hpp");
+        auto pch_path = fs::path(stem).replace_extension(".pch");
+
+        {
+            std::ofstream header(header_path.string());
+            for (const auto& include : preamble.headers) {
+                header << "#include " << include << "\n";
+            }
+            if (!header) {
+                return;
+            }
+        }
+
+        // The header is read from disk through the shared file system so the
+        // size and mtime recorded in the PCH match what TUs later validate
+        auto inputs = std::make_shared<input_collector>();
+        bool built = false;
+        try {
+            built = clang::tooling::runToolOnCodeWithArgs(
+                std::make_unique<generate_pch_action>(pch_path.string(), inputs),
+                "",
+                file_system,
+                tu_args[preamble.representative],
+                header_path.string()
+            );
+        } catch (const std::exception&) {
+            built = false;
+        }
+        if (!built) {
+            return;
+        }
+
+        auto data = llvm::MemoryBuffer::getFile(pch_path.string());
+        if (!data) {
+            return;
+        }
+
+        auto pch = std::make_unique<precompiled_header>();
+        pch->path = pch_path;
+        pch->headers = preamble.headers;
+        pch->data = std::move(*data);
+        pch->key = preamble_key(tu_args[preamble.representative], preamble.headers);
+        for (const auto& input : inputs->getDependencies()) {
+            if (auto status = file_system->status(input)) {
+                pch->inputs.push_back({input, *status});
+            }
+        }
+        headers_[i] = std::move(pch);  // Distinct slot per task
+    };
+
+    if (workers <= 1 || to_build.size() == 1) {
+        for (std::size_t n = 0; n < to_build.size(); ++n) {
+            build_one(n);
+        }
+        return;
+    }
+
+    boost::asio::thread_pool pool(std::min(workers, to_build.size()));
+    for (std::size_t n = 0; n < to_build.size(); ++n) {
+        boost::asio::post(pool, [&, n] { build_one(n); });
+    }
+    pool.join();
+}
+
+const precompiled_header* preamble_set::find(std::size_t preamble) const {
+    return preamble < headers_.size() ? headers_[preamble].get() : nullptr;
+}
+
+std::size_t preamble_set::size() const {
+    std::size_t count = 0;
+    for (const auto& header : headers_) {
+        if (header) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
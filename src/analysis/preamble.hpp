@@ -0,0 +1,120 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_PREAMBLE_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_PREAMBLE_HPP
+
+#include <boost/filesystem.hpp>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+/// The #include <...> directives at the very top of a source file
+/// Blank lines, comments and #pragma once may appear between them. The scan
+/// stops at the first other line; quoted includes also end it, since their
+/// meaning depends on the including file's directory.
+struct include_prefix {
+    std::vector<std::string> headers;  // e.g. "<boost/config.hpp>", in order
+    std::vector<std::pair<std::size_t, std::size_t>> directives;  // [begin, end) offsets
+};
+
+/// Scan the leading #include block of a source file
+include_prefix scan_include_prefix(std::string_view source);
+
+/// Overwrite the first `count` directives of a prefix with spaces
+/// Line and column positions of everything else are unchanged
+void blank_include_prefix(std::string& source, const include_prefix& prefix, std::size_t count);
+
+/// Which shared include prefix (if any) each translation unit uses
+struct preamble_plan {
+    struct preamble {
+        std::size_t representative = 0;    // A TU whose flags the PCH is built with
+        std::vector<std::string> headers;  // The shared prefix
+        std::size_t users = 0;             // TUs assigned to this preamble
+    };
+
+    std::vector<preamble> preambles;
+    std::vector<std::optional<std::size_t>> assignment;  // Per TU: index into preambles
+};
+
+/// Give each TU the longest include prefix it shares with at least
+/// `min_shared` TUs that have identical flags (flag_keys[i])
+preamble_plan plan_preambles(
+    const std::vector<std::string>& flag_keys,
+    const std::vector<include_prefix>& prefixes,
+    std::size_t min_shared = 2
+);
+
+/// A precompiled include prefix, held in memory
+struct precompiled_header {
+    /// A file the PCH was built from, as it was at build time
+    struct input {
+        std::string path;
+        llvm::vfs::Status status;
+    };
+
+    fs::path path;                               // Passed to -include-pch
+    std::vector<std::string> headers;            // The prefix it replaces
+    std::shared_ptr<llvm::MemoryBuffer> data;    // PCH contents
+    std::string key;                             // Compiler arguments + headers
+    std::vector<input> inputs;                   // Every file read while building
+};
+
+/// PCH files for analyze_files() runs
+/// Files live in a private temporary directory removed on destruction.
+/// A PCH built by an earlier build() is reused when a later plan asks for
+/// the same headers with the same arguments and none of its inputs has
+/// changed size, modification time or identity, so a long-lived detector
+/// keeps its preambles warm.
+class preamble_set {
+public:
+    preamble_set();
+    ~preamble_set();
+
+    preamble_set(const preamble_set&) = delete;
+    preamble_set& operator=(const preamble_set&) = delete;
+
+    /// Build one PCH per planned preamble, `workers` at a time
+    /// Each is compiled with its representative TU's arguments; a preamble
+    /// that fails to build is simply not used
+    void build(
+        const preamble_plan& plan,
+        const std::vector<std::vector<std::string>>& tu_args,
+        llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system,
+        std::size_t workers
+    );
+
+    /// PCH for a planned preamble, or nullptr if it was not built
+    const precompiled_header* find(std::size_t preamble) const;
+
+    /// Number of preambles available from the last build()
+    std::size_t size() const;
+
+    /// How many of those were reused from an earlier build()
+    std::size_t reused() const { return reused_; }
+
+private:
+    fs::path directory_;
+    std::vector<std::unique_ptr<precompiled_header>> headers_;  // index: preamble
+    std::size_t reused_ = 0;
+    std::size_t next_id_ = 0;  // File names are never reused within a set
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_PREAMBLE_HPP
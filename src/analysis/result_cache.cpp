@@ -0,0 +1,361 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "result_cache.hpp"
+#include "result_json.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/SHA1.h>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <unordered_set>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+constexpr std::size_t max_dependency_sets = 8;  // Per manifest, newest first
+constexpr std::size_t prefetch_threads = 8;     // Concurrent remote requests
+constexpr std::string_view root_placeholder = "${root}";
+
+std::string replace_all(std::string_view text, std::string_view from, std::string_view to) {
+    std::string out;
+    std::size_t pos = 0;
+    for (std::size_t hit; (hit = text.find(from, pos)) != std::string_view::npos; pos = hit + from.size()) {
+        out.append(text.substr(pos, hit - pos));
+        out.append(to);
+    }
+    out.append(text.substr(pos));
+    return out;
+}
+
+} // namespace
+
+struct hash_builder::impl {
+    llvm::SHA1 sha1;
+};
+
+hash_builder::hash_builder() : impl_(std::make_unique<impl>()) {}
+
+hash_builder::~hash_builder() = default;
+
+hash_builder& hash_builder::add(std::string_view field) {
+    impl_->sha1.update(std::to_string(field.size()) + ":");
+    impl_->sha1.update(llvm::StringRef(field.data(), field.size()));
+    return *this;
+}
+
+std::string hash_builder::hex() {
+    return llvm::toHex(impl_->sha1.final(), /*LowerCase=*/true);
+}
+
+result_cache::result_cache(fs::path directory)
+    : local_(std::make_shared<directory_backend>(std::move(directory))) {}
+
+result_cache::result_cache(std::shared_ptr<cache_backend> local, std::shared_ptr<cache_backend> remote)
+    : local_(std::move(local)), remote_(std::move(remote)) {}
+
+result_cache::~result_cache() {
+    // Queued prefetches are abandoned; running ones end at their deadline
+    if (prefetch_pool_) {
+        prefetch_pool_->stop();
+        prefetch_pool_->join();
+    }
+}
+
+void result_cache::set_base_directory(const fs::path& base) {
+    base_ = fs::absolute(base).lexically_normal().generic_string();
+    while (base_.size() > 1 && base_.back() == '/') {
+        base_.pop_back();
+    }
+}
+
+std::string result_cache::portable(std::string_view text) const {
+    if (base_.empty()) {
+        return std::string(text);
+    }
+
+    // Only whole path prefixes: "/src/app" must not rewrite "/src/application"
+    std::string out;
+    std::size_t pos = 0;
+    for (std::size_t hit; (hit = text.find(base_, pos)) != std::string_view::npos; ) {
+        std::size_t end = hit + base_.size();
+        out.append(text.substr(pos, hit - pos));
+        if (end == text.size() || text[end] == '/') {
+            out.append(root_placeholder);
+        } else {
+            out.append(base_);
+        }
+        pos = end;
+    }
+    out.append(text.substr(pos));
+    return out;
+}
+
+std::string result_cache::restore(std::string_view text) const {
+    if (base_.empty()) {
+        return std::string(text);
+    }
+    return replace_all(text, root_placeholder, base_);
+}
+
+std::string result_cache::result_key(
+    const std::string& key,
+    const std::vector<std::string>& dependencies,
+    caching_file_system& files
+) const {
+    hash_builder hash;
+    hash.add(key);
+    for (const auto& dependency : dependencies) {
+        hash.add(dependency);
+        hash.add(files.content_hash(restore(dependency)).value_or("<missing>"));
+    }
+    return hash.hex();
+}
+
+void result_cache::prefetch(
+    const std::vector<std::string>& keys,
+    llvm::IntrusiveRefCntPtr<caching_file_system> files
+) {
+    if (!remote_ || keys.empty()) {
+        return;  // Local lookups are as cheap inline as in the background
+    }
+    if (!prefetch_pool_) {
+        prefetch_pool_ = std::make_unique<boost::asio::thread_pool>(prefetch_threads);
+    }
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    for (const auto& key : keys) {
+        if (key.empty() || pending_.count(key)) {
+            continue;
+        }
+
+        auto pending = std::make_shared<pending_lookup>();
+        pending->future = pending->promise.get_future().share();
+        pending_.emplace(key, pending);
+
+        boost::asio::post(*prefetch_pool_, [this, key, pending, files] {
+            if (pending->claimed.exchange(true)) {
+                return;  // A worker got there first and looked it up inline
+            }
+            try {
+                pending->promise.set_value(fetch(key, *files));
+            } catch (...) {
+                pending->promise.set_value(std::nullopt);
+            }
+        });
+    }
+}
+
+std::optional<cached_result> result_cache::lookup(
+    const std::string& key,
+    caching_file_system& files,
+    const std::function<bool(const fs::path&)>& is_project_header
+) {
+    std::shared_ptr<pending_lookup> pending;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        auto it = pending_.find(key);
+        if (it != pending_.end()) {
+            pending = it->second;
+            pending_.erase(it);
+        }
+    }
+
+    std::optional<found_entry> found;
+    if (pending && pending->claimed.exchange(true)) {
+        // In flight: wait a bounded time, then fall back to local analysis
+        auto wait = std::chrono::duration<double>(prefetch_wait_seconds_);
+        if (pending->future.wait_for(wait) == std::future_status::ready) {
+            found = pending->future.get();
+        } else {
+            ++late_prefetches_;
+        }
+    } else {
+        found = fetch(key, files);
+    }
+
+    if (found && is_project_header) {
+        std::unordered_set<std::string> attributed;
+        for (const auto& path : found->entry.attributed) {
+            attributed.insert(path.string());
+        }
+        for (const auto& dependency : found->dependencies) {
+            if (is_project_header(dependency) != (attributed.count(dependency) != 0)) {
+                found.reset();
+                break;
+            }
+        }
+    }
+
+    ++(found ? hits_ : misses_);
+    if (!found) {
+        return std::nullopt;
+    }
+    return std::move(found->entry);
+}
+
+std::optional<result_cache::found_entry> result_cache::fetch(
+    const std::string& key,
+    caching_file_system& files
+) {
+    auto entry = [&](const fetched& found) {
+        found_entry result{decode(found.blob), {}};
+        for (const auto& dependency : found.dependencies) {
+            result.dependencies.push_back(restore(dependency));
+        }
+        return result;
+    };
+
+    try {
+        if (auto found = fetch_from(*local_, key, files)) {
+            return entry(*found);
+        }
+
+        if (remote_) {
+            if (auto found = fetch_from(*remote_, key, files)) {
+                // Keep a local copy so the next run does not ask again
+                local_->put(found->result_key, found->blob);
+                std::lock_guard<std::mutex> lock(manifest_mutex_);
+                store_manifest(*local_, key, found->dependencies);
+                return entry(*found);
+            }
+        }
+    } catch (const std::exception&) {
+        // A corrupt entry is just a miss; the next store replaces it
+    }
+    return std::nullopt;
+}
+
+std::optional<result_cache::fetched> result_cache::fetch_from(
+    cache_backend& backend,
+    const std::string& key,
+    caching_file_system& files
+) {
+    auto manifest = backend.get(key);
+    if (!manifest) {
+        return std::nullopt;
+    }
+
+    json::value doc = json::parse(*manifest);
+    for (const auto& set : doc.as_object().at("dependencies").as_array()) {
+        fetched found;
+        for (const auto& path : set.as_array()) {
+            found.dependencies.emplace_back(path.as_string().c_str());
+        }
+
+        found.result_key = result_key(key, found.dependencies, files);
+        if (auto blob = backend.get(found.result_key)) {
+            found.blob = std::move(*blob);
+            return found;
+        }
+    }
+    return std::nullopt;
+}
+
+cached_result result_cache::decode(const std::string& blob) const {
+    json::value value = json::parse(blob);
+
+    cached_result entry;
+    entry.result = result_from_json(value.as_object().at("result"));
+    entry.result.file = restore(entry.result.file.string());
+    entry.result.error_message = restore(entry.result.error_message);
+    for (auto& finding : entry.result.findings) {
+        finding.file = restore(finding.file.string());
+    }
+    for (const auto& path : value.as_object().at("included").as_array()) {
+        entry.included.emplace_back(restore(path.as_string().c_str()));
+    }
+    for (const auto& path : value.as_object().at("attributed").as_array()) {
+        entry.attributed.emplace_back(restore(path.as_string().c_str()));
+    }
+    return entry;
+}
+
+void result_cache::store(
+    const std::string& key,
+    const std::vector<std::string>& dependencies,
+    const cached_result& entry,
+    caching_file_system& files
+) {
+    std::vector<std::string> portable_dependencies;
+    portable_dependencies.reserve(dependencies.size());
+    for (const auto& dependency : dependencies) {
+        portable_dependencies.push_back(portable(dependency));
+    }
+
+    file_analysis_result result = entry.result;
+    result.file = portable(result.file.string());
+    result.error_message = portable(result.error_message);
+    for (auto& finding : result.findings) {
+        finding.file = portable(finding.file.string());
+    }
+    json::array included;
+    for (const auto& path : entry.included) {
+        included.emplace_back(portable(path.string()));
+    }
+
+    json::array attributed;
+    for (const auto& path : entry.attributed) {
+        attributed.emplace_back(portable(path.string()));
+    }
+
+    json::object value;
+    value["result"] = to_json(result);
+    value["included"] = std::move(included);
+    value["attributed"] = std::move(attributed);
+    const std::string blob = json::serialize(value);
+    const std::string blob_key = result_key(key, portable_dependencies, files);
+
+    local_->put(blob_key, blob);
+    if (remote_) {
+        remote_->put(blob_key, blob);
+    }
+
+    // Result blobs first: a manifest never points at a missing result
+    std::lock_guard<std::mutex> lock(manifest_mutex_);
+    store_manifest(*local_, key, portable_dependencies);
+    if (remote_) {
+        store_manifest(*remote_, key, portable_dependencies);
+    }
+}
+
+void result_cache::store_manifest(
+    cache_backend& backend,
+    const std::string& key,
+    const std::vector<std::string>& dependencies
+) {
+    // Put this dependency set first in the manifest
+    json::array sets;
+    json::array current;
+    for (const auto& dependency : dependencies) {
+        current.emplace_back(dependency);
+    }
+    sets.push_back(current);
+
+    if (auto manifest = backend.get(key)) {
+        try {
+            json::value doc = json::parse(*manifest);
+            for (const auto& set : doc.as_object().at("dependencies").as_array()) {
+                if (sets.size() < max_dependency_sets && set != json::value(current)) {
+                    sets.push_back(set);
+                }
+            }
+        } catch (const std::exception&) {
+            // Replace a corrupt manifest
+        }
+    }
+
+    json::object doc;
+    doc["version"] = 1;
+    doc["dependencies"] = std::move(sets);
+    backend.put(key, json::serialize(doc));
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
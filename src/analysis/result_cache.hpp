@@ -0,0 +1,180 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_RESULT_CACHE_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_RESULT_CACHE_HPP
+
+#include "analysis/ast_detector.hpp"
+#include "analysis/cache_backend.hpp"
+#include "analysis/file_cache.hpp"
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace asio {
+class thread_pool;
+} // namespace asio
+
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+/// Incremental SHA-1 over a sequence of fields, as lowercase hex
+/// Fields are length-prefixed so ("ab","c") and ("a","bc") differ
+class hash_builder {
+public:
+    hash_builder();
+    ~hash_builder();
+
+    hash_builder& add(std::string_view field);
+    std::string hex();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+/// A cached per-TU outcome
+struct cached_result {
+    file_analysis_result result;
+    std::vector<fs::path> included;    // Project headers the TU entered
+    std::vector<fs::path> attributed;  // Files it read that were project headers
+};
+
+/// Persistent, content-addressed cache of per-TU analysis results
+/// Works in two levels, like a compiler cache's direct mode:
+///  - a manifest, keyed by everything known before parsing (main file
+///    contents, compiler arguments, rules, tool version), lists the
+///    dependency sets earlier runs recorded under that key
+///  - a result, keyed by the manifest key plus the current content hash of
+///    every file in one of those sets
+/// A TU hits when one of its recorded dependency sets still hashes to a
+/// stored result, so an edit to any transitively included file misses.
+///
+/// Blobs live in a local backend and, optionally, a shared remote one.
+/// Lookups try the local store first; remote hits are copied locally and
+/// stores go to both. Paths under the base directory are recorded
+/// relative to it, so checkouts at different locations share entries.
+class result_cache {
+public:
+    /// Local cache directory only
+    explicit result_cache(fs::path directory);
+
+    /// `remote` may be null
+    result_cache(std::shared_ptr<cache_backend> local, std::shared_ptr<cache_backend> remote);
+
+    ~result_cache();
+
+    /// Record paths under `base` relative to it (default: absolute paths)
+    void set_base_directory(const fs::path& base);
+
+    /// Longest a lookup waits for a prefetch still in flight (default: 2s)
+    /// Past that the TU is analyzed locally instead
+    void set_prefetch_wait(double seconds) { prefetch_wait_seconds_ = seconds; }
+
+    /// Text with the base directory replaced by a placeholder, for keys
+    std::string portable(std::string_view text) const;
+
+    /// Start looking up keys in the background
+    /// A later lookup() of a prefetched key uses the answer if it has
+    /// arrived; lookups of keys no prefetch has started yet run inline.
+    void prefetch(
+        const std::vector<std::string>& keys,
+        llvm::IntrusiveRefCntPtr<caching_file_system> files
+    );
+
+    /// Cached result for a TU key, if its dependencies are unchanged
+    /// With `is_project_header`, an entry also misses when a file the TU
+    /// read has become or stopped being a project header since it was
+    /// stored, since that decides which file a finding is attributed to
+    std::optional<cached_result> lookup(
+        const std::string& key,
+        caching_file_system& files,
+        const std::function<bool(const fs::path&)>& is_project_header = nullptr
+    );
+
+    /// Record a TU's result and the files it read
+    void store(
+        const std::string& key,
+        const std::vector<std::string>& dependencies,
+        const cached_result& entry,
+        caching_file_system& files
+    );
+
+    std::size_t hits() const { return hits_.load(); }
+    std::size_t misses() const { return misses_.load(); }
+
+    /// Lookups that gave up waiting for a prefetch
+    std::size_t late_prefetches() const { return late_prefetches_.load(); }
+
+private:
+    /// A fetched entry and the dependency set it was found through
+    struct found_entry {
+        cached_result entry;
+        std::vector<std::string> dependencies;  // Absolute paths
+    };
+
+    struct pending_lookup {
+        std::atomic<bool> claimed{false};
+        std::promise<std::optional<found_entry>> promise;
+        std::shared_future<std::optional<found_entry>> future;
+    };
+
+    /// A result blob found through one backend's manifest
+    struct fetched {
+        std::vector<std::string> dependencies;  // Portable paths
+        std::string result_key;
+        std::string blob;
+    };
+
+    std::optional<found_entry> fetch(const std::string& key, caching_file_system& files);
+    std::optional<fetched> fetch_from(cache_backend& backend, const std::string& key, caching_file_system& files);
+    cached_result decode(const std::string& blob) const;
+    void store_manifest(
+        cache_backend& backend,
+        const std::string& key,
+        const std::vector<std::string>& dependencies
+    );
+
+    /// Key of the result for one dependency set, from current file contents
+    std::string result_key(
+        const std::string& key,
+        const std::vector<std::string>& dependencies,
+        caching_file_system& files
+    ) const;
+
+    /// Inverse of portable()
+    std::string restore(std::string_view text) const;
+
+    std::shared_ptr<cache_backend> local_;
+    std::shared_ptr<cache_backend> remote_;
+    std::string base_;  // Generic form without trailing '/', or empty
+    double prefetch_wait_seconds_ = 2.0;
+
+    std::mutex manifest_mutex_;  // Serializes manifest updates within a run
+    std::mutex pending_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<pending_lookup>> pending_;
+    std::unique_ptr<boost::asio::thread_pool> prefetch_pool_;
+
+    std::atomic<std::size_t> hits_{0};
+    std::atomic<std::size_t> misses_{0};
+    std::atomic<std::size_t> late_prefetches_{0};
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_RESULT_CACHE_HPP
@@ -0,0 +1,175 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "result_json.hpp"
+#include <stdexcept>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace {
+
+const char* severity_name(profile::severity sev) {
+    switch (sev) {
+        case profile::severity::blocker: return "blocker";
+        case profile::severity::major:   return "major";
+        case profile::severity::minor:   return "minor";
+        case profile::severity::info:    return "info";
+    }
+    return "major";
+}
+
+profile::severity severity_from_name(json::string_view name) {
+    if (name == "blocker") return profile::severity::blocker;
+    if (name == "major")   return profile::severity::major;
+    if (name == "minor")   return profile::severity::minor;
+    if (name == "info")    return profile::severity::info;
+    throw std::runtime_error("Unknown severity in analysis result");
+}
+
+const char* failure_name(failure_kind kind) {
+    switch (kind) {
+        case failure_kind::none:              return "none";
+        case failure_kind::compilation_error: return "compilation_error";
+        case failure_kind::crashed:           return "crashed";
+        case failure_kind::out_of_memory:     return "out_of_memory";
+        case failure_kind::limit_exceeded:    return "limit_exceeded";
+        case failure_kind::internal_error:    return "internal_error";
+    }
+    return "internal_error";
+}
+
+failure_kind failure_from_name(json::string_view name) {
+    if (name == "none")              return failure_kind::none;
+    if (name == "compilation_error") return failure_kind::compilation_error;
+    if (name == "crashed")           return failure_kind::crashed;
+    if (name == "out_of_memory")     return failure_kind::out_of_memory;
+    if (name == "limit_exceeded")    return failure_kind::limit_exceeded;
+    if (name == "internal_error")    return failure_kind::internal_error;
+    throw std::runtime_error("Unknown failure kind in analysis result");
+}
+
+std::string string_at(const json::object& obj, json::string_view key) {
+    return std::string(obj.at(key).as_string().c_str());
+}
+
+} // namespace
+
+json::object to_json(const ast_finding& finding) {
+    json::object obj;
+    obj["file"] = finding.file.string();
+    obj["line"] = finding.line;
+    obj["column"] = finding.column;
+    obj["message"] = finding.message;
+    obj["rule_id"] = finding.rule_id;
+    obj["severity"] = severity_name(finding.severity);
+    obj["snippet"] = finding.snippet;
+    return obj;
+}
+
+ast_finding finding_from_json(const json::value& value) {
+    const auto& obj = value.as_object();
+
+    ast_finding finding;
+    finding.file = string_at(obj, "file");
+    finding.line = obj.at("line").to_number<unsigned int>();
+    finding.column = obj.at("column").to_number<unsigned int>();
+    finding.message = string_at(obj, "message");
+    finding.rule_id = string_at(obj, "rule_id");
+    finding.severity = severity_from_name(obj.at("severity").as_string());
+    finding.snippet = string_at(obj, "snippet");
+    return finding;
+}
+
+json::object to_json(const file_analysis_result& result) {
+    json::array findings;
+    for (const auto& finding : result.findings) {
+        findings.push_back(to_json(finding));
+    }
+
+    json::object obj;
+    obj["file"] = result.file.string();
+    obj["success"] = result.success;
+    obj["failure"] = failure_name(result.failure);
+    obj["error_message"] = result.error_message;
+    obj["findings"] = std::move(findings);
+    obj["parse_seconds"] = result.timing.parse_seconds;
+    obj["match_seconds"] = result.timing.match_seconds;
+    return obj;
+}
+
+file_analysis_result result_from_json(const json::value& value) {
+    const auto& obj = value.as_object();
+
+    file_analysis_result result;
+    result.file = string_at(obj, "file");
+    result.success = obj.at("success").as_bool();
+    result.failure = failure_from_name(obj.at("failure").as_string());
+    result.error_message = string_at(obj, "error_message");
+    for (const auto& finding : obj.at("findings").as_array()) {
+        result.findings.push_back(finding_from_json(finding));
+    }
+    result.timing.parse_seconds = obj.at("parse_seconds").to_number<double>();
+    result.timing.match_seconds = obj.at("match_seconds").to_number<double>();
+    return result;
+}
+
+json::object to_json(const analysis_statistics& stats) {
+    json::object obj;
+    obj["translation_units"] = stats.translation_units;
+    obj["workers"] = stats.workers;
+    obj["steals"] = stats.steals;
+    obj["wall_seconds"] = stats.wall_seconds;
+    obj["busy_seconds"] = stats.busy_seconds;
+    obj["parse_seconds"] = stats.parse_seconds;
+    obj["match_seconds"] = stats.match_seconds;
+    obj["file_cache_lookups"] = stats.file_cache.lookups;
+    obj["file_cache_hits"] = stats.file_cache.hits;
+    obj["preambles"] = stats.preambles;
+    obj["preamble_tus"] = stats.preamble_tus;
+    obj["preambles_reused"] = stats.preambles_reused;
+    obj["umbrella_headers"] = stats.umbrella_headers;
+    obj["covered_headers"] = stats.covered_headers;
+    obj["duplicate_findings"] = stats.duplicate_findings;
+    obj["cache_hits"] = stats.cache_hits;
+    obj["cache_misses"] = stats.cache_misses;
+    obj["lexically_skipped"] = stats.lexically_skipped;
+    obj["invocation_templates"] = stats.invocation_templates;
+    obj["invocations_reused"] = stats.invocations_reused;
+    return obj;
+}
+
+analysis_statistics statistics_from_json(const json::value& value) {
+    const auto& obj = value.as_object();
+    auto count = [&](json::string_view key) { return obj.at(key).to_number<std::size_t>(); };
+
+    analysis_statistics stats;
+    stats.translation_units = count("translation_units");
+    stats.workers = count("workers");
+    stats.steals = count("steals");
+    stats.wall_seconds = obj.at("wall_seconds").to_number<double>();
+    stats.busy_seconds = obj.at("busy_seconds").to_number<double>();
+    stats.parse_seconds = obj.at("parse_seconds").to_number<double>();
+    stats.match_seconds = obj.at("match_seconds").to_number<double>();
+    stats.file_cache.lookups = count("file_cache_lookups");
+    stats.file_cache.hits = count("file_cache_hits");
+    stats.preambles = count("preambles");
+    stats.preamble_tus = count("preamble_tus");
+    stats.preambles_reused = count("preambles_reused");
+    stats.umbrella_headers = count("umbrella_headers");
+    stats.covered_headers = count("covered_headers");
+    stats.duplicate_findings = count("duplicate_findings");
+    stats.cache_hits = count("cache_hits");
+    stats.cache_misses = count("cache_misses");
+    stats.lexically_skipped = count("lexically_skipped");
+    stats.invocation_templates = count("invocation_templates");
+    stats.invocations_reused = count("invocations_reused");
+    return stats;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,35 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_RESULT_JSON_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_RESULT_JSON_HPP
+
+#include "analysis/ast_detector.hpp"
+#include <boost/json.hpp>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace json = boost::json;
+
+/// JSON encoding of analysis results
+/// Used to move results across process boundaries (isolated workers)
+/// and to persist them; decoding throws std::exception on malformed input
+
+json::object to_json(const ast_finding& finding);
+ast_finding finding_from_json(const json::value& value);
+
+json::object to_json(const file_analysis_result& result);
+file_analysis_result result_from_json(const json::value& value);
+
+json::object to_json(const analysis_statistics& stats);
+analysis_statistics statistics_from_json(const json::value& value);
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_RESULT_JSON_HPP
@@ -0,0 +1,268 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "scheduler.hpp"
+#include <boost/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace json = boost::json;
+
+namespace {
+
+// An #include typically drags in far more text than the line itself;
+// weigh each one like this many bytes of main-file source
+constexpr double include_weight_bytes = 16.0 * 1024.0;
+
+std::string history_key(const fs::path& source_file) {
+    return fs::absolute(source_file).lexically_normal().string();
+}
+
+// Cheap, history-free cost estimate in arbitrary units
+double heuristic_cost(const fs::path& file) {
+    std::ifstream ifs(file.string());
+    if (!ifs) {
+        return 0.0;
+    }
+
+    double bytes = 0.0;
+    double includes = 0.0;
+    std::string line;
+
+    while (std::getline(ifs, line)) {
+        bytes += static_cast<double>(line.size() + 1);
+
+        auto first = line.find_first_not_of(" \t");
+        if (first != std::string::npos && line[first] == '#' &&
+            line.find("include", first) != std::string::npos) {
+            includes += 1.0;
+        }
+    }
+
+    return bytes + includes * include_weight_bytes;
+}
+
+} // namespace
+
+bool cost_history::load(const fs::path& file) {
+    timings_.clear();
+
+    std::ifstream ifs(file.string());
+    if (!ifs) {
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+
+    try {
+        json::value doc = json::parse(buffer.str());
+        const auto& files = doc.as_object().at("files").as_object();
+
+        for (const auto& entry : files) {
+            const auto& obj = entry.value().as_object();
+            tu_timing timing;
+            timing.parse_seconds = obj.at("parse_seconds").to_number<double>();
+            timing.match_seconds = obj.at("match_seconds").to_number<double>();
+            timings_[std::string(entry.key())] = timing;
+        }
+    } catch (const std::exception&) {
+        // Stale or corrupt history only costs scheduling quality
+        timings_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void cost_history::save(const fs::path& file) const {
+    json::object files;
+    for (const auto& [path, timing] : timings_) {
+        files[path] = json::object{
+            {"parse_seconds", timing.parse_seconds},
+            {"match_seconds", timing.match_seconds}
+        };
+    }
+
+    json::object doc;
+    doc["version"] = 1;
+    doc["files"] = std::move(files);
+
+    if (file.has_parent_path()) {
+        fs::create_directories(file.parent_path());
+    }
+
+    std::ofstream ofs(file.string());
+    if (!ofs) {
+        throw std::runtime_error("Failed to write cost history: " + file.string());
+    }
+    ofs << json::serialize(doc);
+}
+
+std::optional<tu_timing> cost_history::lookup(const fs::path& source_file) const {
+    auto it = timings_.find(history_key(source_file));
+    if (it == timings_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void cost_history::record(const fs::path& source_file, const tu_timing& timing) {
+    timings_[history_key(source_file)] = timing;
+}
+
+std::vector<double> estimate_costs(
+    const std::vector<fs::path>& files,
+    const cost_history* history
+) {
+    std::vector<double> costs(files.size(), 0.0);
+    std::vector<bool> known(files.size(), false);
+
+    // Only files without a recorded timing are read for the heuristic;
+    // it is calibrated by assuming they cost as much on average as the
+    // files that do have one
+    double known_seconds = 0.0;
+    double unknown_heuristic = 0.0;
+    std::size_t known_count = 0;
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (history) {
+            if (auto timing = history->lookup(files[i])) {
+                costs[i] = timing->total();
+                known[i] = true;
+                known_seconds += costs[i];
+                ++known_count;
+                continue;
+            }
+        }
+        costs[i] = heuristic_cost(files[i]);
+        unknown_heuristic += costs[i];
+    }
+
+    const std::size_t unknown_count = files.size() - known_count;
+    const double scale = (known_seconds > 0.0 && unknown_heuristic > 0.0)
+        ? (known_seconds / static_cast<double>(known_count)) /
+          (unknown_heuristic / static_cast<double>(unknown_count))
+        : 1.0;
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (!known[i]) {
+            costs[i] *= scale;
+        }
+    }
+
+    return costs;
+}
+
+work_queue::work_queue(const std::vector<double>& costs, std::size_t workers) {
+    workers = std::max<std::size_t>(workers, 1);
+    for (std::size_t w = 0; w < workers; ++w) {
+        lanes_.push_back(std::make_unique<lane>());
+    }
+
+    // Longest processing time first; ties keep discovery order
+    std::vector<std::size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return costs[a] > costs[b]; });
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        lanes_[i % workers]->items.push_back(order[i]);
+    }
+}
+
+work_queue::work_queue(const std::vector<double>& costs, const std::vector<std::size_t>& groups,
+                       std::size_t workers) {
+    workers = std::max<std::size_t>(workers, 1);
+    for (std::size_t w = 0; w < workers; ++w) {
+        lanes_.push_back(std::make_unique<lane>());
+    }
+
+    // Groups in order of first appearance, members longest first
+    std::vector<std::vector<std::size_t>> members;
+    std::unordered_map<std::size_t, std::size_t> position;
+    for (std::size_t i = 0; i < costs.size(); ++i) {
+        auto it = position.emplace(groups[i], members.size()).first;
+        if (it->second == members.size()) {
+            members.emplace_back();
+        }
+        members[it->second].push_back(i);
+    }
+
+    const double share = std::accumulate(costs.begin(), costs.end(), 0.0) / static_cast<double>(workers);
+    struct run {
+        double cost = 0.0;
+        std::vector<std::size_t> items;
+    };
+    std::vector<run> runs;
+    for (auto& group : members) {
+        std::stable_sort(group.begin(), group.end(),
+                         [&](std::size_t a, std::size_t b) { return costs[a] > costs[b]; });
+        run current;
+        for (auto item : group) {
+            if (!current.items.empty() && current.cost + costs[item] > share) {
+                runs.push_back(std::move(current));
+                current = run{};
+            }
+            current.cost += costs[item];
+            current.items.push_back(item);
+        }
+        runs.push_back(std::move(current));
+    }
+
+    std::stable_sort(runs.begin(), runs.end(),
+                     [](const run& a, const run& b) { return a.cost > b.cost; });
+
+    std::vector<double> load(workers, 0.0);
+    for (const auto& r : runs) {
+        std::size_t least = 0;
+        for (std::size_t w = 1; w < workers; ++w) {
+            if (std::make_pair(load[w], lanes_[w]->items.size()) <
+                std::make_pair(load[least], lanes_[least]->items.size())) {
+                least = w;
+            }
+        }
+        load[least] += r.cost;
+        lanes_[least]->items.insert(lanes_[least]->items.end(), r.items.begin(), r.items.end());
+    }
+}
+
+std::optional<std::size_t> work_queue::next(std::size_t worker) {
+    const std::size_t count = lanes_.size();
+
+    {
+        auto& own = *lanes_[worker % count];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            std::size_t item = own.items.front();
+            own.items.pop_front();
+            return item;
+        }
+    }
+
+    // Own deque drained: steal the cheapest remaining item from a peer
+    for (std::size_t offset = 1; offset < count; ++offset) {
+        auto& victim = *lanes_[(worker + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            std::size_t item = victim.items.back();
+            victim.items.pop_back();
+            steals_.fetch_add(1);
+            return item;
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,102 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_ANALYSIS_SCHEDULER_HPP
+#define BOOST_SAFEPROFILE_ANALYSIS_SCHEDULER_HPP
+
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace analysis {
+
+namespace fs = boost::filesystem;
+
+/// Time spent on one translation unit
+struct tu_timing {
+    double parse_seconds = 0.0;  // Preprocessing, parsing and semantic analysis
+    double match_seconds = 0.0;  // AST matching
+
+    double total() const { return parse_seconds + match_seconds; }
+};
+
+/// Per-file timings from earlier runs, persisted as JSON
+/// Used to schedule the most expensive translation units first
+class cost_history {
+public:
+    /// Load timings from a file written by save()
+    /// Returns false (and leaves the history empty) if missing or invalid
+    bool load(const fs::path& file);
+
+    /// Write timings to a file (creating parent directories)
+    void save(const fs::path& file) const;
+
+    /// Timing recorded for a source file, if any
+    std::optional<tu_timing> lookup(const fs::path& source_file) const;
+
+    /// Record (or replace) the timing for a source file
+    void record(const fs::path& source_file, const tu_timing& timing);
+
+    /// Number of files with a recorded timing
+    std::size_t size() const { return timings_.size(); }
+
+private:
+    std::unordered_map<std::string, tu_timing> timings_;  // key: absolute path
+};
+
+/// Estimate the analysis cost (in seconds) of each file
+/// Files with history use their recorded time; others fall back to a
+/// size/include-count heuristic, scaled so that their mean matches the
+/// mean recorded time; files with history are not read
+std::vector<double> estimate_costs(
+    const std::vector<fs::path>& files,
+    const cost_history* history
+);
+
+/// Longest-first work queue with stealing
+/// Files are sorted by descending cost and dealt round-robin to workers;
+/// each worker takes from the front of its own deque and, once empty,
+/// steals from the back (cheapest end) of the next non-empty deque
+class work_queue {
+public:
+    work_queue(const std::vector<double>& costs, std::size_t workers);
+
+    /// Same, keeping the items of a group together
+    /// Items with equal groups[i] are cut into runs of at most one worker's
+    /// fair share of the total cost (longest item first within a run); runs
+    /// are dealt longest-first to the least loaded lane, so each worker goes
+    /// through a group back-to-back
+    work_queue(const std::vector<double>& costs, const std::vector<std::size_t>& groups,
+               std::size_t workers);
+
+    /// Next file index for a worker, or nullopt when all work is claimed
+    std::optional<std::size_t> next(std::size_t worker);
+
+    /// Number of items taken from another worker's deque
+    std::size_t steals() const { return steals_.load(); }
+
+private:
+    struct lane {
+        std::mutex mutex;
+        std::deque<std::size_t> items;
+    };
+
+    std::vector<std::unique_ptr<lane>> lanes_;
+    std::atomic<std::size_t> steals_{0};
+};
+
+} // namespace analysis
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_ANALYSIS_SCHEDULER_HPP
@@ -33,6 +33,67 @@ std::optional<analyze_args> parse_arguments(int argc, char* argv[]) {
             ("offline", po::bool_switch()->default_value(true),
              "Run in offline mode (no network access)")
             ("online", "Enable online mode (for AI assistance)")
+            ("jobs,j", po::value<unsigned int>()->default_value(0),
+             "Number of translation units to analyze in parallel (0 = hardware concurrency)")
+            ("cost-history", po::value<std::string>(),
+             "Per-file timing history used to schedule expensive files first (read and updated)")
+            ("cache-dir", po::value<std::string>(),
+             "Reuse results for unchanged files from this directory (read and updated)")
+            ("remote-cache", po::value<std::string>(),
+             "Share results through an HTTP cache at this URL (requires --cache-dir and --online)")
+            ("remote-cache-timeout", po::value<double>()->default_value(2.0),
+             "Seconds to wait for the remote cache before analyzing locally")
+            ("since", po::value<std::string>(),
+             "Analyze only files changed since this git revision and files that include them")
+            ("watch", po::bool_switch()->default_value(false),
+             "Keep running and report new and resolved findings as files change")
+            ("debounce", po::value<unsigned int>()->default_value(200),
+             "Milliseconds without further changes before --watch re-analyzes")
+            ("isolate", po::bool_switch()->default_value(false),
+             "Analyze each file in a separate worker process (contains crashes)")
+            ("memory-limit", po::value<std::size_t>()->default_value(0),
+             "Memory an isolated worker may add in MB (0 = unlimited; requires --isolate)")
+            ("no-pch", po::bool_switch()->default_value(false),
+             "Do not precompile #include prefixes shared by several files")
+            ("umbrella", po::bool_switch()->default_value(false),
+             "Parse all headers as one translation unit (header-only libraries)")
+            ("no-header-dedup", po::bool_switch()->default_value(false),
+             "Parse every header on its own, even when a source file includes it")
+            ("no-traversal-scope", po::bool_switch()->default_value(false),
+             "Walk every declaration when matching, including those from included headers")
+            ("match-instantiations", po::bool_switch()->default_value(false),
+             "Also match inside template instantiations and compiler-generated code")
+            ("fast-parse", po::bool_switch()->default_value(false),
+             "Skip parsing function bodies in included headers (errors in them go unnoticed)")
+            ("no-invocation-reuse", po::bool_switch()->default_value(false),
+             "Run the compiler driver for every file, even when files share their arguments")
+            ("clang-tool", po::bool_switch()->default_value(false),
+             "Compile files in batches with their full compile_commands.json command lines")
+            ("prefilter", po::value<std::string>()->default_value("prune"),
+             "Lexical scan before parsing: off, prune (only run rules whose tokens appear), "
+             "or skip (also skip parsing files where no rule can fire; their errors go unnoticed)")
+        ;
+
+        po::options_description server("Server Options");
+        server.add_options()
+            ("serve", po::value<std::string>(),
+             "Stay resident with warm caches, answering analysis requests on this Unix socket")
+            ("connect", po::value<std::string>(),
+             "Have the daemon listening on this Unix socket run the analysis")
+            ("lsp", po::bool_switch()->default_value(false),
+             "Speak the Language Server Protocol on stdin/stdout, checking open editor buffers")
+        ;
+
+        po::options_description limits("Limit Options");
+        limits.add_options()
+            ("tu-timeout", po::value<double>()->default_value(300.0),
+             "Wall-clock budget per file in seconds (0 = unlimited)")
+            ("max-file-size", po::value<std::size_t>()->default_value(32),
+             "Skip files larger than this many MB (0 = unlimited)")
+            ("max-ast-size", po::value<std::size_t>()->default_value(0),
+             "Stop analyzing a file once its AST exceeds this many MB (0 = unlimited)")
+            ("max-template-depth", po::value<unsigned int>()->default_value(0),
+             "Maximum template instantiation depth (0 = Clang default)")
         ;
 
         po::options_description output("Output Options");
@@ -54,10 +115,10 @@ std::optional<analyze_args> parse_arguments(int argc, char* argv[]) {
         positional.add("target", 1);
 
         po::options_description cmdline_options;
-        cmdline_options.add(general).add(analysis).add(output).add(hidden);
+        cmdline_options.add(general).add(analysis).add(server).add(limits).add(output).add(hidden);
 
         po::options_description visible_options("boost-safeprofile - C++ Safety Profile conformance analysis tool");
-        visible_options.add(general).add(analysis).add(output);
+        visible_options.add(general).add(analysis).add(server).add(limits).add(output);
 
         po::variables_map vm;
         po::store(po::command_line_parser(argc, argv)
@@ -76,25 +137,91 @@ std::optional<analyze_args> parse_arguments(int argc, char* argv[]) {
         }
 
         // Handle --help
-        if (vm.count("help") || !vm.count("target")) {
+        if (vm.count("help") || (!vm.count("target") && !vm.count("serve") && !vm["lsp"].as<bool>())) {
             std::cout << visible_options << "\n";
             std::cout << "Usage:\n";
-            std::cout << "  boost-safeprofile [options] <path|repository>\n\n";
+            std::cout << "  boost-safeprofile [options] <path|repository>\n";
+            std::cout << "  boost-safeprofile --serve <socket> [options]\n";
+            std::cout << "  boost-safeprofile --lsp [options] [workspace]\n\n";
             std::cout << "Examples:\n";
             std::cout << "  boost-safeprofile ./my-project\n";
             std::cout << "  boost-safeprofile --profile memory-safety --sarif out.sarif ./src\n";
             std::cout << "  boost-safeprofile --evidence ./evidence https://github.com/user/repo\n";
+            std::cout << "  boost-safeprofile --serve /tmp/safeprofile.sock --cache-dir ~/.cache/safeprofile\n";
+            std::cout << "  boost-safeprofile --connect /tmp/safeprofile.sock ./my-project\n";
             return std::nullopt;
         }
 
         // Extract arguments
-        args.target_path = vm["target"].as<std::string>();
+        if (vm.count("target")) {
+            args.target_path = vm["target"].as<std::string>();
+        }
         args.profile = vm["profile"].as<std::string>();
+        args.jobs = vm["jobs"].as<unsigned int>();
 
         if (vm.count("config")) {
             args.config_file = vm["config"].as<std::string>();
         }
 
+        args.watch = vm["watch"].as<bool>();
+        args.debounce_ms = vm["debounce"].as<unsigned int>();
+        args.isolate = vm["isolate"].as<bool>();
+        args.memory_limit_mb = vm["memory-limit"].as<std::size_t>();
+        if (args.memory_limit_mb > 0 && !args.isolate) {
+            throw po::error("--memory-limit requires --isolate");
+        }
+        args.precompiled_preambles = !vm["no-pch"].as<bool>();
+        args.umbrella = vm["umbrella"].as<bool>();
+        args.header_deduplication = !vm["no-header-dedup"].as<bool>();
+        args.traversal_scope = !vm["no-traversal-scope"].as<bool>();
+        args.match_instantiations = vm["match-instantiations"].as<bool>();
+        args.fast_parse = vm["fast-parse"].as<bool>();
+        args.invocation_reuse = !vm["no-invocation-reuse"].as<bool>();
+        args.clang_tool = vm["clang-tool"].as<bool>();
+        if (args.clang_tool && (args.isolate || args.umbrella)) {
+            throw po::error("--clang-tool cannot be combined with --isolate or --umbrella");
+        }
+        args.prefilter = vm["prefilter"].as<std::string>();
+        if (args.prefilter != "off" && args.prefilter != "prune" && args.prefilter != "skip") {
+            throw po::error("--prefilter must be off, prune or skip");
+        }
+        args.tu_timeout_seconds = vm["tu-timeout"].as<double>();
+        args.max_file_size_mb = vm["max-file-size"].as<std::size_t>();
+        args.max_ast_mb = vm["max-ast-size"].as<std::size_t>();
+        args.max_template_depth = vm["max-template-depth"].as<unsigned int>();
+
+        if (vm.count("cost-history")) {
+            args.cost_history = vm["cost-history"].as<std::string>();
+        }
+
+        if (vm.count("cache-dir")) {
+            args.cache_dir = vm["cache-dir"].as<std::string>();
+        }
+
+        if (vm.count("since")) {
+            args.since = vm["since"].as<std::string>();
+        }
+
+        if (vm.count("serve")) {
+            args.serve_socket = vm["serve"].as<std::string>();
+        }
+
+        if (vm.count("connect")) {
+            args.connect_socket = vm["connect"].as<std::string>();
+            if (args.serve_socket) {
+                throw po::error("--serve and --connect are mutually exclusive");
+            }
+        }
+
+        if (args.watch && (args.serve_socket || args.connect_socket)) {
+            throw po::error("--watch cannot be combined with --serve or --connect");
+        }
+
+        args.lsp = vm["lsp"].as<bool>();
+        if (args.lsp && (args.serve_socket || args.connect_socket || args.watch)) {
+            throw po::error("--lsp cannot be combined with --serve, --connect or --watch");
+        }
+
         if (vm.count("sarif")) {
             args.sarif_output = vm["sarif"].as<std::string>();
         }
@@ -114,6 +241,17 @@ std::optional<analyze_args> parse_arguments(int argc, char* argv[]) {
             args.offline = vm["offline"].as<bool>();
         }
 
+        args.remote_cache_timeout_seconds = vm["remote-cache-timeout"].as<double>();
+        if (vm.count("remote-cache")) {
+            args.remote_cache = vm["remote-cache"].as<std::string>();
+            if (!args.cache_dir) {
+                throw po::error("--remote-cache requires --cache-dir");
+            }
+            if (args.offline) {
+                throw po::error("--remote-cache needs network access; add --online");
+            }
+        }
+
         return args;
 
     } catch (const po::error& e) {
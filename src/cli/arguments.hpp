@@ -6,6 +6,7 @@
 #ifndef BOOST_SAFEPROFILE_CLI_ARGUMENTS_HPP
 #define BOOST_SAFEPROFILE_CLI_ARGUMENTS_HPP
 
+#include <cstddef>
 #include <string>
 #include <optional>
 
@@ -21,6 +22,32 @@ struct analyze_args {
     std::optional<std::string> sarif_output;    // SARIF output path
     std::optional<std::string> html_output;     // HTML report output path
     std::optional<std::string> evidence_dir;    // Evidence pack directory
+    unsigned int jobs{0};                       // Parallel TU workers (0 = hardware concurrency)
+    std::optional<std::string> cost_history;    // Per-file timing history for scheduling
+    std::optional<std::string> cache_dir;       // Persistent per-TU result cache
+    std::optional<std::string> remote_cache;    // Shared HTTP result cache (requires online mode)
+    double remote_cache_timeout_seconds{2.0};   // Deadline per remote cache request
+    std::optional<std::string> since;           // Only files changed since this git ref (and dependents)
+    bool watch{false};                          // Re-analyze affected files whenever the tree changes
+    unsigned int debounce_ms{200};              // Quiet period before --watch re-analyzes
+    std::optional<std::string> serve_socket;    // Run as a daemon listening on this Unix socket
+    std::optional<std::string> connect_socket;  // Send the analysis to a daemon on this socket
+    bool lsp{false};                            // Serve the Language Server Protocol on stdin/stdout
+    bool isolate{false};                        // Analyze each TU in a forked worker process
+    std::size_t memory_limit_mb{0};             // Per-worker address space cap (0 = unlimited)
+    bool precompiled_preambles{true};           // Share PCHs for common include prefixes
+    bool umbrella{false};                       // Parse headers together in one umbrella TU
+    bool header_deduplication{true};            // Analyze headers via the TUs including them
+    bool traversal_scope{true};                 // Match only declarations in the reported files
+    bool match_instantiations{false};           // Also match template instantiations and implicit code
+    bool fast_parse{false};                     // Skip function bodies outside the analyzed files
+    bool invocation_reuse{true};                // Parse each distinct command line with the driver once
+    bool clang_tool{false};                     // Batch TUs through ClangTool with full command lines
+    std::string prefilter{"prune"};             // Lexical prefilter: off, prune or skip
+    double tu_timeout_seconds{300.0};           // Wall clock budget per TU (0 = unlimited)
+    std::size_t max_file_size_mb{32};           // Largest main file analyzed (0 = unlimited)
+    std::size_t max_ast_mb{0};                  // AST memory cap per TU (0 = unlimited)
+    unsigned int max_template_depth{0};         // -ftemplate-depth (0 = Clang default)
     bool offline{true};                         // Offline mode (default)
     bool help{false};                           // Show help
     bool version{false};                        // Show version
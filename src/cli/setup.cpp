@@ -0,0 +1,197 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "setup.hpp"
+#include "analysis/cache_backend.hpp"
+#include "analysis/result_cache.hpp"
+#include "analysis/scheduler.hpp"
+#include "intake/git_changes.hpp"
+#include "intake/include_graph.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+
+namespace boost {
+namespace safeprofile {
+namespace cli {
+
+inferred_include_paths infer_include_paths(const fs::path& target) {
+    inferred_include_paths result;
+
+    // Add the target directory itself (for relative includes)
+    fs::path target_abs = fs::absolute(target);
+    result.paths.push_back(target_abs.string());
+
+    // If analyzing within an 'include/' directory, also add parent
+    // (supports common pattern: boost-json/include/boost/json/...)
+    if (target_abs.filename() == "include") {
+        result.paths.push_back(target_abs.parent_path().string());
+    }
+    // If inside a subdirectory of 'include/', add the include root
+    else {
+        auto parent = target_abs.parent_path();
+        while (!parent.empty() && parent != parent.parent_path()) {
+            if (parent.filename() == "include") {
+                result.paths.push_back(parent.string());
+                break;
+            }
+            parent = parent.parent_path();
+        }
+    }
+
+    // Auto-detect Boost headers (for analyzing Boost libraries)
+    // Check common system install locations
+    std::vector<fs::path> boost_search_paths = {
+        "/opt/homebrew/include",               // macOS Homebrew
+        "/usr/local/include",                  // Standard Unix/Linux
+        "/usr/include",                        // Debian/Ubuntu
+        fs::path(getenv("HOME") ? getenv("HOME") : "") / ".local/include"  // User install
+    };
+
+    for (const auto& search_path : boost_search_paths) {
+        if (fs::exists(search_path / "boost" / "config.hpp")) {
+            // System install (boost/ directory at root)
+            result.boost_root = search_path;
+            result.paths.push_back(result.boost_root.string());
+            break;
+        } else if (fs::exists(search_path / "libs" / "config" / "include" / "boost" / "config.hpp")) {
+            // Boost super-project layout (libs/*/include/)
+            result.boost_root = search_path;
+            // Add all libs/*/include directories
+            if (fs::exists(result.boost_root / "libs")) {
+                fs::directory_iterator end_iter;
+                for (fs::directory_iterator lib_iter(result.boost_root / "libs"); lib_iter != end_iter; ++lib_iter) {
+                    if (fs::is_directory(lib_iter->status())) {
+                        auto include_dir = lib_iter->path() / "include";
+                        if (fs::exists(include_dir)) {
+                            result.paths.push_back(include_dir.string());
+                        }
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+std::shared_ptr<intake::compile_commands_reader> use_compilation_database(
+    analysis::ast_detector& detector,
+    const fs::path& target,
+    inferred_include_paths* inferred
+) {
+    auto compile_db = std::make_shared<intake::compile_commands_reader>();
+    if (compile_db->load_from_directory(target)) {
+        detector.set_compilation_database(compile_db);
+        return compile_db;
+    }
+    auto paths = infer_include_paths(target);
+    detector.set_compilation_database(nullptr);
+    detector.set_additional_include_paths(paths.paths);
+    if (inferred) {
+        *inferred = std::move(paths);
+    }
+    return nullptr;
+}
+
+void narrow_to_affected(
+    std::vector<intake::source_file>& sources,
+    const fs::path& target,
+    const std::vector<fs::path>& changed,
+    const intake::compile_commands_reader* compile_db
+) {
+    std::vector<fs::path> discovered;
+    std::vector<fs::path> include_paths = {target};
+    for (const auto& src : sources) {
+        discovered.push_back(src.path);
+        if (compile_db && compile_db->is_loaded()) {
+            if (auto flags = compile_db->get_flags_for_file(src.path)) {
+                include_paths.insert(include_paths.end(),
+                    flags->include_paths.begin(), flags->include_paths.end());
+            }
+        }
+    }
+    std::sort(include_paths.begin(), include_paths.end());
+    include_paths.erase(std::unique(include_paths.begin(), include_paths.end()), include_paths.end());
+
+    auto graph = intake::include_graph::build(discovered, include_paths);
+    auto affected = graph.affected_by(changed);
+
+    std::set<fs::path> keep(affected.begin(), affected.end());
+    sources.erase(std::remove_if(sources.begin(), sources.end(),
+        [&](const intake::source_file& src) { return keep.count(src.path) == 0; }),
+        sources.end());
+}
+
+std::size_t narrow_to_changes(
+    std::vector<intake::source_file>& sources,
+    const fs::path& target,
+    const std::string& since,
+    const intake::compile_commands_reader* compile_db
+) {
+    auto changed = intake::changed_files_since(target, since);
+    narrow_to_affected(sources, target, changed, compile_db);
+    return changed.size();
+}
+
+detector_setup configure_detector(analysis::ast_detector& detector, const analyze_args& args) {
+    detector.set_jobs(args.jobs);
+    detector.set_process_isolation(args.isolate, args.memory_limit_mb);
+    detector.set_precompiled_preambles(args.precompiled_preambles);
+    detector.set_umbrella_headers(args.umbrella);
+    detector.set_header_deduplication(args.header_deduplication);
+    detector.set_traversal_scope(args.traversal_scope);
+    detector.set_fast_parse(args.fast_parse);
+    detector.set_invocation_reuse(args.invocation_reuse);
+    detector.set_clang_tool(args.clang_tool);
+    detector.set_match_traversal(args.match_instantiations
+        ? analysis::match_traversal::all_nodes
+        : analysis::match_traversal::as_spelled);
+    detector.set_lexical_prefilter(
+        args.prefilter == "off" ? analysis::lexical_prefilter::off
+        : args.prefilter == "skip" ? analysis::lexical_prefilter::skip
+        : analysis::lexical_prefilter::prune);
+
+    analysis::analysis_limits limits;
+    limits.time_budget_seconds = args.tu_timeout_seconds;
+    limits.max_file_size_bytes = args.max_file_size_mb * 1024 * 1024;
+    limits.max_ast_memory_mb = args.max_ast_mb;
+    limits.max_template_depth = args.max_template_depth;
+    detector.set_limits(limits);
+
+    // The result cache directory also keeps the timing history unless
+    // one was given explicitly
+    detector_setup setup;
+    setup.history_file = args.cost_history;
+    if (args.cache_dir) {
+        std::shared_ptr<analysis::cache_backend> remote;
+        if (args.remote_cache) {
+            remote = std::make_shared<analysis::http_backend>(
+                *args.remote_cache, args.remote_cache_timeout_seconds);
+        }
+        auto cache = std::make_shared<analysis::result_cache>(
+            std::make_shared<analysis::directory_backend>(*args.cache_dir),
+            remote);
+        cache->set_base_directory(args.target_path);
+        cache->set_prefetch_wait(args.remote_cache_timeout_seconds);
+        detector.set_result_cache(cache);
+        if (!setup.history_file) {
+            setup.history_file = (fs::path(*args.cache_dir) / "cost-history.json").string();
+        }
+    }
+
+    if (setup.history_file) {
+        setup.history = std::make_shared<analysis::cost_history>();
+        setup.history->load(*setup.history_file);
+        detector.set_cost_history(setup.history);
+    }
+
+    return setup;
+}
+
+} // namespace cli
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,76 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_CLI_SETUP_HPP
+#define BOOST_SAFEPROFILE_CLI_SETUP_HPP
+
+#include "cli/arguments.hpp"
+#include "analysis/ast_detector.hpp"
+#include "intake/compile_commands.hpp"
+#include "intake/repository.hpp"
+#include <boost/filesystem.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace cli {
+
+namespace fs = boost::filesystem;
+
+/// Include paths guessed from the target's layout (no compilation database)
+struct inferred_include_paths {
+    std::vector<std::string> paths;
+    fs::path boost_root;  // Where Boost headers were found, if anywhere
+};
+
+/// Guess include paths: the target itself, its enclosing include/ root,
+/// and an installed or super-project Boost
+inferred_include_paths infer_include_paths(const fs::path& target);
+
+/// Load <target>/compile_commands.json into the detector, or fall back to
+/// inferred include paths; returns the database, or null if there is none
+/// Without a database, `inferred` (if given) receives the paths used
+std::shared_ptr<intake::compile_commands_reader> use_compilation_database(
+    analysis::ast_detector& detector,
+    const fs::path& target,
+    inferred_include_paths* inferred = nullptr
+);
+
+/// Keep only sources that are in `changed` or include one of them,
+/// directly or transitively (see intake::include_graph)
+void narrow_to_affected(
+    std::vector<intake::source_file>& sources,
+    const fs::path& target,
+    const std::vector<fs::path>& changed,
+    const intake::compile_commands_reader* compile_db
+);
+
+/// narrow_to_affected() for the files changed since a git revision;
+/// returns the number of changed files
+std::size_t narrow_to_changes(
+    std::vector<intake::source_file>& sources,
+    const fs::path& target,
+    const std::string& since,
+    const intake::compile_commands_reader* compile_db
+);
+
+/// Timing history in use by a configured detector
+struct detector_setup {
+    std::shared_ptr<analysis::cost_history> history;
+    std::optional<std::string> history_file;  // Save the history here after a run
+};
+
+/// Apply the analysis options: jobs, isolation, preambles, header modes,
+/// limits, result cache and timing history
+detector_setup configure_detector(analysis::ast_detector& detector, const analyze_args& args);
+
+} // namespace cli
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_CLI_SETUP_HPP
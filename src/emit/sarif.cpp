@@ -133,6 +133,14 @@ json::object sarif_emitter::create_result(const analysis::finding& f) const {
     locations.push_back(std::move(location));
     result["locations"] = std::move(locations);
 
+    // Token-level candidates from files without an AST
+    if (f.lexical) {
+        result["properties"] = json::object{
+            {"detection", "lexical"},
+            {"confidence", "low"}
+        };
+    }
+
     return result;
 }
 
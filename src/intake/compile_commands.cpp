@@ -5,8 +5,14 @@
 
 #include "compile_commands.hpp"
 #include <boost/json.hpp>
+#include <boost/json/basic_parser_impl.hpp>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <iostream>
 
 namespace boost {
@@ -15,84 +21,407 @@ namespace intake {
 
 namespace json = boost::json;
 
-bool compile_commands_reader::load_from_directory(const fs::path& directory) {
-    // Look for compile_commands.json in the directory
-    fs::path db_path = directory / "compile_commands.json";
+namespace {
+
+// One compile_commands.json entry as written; absent fields stay empty
+struct raw_entry {
+    std::optional<std::string> directory;
+    std::optional<std::string> file;
+    std::optional<std::string> command;
+    std::optional<std::vector<std::string>> arguments;
+};
+
+// json::basic_parser handler that collects the entries of the top-level
+// array straight from the token stream
+class entry_collector {
+public:
+    static constexpr std::size_t max_object_size = std::size_t(-1);
+    static constexpr std::size_t max_array_size = std::size_t(-1);
+    static constexpr std::size_t max_key_size = std::size_t(-1);
+    static constexpr std::size_t max_string_size = std::size_t(-1);
+
+    std::vector<raw_entry> entries;
+    bool top_level_array = false;
+
+    bool on_document_begin(json::error_code&) { return true; }
+    bool on_document_end(json::error_code&) { return true; }
+
+    bool on_array_begin(json::error_code&) {
+        if (depth_ == 0) {
+            top_level_array = true;
+        } else if (in_entry() && key_ == "arguments") {
+            current_.arguments.emplace();
+            in_arguments_ = true;
+        }
+        ++depth_;
+        return true;
+    }
 
-    if (!fs::exists(db_path)) {
-        return false;
+    bool on_array_end(std::size_t, json::error_code&) {
+        --depth_;
+        if (depth_ == 2) {
+            in_arguments_ = false;
+        }
+        return true;
     }
 
-    // Read JSON file
-    std::ifstream ifs(db_path.string());
-    if (!ifs) {
-        return false;
+    bool on_object_begin(json::error_code&) {
+        if (depth_ == 1 && top_level_array) {
+            current_ = raw_entry{};
+        }
+        ++depth_;
+        return true;
     }
 
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    std::string content = buffer.str();
+    bool on_object_end(std::size_t, json::error_code&) {
+        --depth_;
+        if (depth_ == 1 && top_level_array) {
+            entries.push_back(std::move(current_));
+        }
+        return true;
+    }
 
-    try {
-        // Parse JSON
-        json::value doc = json::parse(content);
+    bool on_key_part(json::string_view part, std::size_t, json::error_code&) {
+        text_.append(part.data(), part.size());
+        return true;
+    }
 
-        if (!doc.is_array()) {
-            std::cerr << "Warning: compile_commands.json is not a JSON array\n";
-            return false;
+    bool on_key(json::string_view part, std::size_t, json::error_code&) {
+        text_.append(part.data(), part.size());
+        if (depth_ == 2) {
+            key_ = std::move(text_);
+        }
+        text_.clear();
+        return true;
+    }
+
+    bool on_string_part(json::string_view part, std::size_t, json::error_code&) {
+        text_.append(part.data(), part.size());
+        return true;
+    }
+
+    bool on_string(json::string_view part, std::size_t, json::error_code&) {
+        text_.append(part.data(), part.size());
+        if (in_arguments_ && depth_ == 3) {
+            current_.arguments->push_back(std::move(text_));
+        } else if (in_entry()) {
+            if (key_ == "directory") {
+                current_.directory = std::move(text_);
+            } else if (key_ == "file") {
+                current_.file = std::move(text_);
+            } else if (key_ == "command") {
+                current_.command = std::move(text_);
+            }
         }
+        text_.clear();
+        return true;
+    }
 
-        const auto& entries = doc.as_array();
+    // Numbers, literals and comments carry nothing the reader uses
+    bool on_number_part(json::string_view, json::error_code&) { return true; }
+    bool on_int64(std::int64_t, json::string_view, json::error_code&) { return true; }
+    bool on_uint64(std::uint64_t, json::string_view, json::error_code&) { return true; }
+    bool on_double(double, json::string_view, json::error_code&) { return true; }
+    bool on_bool(bool, json::error_code&) { return true; }
+    bool on_null(json::error_code&) { return true; }
+    bool on_comment_part(json::string_view, json::error_code&) { return true; }
+    bool on_comment(json::string_view, json::error_code&) { return true; }
+
+private:
+    bool in_entry() const { return top_level_array && depth_ == 2; }
+
+    std::size_t depth_ = 0;
+    std::string key_;   // Last key of the current entry
+    std::string text_;  // Key or string assembled from parts
+    raw_entry current_;
+    bool in_arguments_ = false;
+};
+
+// Index layout, all in native byte order:
+//   index_header | index_entry[entry_count] | string_ref[argument_count] | strings
+// Entries are sorted by key. Records are read with memcpy, so the mapping
+// needs no particular alignment.
+constexpr char index_magic[8] = {'S', 'P', 'C', 'C', 'I', 'D', 'X', '\0'};
+constexpr std::uint32_t index_version = 1;
+constexpr std::uint32_t index_byte_order = 0x01020304;
+
+struct string_ref {
+    std::uint64_t offset = 0;  // Into the string area
+    std::uint64_t size = 0;
+};
+
+struct index_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t json_size;
+    std::int64_t json_mtime;
+    std::uint64_t json_hash;
+    std::uint64_t entry_count;
+    std::uint64_t argument_count;
+    std::uint64_t strings_size;
+};
+
+struct index_entry {
+    string_ref key;        // Normalized absolute path
+    string_ref directory;
+    string_ref file;
+    string_ref command;    // Split on lookup; unused if the entry had "arguments"
+    std::uint64_t first_argument;
+    std::uint64_t argument_count;
+    std::uint64_t has_arguments;
+};
+
+template <typename T>
+T read_record(const char* data, std::size_t offset) {
+    T record;
+    std::memcpy(&record, data + offset, sizeof(T));
+    return record;
+}
 
-        // Process each compilation database entry
-        for (const auto& entry : entries) {
-            if (!entry.is_object()) continue;
+std::size_t entries_offset() {
+    return sizeof(index_header);
+}
 
-            const auto& obj = entry.as_object();
+std::size_t arguments_offset(const index_header& header) {
+    return entries_offset() + header.entry_count * sizeof(index_entry);
+}
 
-            // Required fields: file, directory, command (or arguments)
-            if (!obj.contains("file") || !obj.contains("directory")) {
-                continue;
-            }
+std::size_t strings_offset(const index_header& header) {
+    return arguments_offset(header) + header.argument_count * sizeof(string_ref);
+}
 
-            std::string file = obj.at("file").as_string().c_str();
-            std::string directory_str = obj.at("directory").as_string().c_str();
-
-            // Get command string (either "command" or "arguments" field)
-            std::string command;
-            if (obj.contains("command")) {
-                command = obj.at("command").as_string().c_str();
-            } else if (obj.contains("arguments")) {
-                // Convert arguments array to command string
-                const auto& args = obj.at("arguments").as_array();
-                for (size_t i = 0; i < args.size(); ++i) {
-                    if (i > 0) command += " ";
-                    command += args[i].as_string().c_str();
-                }
-            } else {
-                continue;  // No command available
-            }
+// Does `index` describe this JSON, and are its tables inside the buffer?
+bool index_matches(llvm::StringRef index, const index_header& expected) {
+    if (index.size() < sizeof(index_header)) {
+        return false;
+    }
+    auto header = read_record<index_header>(index.data(), 0);
+    if (std::memcmp(header.magic, index_magic, sizeof(index_magic)) != 0 ||
+        header.version != index_version || header.byte_order != index_byte_order ||
+        header.json_size != expected.json_size || header.json_mtime != expected.json_mtime ||
+        header.json_hash != expected.json_hash) {
+        return false;
+    }
 
-            // Parse flags from command
-            compilation_flags flags = parse_command(command, directory_str);
+    // Guard the size arithmetic against a corrupt header
+    const std::uint64_t limit = index.size();
+    if (header.entry_count > limit / sizeof(index_entry) ||
+        header.argument_count > limit / sizeof(string_ref) ||
+        header.strings_size > limit) {
+        return false;
+    }
+    return strings_offset(header) + header.strings_size == limit;
+}
 
-            // Normalize file path to absolute
-            fs::path file_path(file);
-            if (file_path.is_relative()) {
-                file_path = fs::path(directory_str) / file_path;
-            }
+class index_writer {
+public:
+    string_ref add(std::string_view text) {
+        string_ref ref{strings_.size(), text.size()};
+        strings_.append(text);
+        return ref;
+    }
+
+    void add_entry(const index_entry& entry) { entries_.push_back(entry); }
+    std::uint64_t add_argument(std::string_view argument) {
+        arguments_.push_back(add(argument));
+        return arguments_.size() - 1;
+    }
+    std::uint64_t argument_count() const { return arguments_.size(); }
+
+    std::string finish(index_header header) const {
+        std::memcpy(header.magic, index_magic, sizeof(index_magic));
+        header.version = index_version;
+        header.byte_order = index_byte_order;
+        header.entry_count = entries_.size();
+        header.argument_count = arguments_.size();
+        header.strings_size = strings_.size();
+
+        std::string bytes(strings_offset(header) + strings_.size(), '\0');
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (!entries_.empty()) {
+            std::memcpy(bytes.data() + entries_offset(), entries_.data(),
+                        entries_.size() * sizeof(index_entry));
+        }
+        if (!arguments_.empty()) {
+            std::memcpy(bytes.data() + arguments_offset(header), arguments_.data(),
+                        arguments_.size() * sizeof(string_ref));
+        }
+        std::memcpy(bytes.data() + strings_offset(header), strings_.data(), strings_.size());
+        return bytes;
+    }
 
-            std::string normalized = normalize_path(file_path);
-            commands_[normalized] = flags;
+private:
+    std::vector<index_entry> entries_;
+    std::vector<string_ref> arguments_;
+    std::string strings_;
+};
+
+// Replace the index in one step, so a concurrent reader maps either the
+// old one or the new one; a read-only build directory just goes unindexed
+void write_index(const fs::path& path, const std::string& bytes) {
+    boost::system::error_code ec;
+    fs::path temporary = path;
+    temporary += fs::unique_path(".%%%%%%%%.tmp", ec);
+    if (ec) {
+        return;
+    }
+    {
+        std::ofstream out(temporary.string(), std::ios::binary | std::ios::trunc);
+        if (!out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+            out.close();
+            fs::remove(temporary, ec);
+            return;
         }
+    }
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+    }
+}
+
+} // namespace
+
+fs::path compile_commands_reader::index_path(const fs::path& directory) {
+    return directory / "compile_commands.safeprofile-index";
+}
+
+bool compile_commands_reader::load_from_directory(const fs::path& directory) {
+    // Look for compile_commands.json in the directory
+    fs::path db_path = directory / "compile_commands.json";
 
+    if (!fs::exists(db_path)) {
+        return false;
+    }
+
+    // Map the JSON; it is hashed and, without a current index, parsed
+    // straight from the mapping
+    auto mapped = llvm::MemoryBuffer::getFile(db_path.string(), /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (!mapped) {
+        return false;
+    }
+    const llvm::StringRef content = (*mapped)->getBuffer();
+
+    boost::system::error_code ec;
+    index_header expected{};
+    expected.json_size = content.size();
+    expected.json_mtime = static_cast<std::int64_t>(fs::last_write_time(db_path, ec));
+    expected.json_hash = llvm::xxh3_64bits(llvm::arrayRefFromStringRef(content));
+
+    const fs::path index_file = index_path(directory);
+    auto existing = llvm::MemoryBuffer::getFile(index_file.string(), /*IsText=*/false,
+                                                /*RequiresNullTerminator=*/false);
+    if (existing && index_matches((*existing)->getBuffer(), expected)) {
+        index_ = std::shared_ptr<const llvm::MemoryBuffer>(std::move(*existing));
+        entry_count_ = read_record<index_header>(index_->getBufferStart(), 0).entry_count;
+        from_index_ = true;
         loaded_ = true;
         return true;
+    }
 
+    entry_collector collector;
+    try {
+        json::basic_parser<entry_collector> parser(json::parse_options{});
+        json::error_code parse_error;
+        parser.write_some(false, content.data(), content.size(), parse_error);
+        if (parse_error) {
+            std::cerr << "Error parsing compile_commands.json: " << parse_error.message() << "\n";
+            return false;
+        }
+        if (!parser.handler().top_level_array) {
+            std::cerr << "Warning: compile_commands.json is not a JSON array\n";
+            return false;
+        }
+        collector = std::move(parser.handler());
     } catch (const std::exception& e) {
         std::cerr << "Error parsing compile_commands.json: " << e.what() << "\n";
         return false;
     }
+
+    // Required fields: file, directory, command (or arguments)
+    struct keyed {
+        std::string key;
+        std::size_t entry;
+    };
+    std::vector<keyed> order;
+    order.reserve(collector.entries.size());
+    for (std::size_t i = 0; i < collector.entries.size(); ++i) {
+        const auto& entry = collector.entries[i];
+        if (!entry.file || !entry.directory || (!entry.arguments && !entry.command)) {
+            continue;
+        }
+
+        // Normalize file path to absolute
+        fs::path file_path(*entry.file);
+        if (file_path.is_relative()) {
+            file_path = fs::path(*entry.directory) / file_path;
+        }
+        order.push_back({normalize_path(file_path), i});
+    }
+
+    // The last entry for a file wins
+    std::stable_sort(order.begin(), order.end(),
+                     [](const keyed& a, const keyed& b) { return a.key < b.key; });
+
+    index_writer writer;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        if (i + 1 < order.size() && order[i + 1].key == order[i].key) {
+            continue;
+        }
+        const raw_entry& entry = collector.entries[order[i].entry];
+
+        index_entry record{};
+        record.key = writer.add(order[i].key);
+        record.directory = writer.add(*entry.directory);
+        record.file = writer.add(*entry.file);
+        if (entry.arguments) {
+            record.has_arguments = 1;
+            record.first_argument = writer.argument_count();
+            for (const auto& argument : *entry.arguments) {
+                writer.add_argument(argument);
+            }
+            record.argument_count = entry.arguments->size();
+        } else {
+            record.command = writer.add(*entry.command);
+        }
+        writer.add_entry(record);
+    }
+
+    const std::string bytes = writer.finish(expected);
+    write_index(index_file, bytes);
+
+    index_ = std::shared_ptr<const llvm::MemoryBuffer>(
+        llvm::MemoryBuffer::getMemBufferCopy(bytes, index_file.string()));
+    entry_count_ = read_record<index_header>(bytes.data(), 0).entry_count;
+    from_index_ = false;
+    loaded_ = true;
+    return true;
+}
+
+std::optional<std::size_t> compile_commands_reader::find_entry(std::string_view key) const {
+    const char* data = index_->getBufferStart();
+    const auto header = read_record<index_header>(data, 0);
+    const std::string_view strings(data + strings_offset(header), header.strings_size);
+    auto key_at = [&](std::size_t i) {
+        auto entry = read_record<index_entry>(data, entries_offset() + i * sizeof(index_entry));
+        return strings.substr(entry.key.offset, entry.key.size);
+    };
+
+    std::size_t low = 0;
+    std::size_t high = header.entry_count;
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        if (key_at(middle) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < header.entry_count && key_at(low) == key) {
+        return low;
+    }
+    return std::nullopt;
 }
 
 std::optional<compilation_flags> compile_commands_reader::get_flags_for_file(
@@ -103,29 +432,111 @@ std::optional<compilation_flags> compile_commands_reader::get_flags_for_file(
     }
 
     std::string normalized = normalize_path(source_file);
-    auto it = commands_.find(normalized);
+    auto found = find_entry(normalized);
+    if (!found) {
+        return std::nullopt;
+    }
 
-    if (it != commands_.end()) {
-        return it->second;
+    // Flags are derived on lookup, not for every entry at load time
+    const char* data = index_->getBufferStart();
+    const auto header = read_record<index_header>(data, 0);
+    const std::string_view strings(data + strings_offset(header), header.strings_size);
+    auto text = [&](const string_ref& ref) {
+        return std::string(strings.substr(ref.offset, ref.size));
+    };
+
+    auto entry = read_record<index_entry>(data, entries_offset() + *found * sizeof(index_entry));
+    std::vector<std::string> arguments;
+    if (entry.has_arguments) {
+        arguments.reserve(entry.argument_count);
+        for (std::uint64_t i = 0; i < entry.argument_count; ++i) {
+            arguments.push_back(text(read_record<string_ref>(
+                data, arguments_offset(header) + (entry.first_argument + i) * sizeof(string_ref))));
+        }
+    } else {
+        arguments = split_command(text(entry.command));
     }
 
-    return std::nullopt;
+    compilation_flags flags = parse_command(arguments, text(entry.directory));
+    flags.file = text(entry.file);
+    flags.arguments = std::move(arguments);
+    return flags;
+}
+
+std::vector<std::string> compile_commands_reader::files() const {
+    std::vector<std::string> result;
+    if (!loaded_) {
+        return result;
+    }
+
+    const char* data = index_->getBufferStart();
+    const auto header = read_record<index_header>(data, 0);
+    const std::string_view strings(data + strings_offset(header), header.strings_size);
+    result.reserve(header.entry_count);
+    for (std::uint64_t i = 0; i < header.entry_count; ++i) {
+        auto entry = read_record<index_entry>(data, entries_offset() + i * sizeof(index_entry));
+        result.emplace_back(strings.substr(entry.key.offset, entry.key.size));
+    }
+    return result;
+}
+
+std::vector<std::string> split_command(const std::string& command) {
+    std::vector<std::string> arguments;
+    std::string current;
+    bool in_argument = false;
+    char quote = 0;
+
+    for (std::size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        if (quote == '\'') {
+            if (c == '\'') {
+                quote = 0;
+            } else {
+                current += c;
+            }
+        } else if (quote == '"') {
+            if (c == '"') {
+                quote = 0;
+            } else if (c == '\\' && i + 1 < command.size() &&
+                       (command[i + 1] == '"' || command[i + 1] == '\\')) {
+                current += command[++i];
+            } else {
+                current += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            in_argument = true;
+        } else if (c == '\\' && i + 1 < command.size()) {
+            current += command[++i];
+            in_argument = true;
+        } else if (c == ' ' || c == '\t' || c == '\n') {
+            if (in_argument) {
+                arguments.push_back(std::move(current));
+                current.clear();
+                in_argument = false;
+            }
+        } else {
+            current += c;
+            in_argument = true;
+        }
+    }
+    if (in_argument) {
+        arguments.push_back(std::move(current));
+    }
+    return arguments;
 }
 
 compilation_flags compile_commands_reader::parse_command(
-    const std::string& command,
+    const std::vector<std::string>& arguments,
     const std::string& working_directory
 ) const {
     compilation_flags flags;
     flags.working_directory = working_directory;
     flags.std_version = "c++20";  // Default fallback
 
-    // Simple tokenization by spaces (good enough for most cases)
-    std::istringstream iss(command);
-    std::string token;
     std::string prev_token;
 
-    while (iss >> token) {
+    for (const auto& token : arguments) {
         // -I include paths
         if (token.find("-I") == 0) {
             if (token.length() > 2) {
@@ -169,12 +580,19 @@ compilation_flags compile_commands_reader::parse_command(
 
 std::string compile_commands_reader::normalize_path(const fs::path& path) const {
     try {
-        // Convert to absolute canonical path for consistent lookup
-        fs::path abs = fs::absolute(path);
-        if (fs::exists(abs)) {
-            return fs::canonical(abs).string();
+        // Absolute, with the directory resolved canonically; entries share
+        // few directories, so each is resolved once
+        fs::path abs = fs::absolute(path).lexically_normal();
+        const std::string parent = abs.parent_path().string();
+
+        std::lock_guard<std::mutex> lock(directories_mutex_);
+        auto it = canonical_directories_.find(parent);
+        if (it == canonical_directories_.end()) {
+            boost::system::error_code ec;
+            fs::path canonical = fs::canonical(abs.parent_path(), ec);
+            it = canonical_directories_.emplace(parent, ec ? parent : canonical.string()).first;
         }
-        return abs.string();
+        return (fs::path(it->second) / abs.filename()).string();
     } catch (...) {
         return path.string();
     }
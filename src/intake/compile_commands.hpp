@@ -7,11 +7,18 @@
 #define BOOST_SAFEPROFILE_INTAKE_COMPILE_COMMANDS_HPP
 
 #include <boost/filesystem.hpp>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <unordered_map>
 
+namespace llvm {
+class MemoryBuffer;
+}
+
 namespace boost {
 namespace safeprofile {
 namespace intake {
@@ -24,16 +31,35 @@ struct compilation_flags {
     std::vector<std::string> defines;          // -D flags
     std::string std_version;                   // -std=c++XX
     std::string working_directory;             // Directory context for relative paths
+    std::string file;                          // Source file as the entry spells it
+    std::vector<std::string> arguments;        // Full command line, compiler first
 };
 
+/// Split a shell command line into arguments
+/// Handles single and double quotes and backslash escapes the way a POSIX
+/// shell does; no variables or globs are expanded
+std::vector<std::string> split_command(const std::string& command);
+
 /// Reads and parses compile_commands.json
 /// This enables analyzing real-world projects with correct include paths and flags
+/// The JSON is mapped and parsed as a token stream, without a document
+/// tree; entries are kept as written and only turned into flags when a
+/// file is looked up. The entries, sorted by normalized path, are saved as
+/// a binary index next to the JSON (see index_path()), which later loads
+/// map instead of parsing as long as the JSON's size, modification time
+/// and content hash are unchanged.
 class compile_commands_reader {
 public:
     /// Try to load compile_commands.json from a directory
     /// Returns true if found and loaded successfully
     bool load_from_directory(const fs::path& directory);
 
+    /// Where the index for the compile_commands.json in `directory` lives
+    static fs::path index_path(const fs::path& directory);
+
+    /// True if the last load used an existing index instead of the JSON
+    bool loaded_from_index() const { return from_index_; }
+
     /// Get compilation flags for a specific source file
     /// Returns nullopt if no entry found for this file
     std::optional<compilation_flags> get_flags_for_file(const fs::path& source_file) const;
@@ -42,19 +68,31 @@ public:
     bool is_loaded() const { return loaded_; }
 
     /// Get number of entries in compilation database
-    size_t entry_count() const { return commands_.size(); }
+    size_t entry_count() const { return entry_count_; }
+
+    /// Normalized paths of every file with an entry
+    std::vector<std::string> files() const;
 
 private:
     bool loaded_ = false;
-    std::unordered_map<std::string, compilation_flags> commands_;  // key: absolute file path
+    bool from_index_ = false;
+    std::shared_ptr<const llvm::MemoryBuffer> index_;  // Mapped or freshly built
+    std::size_t entry_count_ = 0;
+
+    mutable std::mutex directories_mutex_;
+    mutable std::unordered_map<std::string, std::string> canonical_directories_;
+
+    /// Binary search the index for a normalized path
+    std::optional<std::size_t> find_entry(std::string_view key) const;
 
-    /// Parse compiler command string and extract flags
+    /// Extract flags from a split compiler command line
     compilation_flags parse_command(
-        const std::string& command,
+        const std::vector<std::string>& arguments,
         const std::string& working_directory
     ) const;
 
     /// Normalize file path to absolute canonical form for lookup
+    /// Only the directory is canonicalized, once per distinct directory
     std::string normalize_path(const fs::path& path) const;
 };
 
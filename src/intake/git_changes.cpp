@@ -0,0 +1,132 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "git_changes.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BOOST_SAFEPROFILE_HAS_FORK 1
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+#ifdef BOOST_SAFEPROFILE_HAS_FORK
+
+namespace {
+
+// Run git with arguments in a directory; returns stdout or throws
+// The arguments go straight to execvp, so refs are never shell-expanded
+std::string run_git(const fs::path& directory, const std::vector<std::string>& args) {
+    std::vector<std::string> command = {"git", "-C", directory.string()};
+    command.insert(command.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (auto& arg : command) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        throw std::runtime_error(std::string("Failed to run git: ") + std::strerror(errno));
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        int err = errno;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error(std::string("Failed to run git: ") + std::strerror(err));
+    }
+
+    if (pid == 0) {
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        ::execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    ::close(fds[1]);
+    std::string output;
+    char chunk[65536];
+    for (;;) {
+        ssize_t got = ::read(fds[0], chunk, sizeof(chunk));
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (got == 0) break;
+        output.append(chunk, static_cast<std::size_t>(got));
+    }
+    ::close(fds[0]);
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            throw std::runtime_error("Lost track of git process");
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("git " + args.front() + " failed in " + directory.string() +
+            (WIFEXITED(status) && WEXITSTATUS(status) == 127 ? " (git not found)" : ""));
+    }
+    return output;
+}
+
+// Split NUL-terminated paths (git -z output)
+void append_paths(const fs::path& directory, const std::string& output, std::vector<fs::path>& paths) {
+    std::size_t pos = 0;
+    while (pos < output.size()) {
+        std::size_t end = output.find('\0', pos);
+        if (end == std::string::npos) {
+            end = output.size();
+        }
+        if (end > pos) {
+            paths.push_back(directory / output.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+}
+
+} // namespace
+
+std::vector<fs::path> changed_files_since(const fs::path& directory, const std::string& ref) {
+    if (ref.empty() || ref.front() == '-') {
+        throw std::runtime_error("Invalid git revision: '" + ref + "'");
+    }
+    const fs::path root = fs::absolute(directory);
+
+    // Paths relative to `root`, limited to files under it; "--" keeps a
+    // ref that names a file from being read as a path. Deletions stay in
+    // (their includers are affected), and --no-renames reports a rename
+    // as its old path deleted and its new path added
+    std::vector<fs::path> paths;
+    append_paths(root, run_git(root, {"diff", "--name-only", "--relative", "-z",
+                                      "--no-renames", ref, "--"}), paths);
+    append_paths(root, run_git(root, {"ls-files", "--others", "--exclude-standard", "-z"}), paths);
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    return paths;
+}
+
+#else
+
+std::vector<fs::path> changed_files_since(const fs::path& /*directory*/, const std::string& /*ref*/) {
+    throw std::runtime_error("--since requires a POSIX system");
+}
+
+#endif
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,31 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_INTAKE_GIT_CHANGES_HPP
+#define BOOST_SAFEPROFILE_INTAKE_GIT_CHANGES_HPP
+
+#include <boost/filesystem.hpp>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+namespace fs = boost::filesystem;
+
+/// Files under a directory that differ from a git revision
+/// Covers committed, staged and unstaged edits plus untracked files not
+/// ignored by .gitignore. Deleted files, including the old path of a
+/// renamed file, are listed too, so they may no longer exist. Paths are
+/// absolute.
+/// Throws std::runtime_error if git fails (not a repository, unknown ref).
+std::vector<fs::path> changed_files_since(const fs::path& directory, const std::string& ref);
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_INTAKE_GIT_CHANGES_HPP
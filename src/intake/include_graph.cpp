@@ -0,0 +1,270 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "include_graph.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+namespace {
+
+std::string normalize(const fs::path& path) {
+    return fs::absolute(path).lexically_normal().generic_string();
+}
+
+// Replace comments with spaces, keeping newlines so lines stay intact
+// String and character literals are skipped so "//" inside them survives
+std::string strip_comments(std::string_view source) {
+    std::string out(source);
+    std::size_t i = 0;
+    while (i < out.size()) {
+        char c = out[i];
+        if (c == '"' || c == '\'') {
+            for (++i; i < out.size() && out[i] != c && out[i] != '\n'; ++i) {
+                if (out[i] == '\\') {
+                    ++i;
+                }
+            }
+            ++i;
+        } else if (c == '/' && i + 1 < out.size() && out[i + 1] == '/') {
+            for (; i < out.size() && out[i] != '\n'; ++i) {
+                out[i] = ' ';
+            }
+        } else if (c == '/' && i + 1 < out.size() && out[i + 1] == '*') {
+            std::size_t end = out.find("*/", i + 2);
+            end = end == std::string::npos ? out.size() : end + 2;
+            for (; i < end; ++i) {
+                if (out[i] != '\n') {
+                    out[i] = ' ';
+                }
+            }
+        } else {
+            ++i;
+        }
+    }
+    return out;
+}
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string read_file(const fs::path& file) {
+    std::ifstream ifs(file.string(), std::ios::binary);
+    std::stringstream buffer;
+    buffer << ifs.rdbuf();
+    return buffer.str();
+}
+
+} // namespace
+
+std::vector<include_directive> scan_includes(std::string_view source) {
+    std::vector<include_directive> directives;
+    const std::string text = strip_comments(source);
+
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string_view line(text.data() + pos, end - pos);
+        pos = end + 1;
+
+        std::size_t i = 0;
+        while (i < line.size() && is_blank(line[i])) ++i;
+        if (i == line.size() || line[i] != '#') {
+            continue;
+        }
+        ++i;
+        while (i < line.size() && is_blank(line[i])) ++i;
+
+        // #include and #include_next
+        if (line.compare(i, 7, "include") != 0) {
+            continue;
+        }
+        i += 7;
+        while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_')) ++i;
+        while (i < line.size() && is_blank(line[i])) ++i;
+        if (i == line.size() || (line[i] != '"' && line[i] != '<')) {
+            continue;  // Macro-expanded include names are not resolved
+        }
+
+        include_directive directive;
+        directive.angled = line[i] == '<';
+        const char close = directive.angled ? '>' : '"';
+        std::size_t name_end = line.find(close, i + 1);
+        if (name_end == std::string_view::npos || name_end == i + 1) {
+            continue;
+        }
+        directive.name = std::string(line.substr(i + 1, name_end - i - 1));
+        directives.push_back(std::move(directive));
+    }
+
+    return directives;
+}
+
+include_graph include_graph::build(
+    const std::vector<fs::path>& files,
+    const std::vector<fs::path>& include_paths
+) {
+    include_graph graph;
+    graph.files_ = files;
+    graph.includes_.resize(files.size());
+    graph.included_by_.resize(files.size());
+
+    std::unordered_map<std::string, std::vector<std::size_t>> by_filename;
+    std::vector<std::string> keys;
+    keys.reserve(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        keys.push_back(normalize(files[i]));
+        graph.index_.emplace(keys.back(), i);
+        by_filename[files[i].filename().string()].push_back(i);
+    }
+
+    std::vector<fs::path> search_paths;
+    search_paths.reserve(include_paths.size());
+    for (const auto& path : include_paths) {
+        search_paths.push_back(fs::absolute(path));
+    }
+
+    auto lookup = [&](const fs::path& candidate) -> std::optional<std::size_t> {
+        auto it = graph.index_.find(candidate.lexically_normal().generic_string());
+        if (it == graph.index_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    };
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        auto& edges = graph.includes_[i];
+        const fs::path directory = fs::path(keys[i]).parent_path();
+
+        for (const auto& directive : scan_includes(read_file(files[i]))) {
+            std::optional<std::size_t> target;
+            if (!directive.angled) {
+                target = lookup(directory / directive.name);
+            }
+            for (std::size_t p = 0; !target && p < search_paths.size(); ++p) {
+                target = lookup(search_paths[p] / directive.name);
+            }
+
+            if (target) {
+                edges.push_back(*target);
+                continue;
+            }
+
+            // Include path unknown (no compilation database entry, or a
+            // generated search path): assume any file spelled that way
+            const fs::path spelled = fs::path(directive.name).lexically_normal();
+            const std::string suffix = "/" + spelled.generic_string();
+            bool matched = false;
+            auto candidates = by_filename.find(spelled.filename().string());
+            if (candidates != by_filename.end()) {
+                for (std::size_t candidate : candidates->second) {
+                    if (ends_with(keys[candidate], suffix)) {
+                        edges.push_back(candidate);
+                        matched = true;
+                    }
+                }
+            }
+
+            // Kept so that deleting the header it used to name re-analyzes
+            // this file
+            if (!matched) {
+                graph.unresolved_[spelled.filename().string()].emplace_back(suffix, i);
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        for (std::size_t target : edges) {
+            graph.included_by_[target].push_back(i);
+        }
+    }
+
+    return graph;
+}
+
+std::optional<std::size_t> include_graph::find(const fs::path& file) const {
+    auto it = index_.find(normalize(file));
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<fs::path> include_graph::affected_by(const std::vector<fs::path>& changed) const {
+    std::vector<bool> affected(files_.size(), false);
+    std::vector<std::size_t> stack;
+    auto mark = [&](std::size_t index) {
+        if (!affected[index]) {
+            affected[index] = true;
+            stack.push_back(index);
+        }
+    };
+    for (const auto& file : changed) {
+        if (auto index = find(file)) {
+            mark(*index);
+            continue;
+        }
+
+        // Gone from the tree: whatever still spells a path ending in it
+        auto includers = unresolved_.find(file.filename().string());
+        if (includers == unresolved_.end()) {
+            continue;
+        }
+        const std::string key = normalize(file);
+        for (const auto& [suffix, includer] : includers->second) {
+            if (ends_with(key, suffix)) {
+                mark(includer);
+            }
+        }
+    }
+
+    // Walk reverse edges: everything that reaches a changed file
+    while (!stack.empty()) {
+        std::size_t index = stack.back();
+        stack.pop_back();
+        for (std::size_t user : included_by_[index]) {
+            if (!affected[user]) {
+                affected[user] = true;
+                stack.push_back(user);
+            }
+        }
+    }
+
+    std::vector<fs::path> result;
+    for (std::size_t i = 0; i < files_.size(); ++i) {
+        if (affected[i]) {
+            result.push_back(files_[i]);
+        }
+    }
+    return result;
+}
+
+std::vector<fs::path> include_graph::includes(const fs::path& file) const {
+    std::vector<fs::path> result;
+    if (auto index = find(file)) {
+        for (std::size_t target : includes_[*index]) {
+            result.push_back(files_[target]);
+        }
+    }
+    return result;
+}
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
@@ -0,0 +1,77 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_INTAKE_INCLUDE_GRAPH_HPP
+#define BOOST_SAFEPROFILE_INTAKE_INCLUDE_GRAPH_HPP
+
+#include <boost/filesystem.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+namespace fs = boost::filesystem;
+
+/// One #include directive found by the lexical scan
+struct include_directive {
+    std::string name;     // As spelled, without quotes or brackets
+    bool angled = false;  // <name> rather than "name"
+};
+
+/// Extract #include directives from source text without preprocessing
+/// Comments are skipped; conditional blocks are not evaluated, so every
+/// include in the file is reported (an over-approximation)
+std::vector<include_directive> scan_includes(std::string_view source);
+
+/// Which project files include which, from a fast lexical scan
+/// Only edges between the scanned files are kept. A directive resolves
+/// the way a compiler would (quoted: the including file's directory,
+/// then the include paths); names the include paths cannot place fall
+/// back to every scanned file whose path ends in the spelled name, so
+/// the graph errs on the side of extra edges rather than missing ones.
+class include_graph {
+public:
+    /// Scan files and resolve their includes against include_paths
+    static include_graph build(
+        const std::vector<fs::path>& files,
+        const std::vector<fs::path>& include_paths
+    );
+
+    /// Files that are in `changed` or transitively include one of them,
+    /// in scan order. A changed path that was not scanned (deleted or
+    /// renamed away) affects the files whose unresolved includes could
+    /// have named it
+    std::vector<fs::path> affected_by(const std::vector<fs::path>& changed) const;
+
+    /// Scanned files directly included by a file
+    std::vector<fs::path> includes(const fs::path& file) const;
+
+    /// Number of scanned files
+    std::size_t size() const { return files_.size(); }
+
+private:
+    std::optional<std::size_t> find(const fs::path& file) const;
+
+    std::vector<fs::path> files_;
+    std::unordered_map<std::string, std::size_t> index_;  // key: normalized absolute path
+    std::vector<std::vector<std::size_t>> includes_;
+    std::vector<std::vector<std::size_t>> included_by_;
+
+    // Includes that matched no scanned file, by the spelled file name:
+    // the normalized spelling and the including file
+    std::unordered_map<std::string, std::vector<std::pair<std::string, std::size_t>>> unresolved_;
+};
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_INTAKE_INCLUDE_GRAPH_HPP
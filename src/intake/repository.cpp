@@ -58,6 +58,17 @@ bool repository::is_cpp_source(const fs::path& file) {
     return cpp_extensions.find(ext) != cpp_extensions.end();
 }
 
+bool repository::is_header(const fs::path& file) {
+    static const std::set<std::string> header_extensions = {
+        ".hpp", ".hxx", ".hh", ".h++", ".h"
+    };
+
+    std::string ext = file.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    return header_extensions.find(ext) != header_extensions.end();
+}
+
 } // namespace intake
 } // namespace safeprofile
 } // namespace boost
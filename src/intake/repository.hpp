@@ -30,6 +30,9 @@ public:
     /// Scan the repository and discover C++ source files
     std::vector<source_file> discover_sources() const;
 
+    /// Check if a file has a C++ header extension
+    static bool is_header(const fs::path& file);
+
     /// Get the repository root path
     const fs::path& root() const { return root_; }
 
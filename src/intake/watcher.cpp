@@ -0,0 +1,196 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "watcher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#define BOOST_SAFEPROFILE_HAS_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+#ifdef BOOST_SAFEPROFILE_HAS_INOTIFY
+
+namespace {
+
+constexpr std::uint32_t watch_mask =
+    IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+} // namespace
+
+tree_watcher::tree_watcher(const fs::path& root) : root_(root) {
+    fd_ = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::string("Cannot watch files: ") + std::strerror(errno));
+    }
+    try {
+        add_tree(root_, nullptr);
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+tree_watcher::~tree_watcher() {
+    ::close(fd_);
+}
+
+void tree_watcher::add_tree(const fs::path& directory, std::set<fs::path>* existing) {
+    int wd = ::inotify_add_watch(fd_, directory.c_str(), watch_mask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            throw std::runtime_error("Too many directories to watch; raise fs.inotify.max_user_watches");
+        }
+        return;  // Removed again before we got to it
+    }
+    directories_[wd] = directory;
+
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (fs::is_directory(it->symlink_status())) {
+            add_tree(it->path(), existing);
+        } else {
+            files_.insert(it->path());
+            if (existing) {
+                existing->insert(it->path());
+            }
+        }
+    }
+}
+
+void tree_watcher::remove_tree(const fs::path& directory, std::set<fs::path>& gone) {
+    auto under = [&](const fs::path& path) {
+        auto mismatch = std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+        return mismatch.first == directory.end();
+    };
+
+    for (auto it = files_.begin(); it != files_.end(); ) {
+        if (under(*it)) {
+            gone.insert(*it);
+            it = files_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // A moved directory keeps its watches, which would report its new
+    // contents under the old paths
+    for (auto it = directories_.begin(); it != directories_.end(); ) {
+        if (under(it->second)) {
+            ::inotify_rm_watch(fd_, it->first);
+            it = directories_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool tree_watcher::read_events(int timeout_ms, std::set<fs::path>& changed) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready < 0 && errno != EINTR) {
+        throw std::runtime_error(std::string("Watching files failed: ") + std::strerror(errno));
+    }
+    if (ready <= 0) {
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        ssize_t got = ::read(fd_, buffer, sizeof(buffer));
+        if (got <= 0) {
+            break;  // EAGAIN: queue drained
+        }
+
+        for (char* p = buffer; p < buffer + got; ) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed_ = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                directories_.erase(event->wd);
+                continue;
+            }
+
+            auto dir = directories_.find(event->wd);
+            if (dir == directories_.end() || event->len == 0) {
+                continue;
+            }
+            fs::path path = dir->second / event->name;
+
+            const bool removed = event->mask & (IN_DELETE | IN_MOVED_FROM);
+            if (event->mask & IN_ISDIR) {
+                if (removed) {
+                    remove_tree(path, changed);  // Its files are gone with it
+                } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    add_tree(path, &changed);  // Its files may predate the watch
+                }
+            } else {
+                if (removed) {
+                    files_.erase(path);
+                } else {
+                    files_.insert(path);
+                }
+                changed.insert(path);
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<fs::path> tree_watcher::wait(std::chrono::milliseconds quiet) {
+    std::set<fs::path> changed;
+    overflowed_ = false;
+
+    while (changed.empty() && !overflowed_) {
+        read_events(-1, changed);
+    }
+    while (read_events(static_cast<int>(quiet.count()), changed)) {
+    }
+
+    if (overflowed_) {
+        return {root_};
+    }
+    return std::vector<fs::path>(changed.begin(), changed.end());
+}
+
+#else
+
+tree_watcher::tree_watcher(const fs::path& root) : root_(root) {
+    throw std::runtime_error("--watch requires Linux (inotify)");
+}
+
+tree_watcher::~tree_watcher() = default;
+
+void tree_watcher::add_tree(const fs::path& /*directory*/, std::set<fs::path>* /*existing*/) {}
+
+void tree_watcher::remove_tree(const fs::path& /*directory*/, std::set<fs::path>& /*gone*/) {}
+
+bool tree_watcher::read_events(int /*timeout_ms*/, std::set<fs::path>& /*changed*/) {
+    return false;
+}
+
+std::vector<fs::path> tree_watcher::wait(std::chrono::milliseconds /*quiet*/) {
+    return {};
+}
+
+#endif
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
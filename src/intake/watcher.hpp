@@ -0,0 +1,64 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_INTAKE_WATCHER_HPP
+#define BOOST_SAFEPROFILE_INTAKE_WATCHER_HPP
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace intake {
+
+namespace fs = boost::filesystem;
+
+/// Change notifications for every file under a directory tree (inotify)
+/// Each directory gets its own watch; directories created later are
+/// picked up as they appear, and the files already inside them count as
+/// changed. Likewise every file of a directory deleted or moved out of
+/// the tree counts as changed. Throws std::runtime_error where inotify is unavailable.
+class tree_watcher {
+public:
+    explicit tree_watcher(const fs::path& root);
+    ~tree_watcher();
+
+    tree_watcher(const tree_watcher&) = delete;
+    tree_watcher& operator=(const tree_watcher&) = delete;
+
+    /// Block until a file changes, then keep collecting until no event has
+    /// arrived for `quiet` (debouncing editors that save in several steps)
+    /// Returns written, created, deleted and renamed paths, sorted and
+    /// unique, spelled under the root as given. If the kernel dropped
+    /// events the result is just the root: anything may have changed.
+    std::vector<fs::path> wait(std::chrono::milliseconds quiet);
+
+    /// Directories being watched
+    std::size_t directories() const { return directories_.size(); }
+
+private:
+    void add_tree(const fs::path& directory, std::set<fs::path>* existing);
+
+    /// Stop watching a directory that is gone; its files go into `gone`
+    void remove_tree(const fs::path& directory, std::set<fs::path>& gone);
+
+    /// Read queued events into `changed`; false if none came within timeout_ms
+    bool read_events(int timeout_ms, std::set<fs::path>& changed);
+
+    fs::path root_;
+    int fd_ = -1;
+    std::unordered_map<int, fs::path> directories_;  // Watch descriptor to directory
+    std::set<fs::path> files_;                       // Files currently in the tree
+    bool overflowed_ = false;
+};
+
+} // namespace intake
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_INTAKE_WATCHER_HPP
@@ -4,15 +4,347 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "cli/arguments.hpp"
+#include "cli/setup.hpp"
 #include "intake/repository.hpp"
 #include "intake/compile_commands.hpp"
+#include "intake/watcher.hpp"
 #include "profile/loader.hpp"
 #include "analysis/detector.hpp"
 #include "analysis/ast_detector.hpp"
+#include "analysis/finding_delta.hpp"
+#include "analysis/result_json.hpp"
 #include "emit/sarif.hpp"
+#include "server/daemon.hpp"
+#include "server/lsp.hpp"
+#include <chrono>
 #include <iostream>
 #include <exception>
 #include <memory>
+#include <vector>
+
+namespace {
+
+/// Convert AST findings to regular findings for compatibility
+std::vector<boost::safeprofile::analysis::finding> to_findings(
+    const std::vector<boost::safeprofile::analysis::ast_finding>& ast_findings
+) {
+    std::vector<boost::safeprofile::analysis::finding> findings;
+    for (const auto& af : ast_findings) {
+        findings.push_back({
+            af.rule_id,
+            af.file,
+            static_cast<int>(af.line),
+            static_cast<int>(af.column),
+            af.snippet,
+            af.severity
+        });
+    }
+    return findings;
+}
+
+/// Print the run summary, failed files and findings, write requested
+/// outputs, and return the process exit code
+int report(
+    const boost::safeprofile::cli::analyze_args& args,
+    const std::vector<boost::safeprofile::profile::rule>& rules,
+    const std::vector<boost::safeprofile::analysis::ast_finding>& ast_findings,
+    const std::vector<boost::safeprofile::analysis::file_analysis_result>& failed_files,
+    const boost::safeprofile::analysis::analysis_statistics& stats
+) {
+    auto findings = to_findings(ast_findings);
+
+    std::cout << "Analysis complete. Found " << findings.size() << " violation(s).\n";
+    std::cout << "(AST-based detection - no false positives in comments/strings)\n";
+    std::cout << "Analyzed " << stats.translation_units << " file(s) in "
+              << stats.wall_seconds << "s on " << stats.workers << " worker(s)"
+              << " (parallel efficiency " << static_cast<int>(stats.parallel_efficiency() * 100.0)
+              << "%, " << stats.steals << " stolen)\n";
+    if (stats.parse_seconds + stats.match_seconds > 0.0) {
+        std::cout << "Clang time: " << stats.parse_seconds << "s parsing, "
+                  << stats.match_seconds << "s matching"
+                  << (args.fast_parse ? " (fast parse)" : "")
+                  << (args.clang_tool ? " (ClangTool batches)" : "")
+                  << (args.traversal_scope ? "" : " (whole-TU traversal)") << "\n";
+    }
+    if (stats.file_cache.lookups > 0) {
+        std::cout << "File cache: " << stats.file_cache.hits << " of "
+                  << stats.file_cache.lookups << " lookups served from memory ("
+                  << static_cast<int>(stats.file_cache.hit_rate() * 100.0) << "% hit rate)\n";
+    }
+    if (stats.cache_hits + stats.cache_misses > 0) {
+        std::cout << "Result cache: " << stats.cache_hits << " hit(s), "
+                  << stats.cache_misses << " miss(es)";
+        if (args.remote_cache) {
+            std::cout << " (shared with " << *args.remote_cache << ")";
+        }
+        std::cout << "\n";
+    }
+    if (stats.lexically_skipped > 0) {
+        std::cout << "Skipped parsing " << stats.lexically_skipped
+                  << " file(s) in which no rule's trigger tokens appear\n";
+    }
+    if (stats.invocation_templates > 0) {
+        std::cout << "Parsed " << stats.invocation_templates << " distinct command line(s) once, "
+                  << stats.invocations_reused << " file(s) reused one\n";
+    }
+    if (stats.umbrella_headers > 0) {
+        std::cout << "Parsed " << stats.umbrella_headers << " header(s) together in umbrella TUs\n";
+    }
+    if (stats.covered_headers > 0) {
+        std::cout << "Skipped " << stats.covered_headers << " header(s) already analyzed via #include ("
+                  << stats.duplicate_findings << " duplicate finding(s) merged)\n";
+    }
+    if (stats.preambles > 0) {
+        std::cout << "Precompiled " << stats.preambles << " shared include prefix(es) used by "
+                  << stats.preamble_tus << " file(s)\n";
+    }
+    std::cout << "\n";
+
+    // Report files that could not be analyzed: compilation failures,
+    // files that hit a resource limit, and crashed/OOM isolated workers
+    std::size_t limited_count = 0;
+    for (const auto& failed : failed_files) {
+        if (failed.failure == boost::safeprofile::analysis::failure_kind::limit_exceeded) {
+            ++limited_count;
+        }
+    }
+
+    if (limited_count > 0) {
+        std::cerr << "⚠️  WARNING: " << limited_count << " file(s) exceeded analysis limits and were skipped:\n";
+        for (const auto& failed : failed_files) {
+            if (failed.failure == boost::safeprofile::analysis::failure_kind::limit_exceeded) {
+                std::cerr << "  " << failed.file.string() << ": " << failed.error_message << "\n";
+            }
+        }
+        std::cerr << "\nNote: Raise --tu-timeout, --max-file-size or --max-ast-size to analyze them.\n\n";
+    }
+
+    if (failed_files.size() > limited_count) {
+        std::cerr << "⚠️  WARNING: " << failed_files.size() - limited_count << " file(s) could not be analyzed:\n";
+        for (const auto& failed : failed_files) {
+            if (failed.failure != boost::safeprofile::analysis::failure_kind::limit_exceeded) {
+                std::cerr << "  " << failed.file.string() << ": " << failed.error_message << "\n";
+            }
+        }
+        std::cerr << "\nNote: Compilation errors prevent AST analysis. ";
+        std::cerr << "Ensure files compile with C++20 or provide compile_commands.json.\n\n";
+    }
+
+    // Files Clang could not parse still get token-level candidates
+    std::vector<boost::filesystem::path> unparsed;
+    for (const auto& failed : failed_files) {
+        if (failed.failure != boost::safeprofile::analysis::failure_kind::limit_exceeded &&
+            failed.failure != boost::safeprofile::analysis::failure_kind::internal_error) {
+            unparsed.push_back(failed.file);
+        }
+    }
+    auto candidates = boost::safeprofile::analysis::detector().analyze(unparsed, rules);
+
+    // Display findings
+    if (!findings.empty()) {
+        std::cout << "Violations:\n";
+        for (const auto& f : findings) {
+            std::cout << "  " << f.file_path.string() << ":" << f.line_number
+                      << ":" << f.column_number << " [" << f.rule_id << "]\n";
+            std::cout << "    " << f.snippet << "\n";
+        }
+        std::cout << "\n";
+    } else {
+        if (failed_files.empty()) {
+            std::cout << "No violations found! ✓\n\n";
+        } else {
+            std::cout << "No violations found in successfully analyzed files.\n";
+            std::cout << "(However, some files failed to compile - see warnings above)\n\n";
+        }
+    }
+
+    if (!candidates.empty()) {
+        std::cout << "Lexical candidates in files that could not be parsed (lower confidence):\n";
+        for (const auto& f : candidates) {
+            std::cout << "  " << f.file_path.string() << ":" << f.line_number
+                      << ":" << f.column_number << " [" << f.rule_id << "]\n";
+            std::cout << "    " << f.snippet << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    // Step 4: Generate SARIF output (if requested)
+    if (args.sarif_output) {
+        std::cout << "Generating SARIF output...\n";
+        boost::safeprofile::emit::sarif_emitter emitter;
+        auto all_findings = findings;
+        all_findings.insert(all_findings.end(), candidates.begin(), candidates.end());
+        auto sarif_doc = emitter.generate(all_findings, rules);
+        emitter.write_to_file(sarif_doc, *args.sarif_output);
+        std::cout << "SARIF written to: " << *args.sarif_output << "\n\n";
+    }
+
+    // Exit codes:
+    // 0 = no violations, all files analyzed successfully
+    // 1 = violations found (but all files analyzed successfully)
+    // 2 = some files failed to compile (partial analysis)
+    if (!failed_files.empty()) {
+        return 2;  // Partial failure - some files couldn't be analyzed
+    }
+    return findings.empty() ? 0 : 1;  // Success or violations
+}
+
+/// --serve: stay resident and answer requests until told to shut down
+int serve(const boost::safeprofile::cli::analyze_args& args) {
+    boost::safeprofile::server::daemon resident(args);
+    std::cout << "Serving analysis requests on " << *args.serve_socket << "\n" << std::flush;
+    resident.run(*args.serve_socket);
+    std::cout << "Shut down.\n";
+    return 0;
+}
+
+/// --lsp: answer an editor on stdin/stdout, which carry nothing else
+int serve_language_server(const boost::safeprofile::cli::analyze_args& args) {
+    std::ios::sync_with_stdio(false);
+    boost::safeprofile::server::language_server server(args);
+    return server.run(std::cin, std::cout);
+}
+
+/// --connect: let a daemon run the analysis, then report as a local run would
+int analyze_remotely(const boost::safeprofile::cli::analyze_args& args) {
+    namespace analysis = boost::safeprofile::analysis;
+
+    std::cout << "=== Boost.SafeProfile Analysis ===\n";
+    std::cout << "Target: " << args.target_path << "\n";
+    std::cout << "Profile: " << args.profile << "\n";
+    std::cout << "Mode: daemon at " << *args.connect_socket << "\n\n";
+
+    auto rules = boost::safeprofile::profile::loader::load_profile(args.profile);
+
+    boost::json::object request;
+    request["command"] = "analyze";
+    request["target"] = boost::filesystem::absolute(args.target_path).string();
+    request["profile"] = args.profile;
+    if (args.since) {
+        request["since"] = *args.since;
+    }
+
+    std::vector<analysis::ast_finding> ast_findings;
+    std::vector<analysis::file_analysis_result> failed_files;
+    auto done = boost::safeprofile::server::send_request(*args.connect_socket, request,
+        [&](const boost::json::object& message) {
+            if (message.at("type").as_string() == "finding") {
+                ast_findings.push_back(analysis::finding_from_json(message));
+            } else if (message.at("type").as_string() == "failure") {
+                failed_files.push_back(analysis::result_from_json(message));
+            }
+        });
+
+    if (done.contains("changed")) {
+        std::cout << done.at("changed").to_number<std::size_t>() << " file(s) changed since "
+                  << *args.since << "; analyzed " << done.at("sources").to_number<std::size_t>()
+                  << " affected file(s)\n";
+    }
+    std::cout << "Daemon re-read " << done.at("refreshed").to_number<std::size_t>()
+              << " file(s) changed on disk since its last run\n";
+
+    auto stats = analysis::statistics_from_json(done.at("statistics"));
+    return report(args, rules, ast_findings, failed_files, stats);
+}
+
+/// --watch: after the first report, re-analyze the files each change
+/// affects and print what changed; runs until interrupted
+[[noreturn]] void watch(
+    const boost::safeprofile::cli::analyze_args& args,
+    boost::safeprofile::analysis::ast_detector& detector,
+    const boost::safeprofile::cli::detector_setup& setup,
+    const std::vector<boost::safeprofile::profile::rule>& rules,
+    std::shared_ptr<boost::safeprofile::intake::compile_commands_reader> compile_db,
+    boost::safeprofile::analysis::tracked_findings& tracked
+) {
+    namespace analysis = boost::safeprofile::analysis;
+    namespace intake = boost::safeprofile::intake;
+    const boost::filesystem::path root(args.target_path);
+
+    intake::tree_watcher watcher(root);
+    std::cout << "Watching " << watcher.directories() << " director(ies) under " << root.string()
+              << " for changes (Ctrl-C to stop)...\n\n" << std::flush;
+
+    for (;;) {
+        auto changed = watcher.wait(std::chrono::milliseconds(args.debounce_ms));
+
+        // Lost events or new compiler flags: everything may be affected
+        bool everything = changed.size() == 1 && changed.front() == root;
+        for (const auto& path : changed) {
+            if (path.filename() == "compile_commands.json") {
+                everything = true;
+            }
+        }
+        if (everything) {
+            compile_db = boost::safeprofile::cli::use_compilation_database(detector, root);
+        }
+        detector.refresh_file_cache();
+
+        intake::repository repo(root);
+        auto sources = repo.discover_sources();
+        std::vector<boost::filesystem::path> deleted;
+        if (!everything) {
+            boost::safeprofile::cli::narrow_to_affected(sources, root, changed, compile_db.get());
+            for (const auto& path : changed) {
+                if (!boost::filesystem::exists(path)) {
+                    deleted.push_back(path);
+                }
+            }
+            if (sources.empty() && deleted.empty()) {
+                continue;  // Nothing the analysis reads
+            }
+        }
+
+        std::vector<boost::filesystem::path> file_paths;
+        for (const auto& src : sources) {
+            file_paths.push_back(src.path);
+        }
+
+        std::vector<analysis::file_analysis_result> failed_files;
+        analysis::analysis_statistics stats;
+        std::vector<analysis::ast_finding> ast_findings;
+        if (!file_paths.empty()) {
+            ast_findings = detector.analyze_files(file_paths, rules, failed_files, &stats);
+        }
+        if (setup.history) {
+            setup.history->save(*setup.history_file);
+        }
+
+        std::vector<boost::filesystem::path> scope = file_paths;
+        scope.insert(scope.end(), deleted.begin(), deleted.end());
+        auto delta = everything
+            ? tracked.replace(std::move(ast_findings), std::move(failed_files))
+            : tracked.update(scope, std::move(ast_findings), std::move(failed_files));
+
+        std::cout << changed.size() << " file(s) changed; re-analyzed " << file_paths.size()
+                  << " file(s) in " << stats.wall_seconds << "s: " << delta.added.size()
+                  << " new, " << delta.resolved.size() << " resolved violation(s)\n";
+        for (const auto& f : delta.added) {
+            std::cout << "  + " << f.file.string() << ":" << f.line << ":" << f.column
+                      << " [" << f.rule_id << "]\n";
+            std::cout << "      " << f.snippet << "\n";
+        }
+        for (const auto& f : delta.resolved) {
+            std::cout << "  - " << f.file.string() << ":" << f.line << ":" << f.column
+                      << " [" << f.rule_id << "]\n";
+        }
+        for (const auto& failed : delta.failed) {
+            std::cerr << "  ! " << failed.file.string() << ": " << failed.error_message << "\n";
+        }
+        for (const auto& path : delta.recovered) {
+            std::cout << "  ✓ " << path.string() << " no longer fails\n";
+        }
+        std::cout << "Now " << tracked.findings().size() << " violation(s), "
+                  << tracked.failures().size() << " file(s) not analyzed\n\n" << std::flush;
+
+        if (args.sarif_output && !delta.empty()) {
+            boost::safeprofile::emit::sarif_emitter emitter;
+            emitter.write_to_file(emitter.generate(to_findings(tracked.findings()), rules), *args.sarif_output);
+        }
+    }
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
     try {
@@ -23,6 +355,16 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
+        if (args->lsp) {
+            return serve_language_server(*args);
+        }
+        if (args->serve_socket) {
+            return serve(*args);
+        }
+        if (args->connect_socket) {
+            return analyze_remotely(*args);
+        }
+
         std::cout << "=== Boost.SafeProfile Analysis ===\n";
         std::cout << "Target: " << args->target_path << "\n";
         std::cout << "Profile: " << args->profile << "\n";
@@ -49,94 +391,45 @@ int main(int argc, char* argv[]) {
         }
         std::cout << "\n";
 
-        // Step 2.5: Try to load compile_commands.json (optional)
-        auto compile_db = std::make_shared<boost::safeprofile::intake::compile_commands_reader>();
-        if (compile_db->load_from_directory(args->target_path)) {
-            std::cout << "Loaded compile_commands.json (" << compile_db->entry_count() << " entries)\n";
+        // Step 2.5: Try to load compile_commands.json (optional); without
+        // one, include paths are inferred from the analyzed directory
+        boost::safeprofile::analysis::ast_detector ast_det;
+        auto setup = boost::safeprofile::cli::configure_detector(ast_det, *args);
+        boost::safeprofile::cli::inferred_include_paths inferred;
+        auto compile_db = boost::safeprofile::cli::use_compilation_database(
+            ast_det, args->target_path, &inferred);
+        if (compile_db) {
+            std::cout << "Loaded compile_commands.json (" << compile_db->entry_count() << " entries"
+                      << (compile_db->loaded_from_index() ? ", from index" : "") << ")\n";
             std::cout << "Using compilation database for include paths and flags.\n\n";
         } else {
             std::cout << "No compile_commands.json found - using default C++20 flags.\n";
             std::cout << "(Tip: Generate with 'cmake -DCMAKE_EXPORT_COMPILE_COMMANDS=ON' for better results)\n\n";
-        }
-
-        // Step 3: Run analysis (using AST-based detector)
-        std::cout << "Running AST-based analysis...\n";
-        boost::safeprofile::analysis::ast_detector ast_det;
-
-        // Set compilation database if loaded
-        if (compile_db->is_loaded()) {
-            ast_det.set_compilation_database(compile_db);
-        } else {
-            // No compilation database - infer include paths from analyzed directory
-            // This helps analyze projects without needing a full build
-            std::vector<std::string> inferred_includes;
-
-            // Add the target directory itself (for relative includes)
-            boost::filesystem::path target_abs = boost::filesystem::absolute(args->target_path);
-            inferred_includes.push_back(target_abs.string());
-
-            // If analyzing within an 'include/' directory, also add parent
-            // (supports common pattern: boost-json/include/boost/json/...)
-            if (target_abs.filename() == "include") {
-                inferred_includes.push_back(target_abs.parent_path().string());
-            }
-            // If inside a subdirectory of 'include/', add the include root
-            else {
-                auto parent = target_abs.parent_path();
-                while (!parent.empty() && parent != parent.parent_path()) {
-                    if (parent.filename() == "include") {
-                        inferred_includes.push_back(parent.string());
-                        break;
-                    }
-                    parent = parent.parent_path();
+            if (!inferred.paths.empty()) {
+                std::cout << "Inferred include path(s):\n";
+                if (!inferred.boost_root.empty()) {
+                    std::cout << "  Found Boost headers at: " << inferred.boost_root.string() << "\n";
                 }
+                std::cout << "  Total: " << inferred.paths.size() << " include path(s)\n\n";
             }
+        }
 
-            // Auto-detect Boost headers (for analyzing Boost libraries)
-            // Check common system install locations
-            std::vector<boost::filesystem::path> boost_search_paths = {
-                "/opt/homebrew/include",               // macOS Homebrew
-                "/usr/local/include",                  // Standard Unix/Linux
-                "/usr/include",                        // Debian/Ubuntu
-                boost::filesystem::path(getenv("HOME") ? getenv("HOME") : "") / ".local/include"  // User install
-            };
-
-            boost::filesystem::path boost_root;
-            for (const auto& search_path : boost_search_paths) {
-                if (boost::filesystem::exists(search_path / "boost" / "config.hpp")) {
-                    // System install (boost/ directory at root)
-                    boost_root = search_path;
-                    inferred_includes.push_back(boost_root.string());
-                    break;
-                } else if (boost::filesystem::exists(search_path / "libs" / "config" / "include" / "boost" / "config.hpp")) {
-                    // Boost super-project layout (libs/*/include/)
-                    boost_root = search_path;
-                    // Add all libs/*/include directories
-                    if (boost::filesystem::exists(boost_root / "libs")) {
-                        boost::filesystem::directory_iterator end_iter;
-                        for (boost::filesystem::directory_iterator lib_iter(boost_root / "libs"); lib_iter != end_iter; ++lib_iter) {
-                            if (boost::filesystem::is_directory(lib_iter->status())) {
-                                auto include_dir = lib_iter->path() / "include";
-                                if (boost::filesystem::exists(include_dir)) {
-                                    inferred_includes.push_back(include_dir.string());
-                                }
-                            }
-                        }
-                    }
-                    break;
-                }
-            }
+        // Step 2.6: Narrow to files affected by changes since a git revision
+        if (args->since) {
+            auto changed = boost::safeprofile::cli::narrow_to_changes(
+                sources, args->target_path, *args->since, compile_db.get());
 
-            if (!inferred_includes.empty()) {
-                ast_det.set_additional_include_paths(inferred_includes);
-                std::cout << "Inferred include path(s):\n";
-                if (!boost_root.empty()) {
-                    std::cout << "  Found Boost headers at: " << boost_root.string() << "\n";
-                }
-                std::cout << "  Total: " << inferred_includes.size() << " include path(s)\n\n";
+            std::cout << changed << " file(s) changed since " << *args->since << "; analyzing "
+                      << sources.size() << " affected file(s):\n";
+            for (const auto& src : sources) {
+                std::cout << "  " << src.path.string() << "\n";
             }
+            std::cout << "\n";
         }
 
+        // Step 3: Run analysis (using AST-based detector)
+        std::cout << "Running AST-based analysis (" << ast_det.effective_jobs() << " job(s))...\n";
+
         // Extract file paths from sources
         std::vector<boost::filesystem::path> file_paths;
         for (const auto& src : sources) {
@@ -144,69 +437,21 @@ int main(int argc, char* argv[]) {
         }
 
         std::vector<boost::safeprofile::analysis::file_analysis_result> failed_files;
-        auto ast_findings = ast_det.analyze_files(file_paths, rules, failed_files);
-
-        // Convert AST findings to regular findings for compatibility
-        std::vector<boost::safeprofile::analysis::finding> findings;
-        for (const auto& af : ast_findings) {
-            findings.push_back({
-                af.rule_id,
-                af.file,
-                static_cast<int>(af.line),
-                static_cast<int>(af.column),
-                af.snippet,
-                af.severity
-            });
-        }
-
-        std::cout << "Analysis complete. Found " << findings.size() << " violation(s).\n";
-        std::cout << "(AST-based detection - no false positives in comments/strings)\n\n";
-
-        // Report compilation failures
-        if (!failed_files.empty()) {
-            std::cerr << "⚠️  WARNING: " << failed_files.size() << " file(s) failed to compile and were not analyzed:\n";
-            for (const auto& failed : failed_files) {
-                std::cerr << "  " << failed.file.string() << ": " << failed.error_message << "\n";
-            }
-            std::cerr << "\nNote: Compilation errors prevent AST analysis. ";
-            std::cerr << "Ensure files compile with C++20 or provide compile_commands.json.\n\n";
-        }
+        boost::safeprofile::analysis::analysis_statistics stats;
+        auto ast_findings = ast_det.analyze_files(file_paths, rules, failed_files, &stats);
 
-        // Display findings
-        if (!findings.empty()) {
-            std::cout << "Violations:\n";
-            for (const auto& f : findings) {
-                std::cout << "  " << f.file_path.string() << ":" << f.line_number
-                          << ":" << f.column_number << " [" << f.rule_id << "]\n";
-                std::cout << "    " << f.snippet << "\n";
-            }
-            std::cout << "\n";
-        } else {
-            if (failed_files.empty()) {
-                std::cout << "No violations found! ✓\n\n";
-            } else {
-                std::cout << "No violations found in successfully analyzed files.\n";
-                std::cout << "(However, some files failed to compile - see warnings above)\n\n";
-            }
+        if (setup.history) {
+            setup.history->save(*setup.history_file);
         }
 
-        // Step 4: Generate SARIF output (if requested)
-        if (args->sarif_output) {
-            std::cout << "Generating SARIF output...\n";
-            boost::safeprofile::emit::sarif_emitter emitter;
-            auto sarif_doc = emitter.generate(findings, rules);
-            emitter.write_to_file(sarif_doc, *args->sarif_output);
-            std::cout << "SARIF written to: " << *args->sarif_output << "\n\n";
+        int status = report(*args, rules, ast_findings, failed_files, stats);
+        if (!args->watch) {
+            return status;
         }
 
-        // Exit codes:
-        // 0 = no violations, all files analyzed successfully
-        // 1 = violations found (but all files analyzed successfully)
-        // 2 = some files failed to compile (partial analysis)
-        if (!failed_files.empty()) {
-            return 2;  // Partial failure - some files couldn't be analyzed
-        }
-        return findings.empty() ? 0 : 1;  // Success or violations
+        boost::safeprofile::analysis::tracked_findings tracked;
+        tracked.replace(std::move(ast_findings), std::move(failed_files));
+        watch(*args, ast_det, setup, rules, compile_db, tracked);
 
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
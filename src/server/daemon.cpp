@@ -0,0 +1,257 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "daemon.hpp"
+#include "cli/setup.hpp"
+#include "analysis/ast_detector.hpp"
+#include "analysis/result_json.hpp"
+#include "intake/compile_commands.hpp"
+#include "intake/repository.hpp"
+#include "profile/loader.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace server {
+
+using stream_protocol = boost::asio::local::stream_protocol;
+
+namespace {
+
+std::string string_at(const json::object& obj, json::string_view key) {
+    return std::string(obj.at(key).as_string().c_str());
+}
+
+/// Read one '\n'-terminated line; false at end of stream
+bool read_line(stream_protocol::socket& socket, std::string& buffer, std::string& line) {
+    boost::system::error_code ec;
+    std::size_t length = boost::asio::read_until(socket, boost::asio::dynamic_buffer(buffer), '\n', ec);
+    if (ec) {
+        return false;
+    }
+    line = buffer.substr(0, length - 1);
+    buffer.erase(0, length);
+    return true;
+}
+
+void write_line(stream_protocol::socket& socket, const json::object& message) {
+    std::string line = json::serialize(message) + "\n";
+    boost::asio::write(socket, boost::asio::buffer(line));
+}
+
+} // namespace
+
+/// Warm state for one (target, profile) pair
+struct daemon::workspace {
+    fs::path target;
+    std::vector<profile::rule> rules;
+    analysis::ast_detector detector;
+    cli::detector_setup setup;
+    std::shared_ptr<intake::compile_commands_reader> compile_db;
+    bool database_checked = false;
+    std::time_t database_written = 0;  // compile_commands.json mtime, 0 if absent
+};
+
+daemon::daemon(cli::analyze_args defaults) : defaults_(std::move(defaults)) {}
+
+daemon::~daemon() = default;
+
+daemon::workspace& daemon::workspace_for(const fs::path& target, const std::string& profile_name) {
+    auto& slot = workspaces_[{target.string(), profile_name}];
+    if (!slot) {
+        auto args = defaults_;
+        args.target_path = target.string();
+        args.profile = profile_name;
+
+        auto ws = std::make_unique<workspace>();
+        ws->target = target;
+        ws->rules = profile::loader::load_profile(profile_name);
+        ws->setup = cli::configure_detector(ws->detector, args);
+        slot = std::move(ws);
+    }
+
+    // Pick up a regenerated (or newly created, or deleted) compilation database
+    workspace& ws = *slot;
+    boost::system::error_code ec;
+    std::time_t written = fs::last_write_time(ws.target / "compile_commands.json", ec);
+    if (ec) {
+        written = 0;
+    }
+    if (!ws.database_checked || written != ws.database_written) {
+        ws.compile_db = cli::use_compilation_database(ws.detector, ws.target);
+        ws.database_checked = true;
+        ws.database_written = written;
+    }
+    return ws;
+}
+
+bool daemon::handle(const std::string& line, const std::function<void(const json::object&)>& emit) {
+    ++requests_;
+    try {
+        json::value value = json::parse(line);
+        const auto& request = value.as_object();
+        std::string command = string_at(request, "command");
+
+        if (command == "analyze") {
+            analyze(request, emit);
+        } else if (command == "status") {
+            json::array targets;
+            for (const auto& entry : workspaces_) {
+                targets.push_back(json::object{{"target", entry.first.first}, {"profile", entry.first.second}});
+            }
+            json::object done;
+            done["type"] = "done";
+            done["workspaces"] = std::move(targets);
+            done["requests"] = requests_;
+            emit(done);
+        } else if (command == "shutdown") {
+            emit(json::object{{"type", "done"}});
+            return false;
+        } else {
+            throw std::runtime_error("Unknown command: " + command);
+        }
+    } catch (const std::exception& e) {
+        json::object error;
+        error["type"] = "error";
+        error["message"] = e.what();
+        emit(error);
+    }
+    return true;
+}
+
+void daemon::analyze(const json::object& request, const std::function<void(const json::object&)>& emit) {
+    fs::path target = fs::absolute(string_at(request, "target")).lexically_normal();
+    if (!fs::exists(target)) {
+        throw std::runtime_error("Target does not exist: " + target.string());
+    }
+    std::string profile_name = request.contains("profile") ? string_at(request, "profile") : defaults_.profile;
+
+    workspace& ws = workspace_for(target, profile_name);
+    auto refreshed = ws.detector.refresh_file_cache();
+
+    intake::repository repo(target);
+    auto sources = repo.discover_sources();
+    std::optional<std::size_t> changed;
+    if (request.contains("since")) {
+        changed = cli::narrow_to_changes(sources, target, string_at(request, "since"), ws.compile_db.get());
+    }
+
+    std::vector<fs::path> file_paths;
+    for (const auto& src : sources) {
+        file_paths.push_back(src.path);
+    }
+
+    std::vector<analysis::file_analysis_result> failed_files;
+    analysis::analysis_statistics stats;
+    auto findings = ws.detector.analyze_files(file_paths, ws.rules, failed_files, &stats);
+    if (ws.setup.history) {
+        ws.setup.history->save(*ws.setup.history_file);
+    }
+
+    std::cout << "analyze " << target.string() << " [" << profile_name << "]: "
+              << findings.size() << " finding(s), " << failed_files.size() << " failure(s) in "
+              << stats.wall_seconds << "s (" << refreshed.size() << " file(s) changed on disk)\n"
+              << std::flush;
+
+    for (const auto& finding : findings) {
+        auto message = analysis::to_json(finding);
+        message["type"] = "finding";
+        emit(message);
+    }
+    for (const auto& failed : failed_files) {
+        auto message = analysis::to_json(failed);
+        message["type"] = "failure";
+        emit(message);
+    }
+
+    json::object done;
+    done["type"] = "done";
+    done["sources"] = file_paths.size();
+    done["refreshed"] = refreshed.size();
+    if (changed) {
+        done["changed"] = *changed;
+    }
+    done["statistics"] = analysis::to_json(stats);
+    emit(done);
+}
+
+void daemon::run(const fs::path& socket_path) {
+    boost::asio::io_context io;
+    stream_protocol::endpoint endpoint(socket_path.string());
+
+    // A socket file nobody accepts on is left over from a daemon that died
+    boost::system::error_code ec;
+    if (fs::exists(socket_path, ec)) {
+        stream_protocol::socket probe(io);
+        probe.connect(endpoint, ec);
+        if (!ec) {
+            throw std::runtime_error("A daemon is already listening on " + socket_path.string());
+        }
+        fs::remove(socket_path);
+    }
+
+    stream_protocol::acceptor acceptor(io, endpoint);
+    bool serving = true;
+    while (serving) {
+        stream_protocol::socket socket(io);
+        acceptor.accept(socket);
+
+        try {
+            std::string buffer;
+            std::string line;
+            while (serving && read_line(socket, buffer, line)) {
+                serving = handle(line, [&](const json::object& message) { write_line(socket, message); });
+            }
+        } catch (const std::exception& e) {
+            // The client went away mid-answer; the next one is unaffected
+            std::cerr << "Connection dropped: " << e.what() << "\n";
+        }
+    }
+
+    acceptor.close();
+    fs::remove(socket_path, ec);
+}
+
+json::object send_request(
+    const fs::path& socket_path,
+    const json::object& request,
+    const std::function<void(const json::object&)>& on_message
+) {
+    boost::asio::io_context io;
+    stream_protocol::socket socket(io);
+    boost::system::error_code ec;
+    socket.connect(stream_protocol::endpoint(socket_path.string()), ec);
+    if (ec) {
+        throw std::runtime_error("Cannot reach a daemon at " + socket_path.string() + ": " + ec.message());
+    }
+    write_line(socket, request);
+
+    std::string buffer;
+    std::string line;
+    while (read_line(socket, buffer, line)) {
+        json::value value = json::parse(line);
+        auto& message = value.as_object();
+        std::string type = string_at(message, "type");
+        if (type == "done") {
+            return message;
+        }
+        if (type == "error") {
+            throw std::runtime_error(string_at(message, "message"));
+        }
+        on_message(message);
+    }
+    throw std::runtime_error("Daemon closed the connection before answering");
+}
+
+} // namespace server
+} // namespace safeprofile
+} // namespace boost
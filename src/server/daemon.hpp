@@ -0,0 +1,83 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_SERVER_DAEMON_HPP
+#define BOOST_SAFEPROFILE_SERVER_DAEMON_HPP
+
+#include "cli/arguments.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/json.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace boost {
+namespace safeprofile {
+namespace server {
+
+namespace fs = boost::filesystem;
+namespace json = boost::json;
+
+/// Long-lived analysis process answering requests on a Unix domain socket
+///
+/// Requests and responses are JSON objects, one per line. Every request is
+/// answered by zero or more message lines and then exactly one line of
+/// type "done" or "error":
+///   {"command":"analyze","target":"/abs/dir","profile":"core-safety","since":"main"}
+///     -> {"type":"finding",...} per finding, {"type":"failure",...} per file
+///        that could not be analyzed, then {"type":"done","statistics":{...}}
+///   {"command":"status"}   -> {"type":"done","workspaces":[...],"requests":N}
+///   {"command":"shutdown"} -> {"type":"done"}, then the daemon exits
+/// "profile" and "since" are optional.
+///
+/// Each (target, profile) pair gets a workspace that lives as long as the
+/// daemon: its detector keeps the file cache, the precompiled include
+/// prefixes and the result cache warm, so a request after a small edit only
+/// re-stats files and re-parses the TUs that changed. compile_commands.json
+/// is reloaded when it changes. Connections are served one at a time; a
+/// client waits while another one's analysis runs.
+class daemon {
+public:
+    /// `defaults` supplies every option a request does not carry
+    explicit daemon(cli::analyze_args defaults);
+    ~daemon();
+
+    /// Accept connections on `socket_path` until a shutdown request
+    /// A stale socket file is replaced; throws std::runtime_error if another
+    /// process is already listening on it
+    void run(const fs::path& socket_path);
+
+    /// Answer one request line, passing each response line to `emit`
+    /// Returns false once a shutdown was requested
+    bool handle(const std::string& line, const std::function<void(const json::object&)>& emit);
+
+private:
+    struct workspace;
+
+    workspace& workspace_for(const fs::path& target, const std::string& profile_name);
+    void analyze(const json::object& request, const std::function<void(const json::object&)>& emit);
+
+    cli::analyze_args defaults_;
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<workspace>> workspaces_;
+    std::size_t requests_ = 0;
+};
+
+/// Send one request to a daemon listening on `socket_path`
+/// Calls `on_message` for each line before the final one and returns the
+/// final "done" line; throws std::runtime_error if the daemon answers with
+/// an error or cannot be reached
+json::object send_request(
+    const fs::path& socket_path,
+    const json::object& request,
+    const std::function<void(const json::object&)>& on_message
+);
+
+} // namespace server
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_SERVER_DAEMON_HPP
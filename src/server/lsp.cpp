@@ -0,0 +1,397 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "lsp.hpp"
+#include "cli/setup.hpp"
+#include "analysis/ast_detector.hpp"
+#include "profile/loader.hpp"
+#include <boost/safeprofile/version.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace boost {
+namespace safeprofile {
+namespace server {
+
+namespace {
+
+// JSON-RPC error codes
+constexpr int parse_error = -32700;
+constexpr int method_not_found = -32601;
+constexpr int invalid_params = -32602;
+
+std::string string_at(const json::object& obj, json::string_view key) {
+    return std::string(obj.at(key).as_string().c_str());
+}
+
+bool iequals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+std::string percent_decode(const std::string& text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size()) {
+            int high = hex_value(text[i + 1]);
+            int low = hex_value(text[i + 2]);
+            if (high >= 0 && low >= 0) {
+                decoded += static_cast<char>(high * 16 + low);
+                i += 2;
+                continue;
+            }
+        }
+        decoded += text[i];
+    }
+    return decoded;
+}
+
+int diagnostic_severity(profile::severity level) {
+    switch (level) {
+        case profile::severity::blocker: return 1;  // Error
+        case profile::severity::major: return 2;    // Warning
+        case profile::severity::minor: return 3;    // Information
+        case profile::severity::info: return 4;     // Hint
+    }
+    return 2;
+}
+
+json::object position(std::int64_t line, std::int64_t character) {
+    return json::object{{"line", line}, {"character", character}};
+}
+
+json::object to_diagnostic(const analysis::ast_finding& finding) {
+    // Findings are 1-based; LSP positions are 0-based. The range covers the
+    // first line of the snippet, which starts at the finding's column.
+    std::int64_t line = finding.line > 0 ? finding.line - 1 : 0;
+    std::int64_t column = finding.column > 0 ? finding.column - 1 : 0;
+    auto length = static_cast<std::int64_t>(finding.snippet.substr(0, finding.snippet.find('\n')).size());
+
+    json::object diagnostic;
+    diagnostic["range"] = json::object{
+        {"start", position(line, column)},
+        {"end", position(line, column + std::max<std::int64_t>(length, 1))}
+    };
+    diagnostic["severity"] = diagnostic_severity(finding.severity);
+    diagnostic["code"] = finding.rule_id;
+    diagnostic["source"] = "boost-safeprofile";
+    diagnostic["message"] = finding.message;
+    return diagnostic;
+}
+
+json::object notification(const char* method, json::object params) {
+    json::object message;
+    message["jsonrpc"] = "2.0";
+    message["method"] = method;
+    message["params"] = std::move(params);
+    return message;
+}
+
+json::object diagnostics_for(const std::string& uri, json::array diagnostics) {
+    json::object params;
+    params["uri"] = uri;
+    params["diagnostics"] = std::move(diagnostics);
+    return notification("textDocument/publishDiagnostics", std::move(params));
+}
+
+} // namespace
+
+std::optional<std::string> read_message(std::istream& in) {
+    std::optional<std::size_t> length;
+    std::string line;
+    for (;;) {
+        if (!std::getline(in, line)) {
+            return std::nullopt;
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            if (length) {
+                break;  // End of the header block
+            }
+            continue;
+        }
+
+        auto colon = line.find(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error("Malformed message header: " + line);
+        }
+        if (iequals(line.substr(0, colon), "Content-Length")) {
+            const char* value = line.c_str() + colon + 1;
+            char* end = nullptr;
+            unsigned long long parsed = std::strtoull(value, &end, 10);
+            if (end == value) {
+                throw std::runtime_error("Malformed Content-Length: " + line);
+            }
+            length = static_cast<std::size_t>(parsed);
+        }
+    }
+
+    std::string body(*length, '\0');
+    if (!in.read(body.data(), static_cast<std::streamsize>(body.size()))) {
+        return std::nullopt;
+    }
+    return body;
+}
+
+void write_message(std::ostream& out, const json::object& message) {
+    std::string body = json::serialize(message);
+    out << "Content-Length: " << body.size() << "\r\n\r\n" << body << std::flush;
+}
+
+fs::path path_from_uri(const std::string& uri) {
+    static const std::string scheme = "file://";
+    if (uri.compare(0, scheme.size(), scheme) != 0) {
+        throw std::runtime_error("Not a file URI: " + uri);
+    }
+
+    // file://host/path; the host is empty or "localhost" for local files
+    std::string rest = uri.substr(scheme.size());
+    auto slash = rest.find('/');
+    std::string path = percent_decode(slash == std::string::npos ? std::string() : rest.substr(slash));
+
+    // file:///C:/dir names a drive on Windows
+    if (path.size() >= 3 && path[0] == '/' && path[2] == ':' && std::isalpha(static_cast<unsigned char>(path[1]))) {
+        path.erase(0, 1);
+    }
+    return fs::path(path);
+}
+
+std::string uri_from_path(const fs::path& path) {
+    static const char* digits = "0123456789ABCDEF";
+    std::string generic = path.generic_string();
+    if (!generic.empty() && generic[0] != '/') {
+        generic.insert(0, 1, '/');  // C:/dir
+    }
+
+    std::string uri = "file://";
+    for (char c : generic) {
+        auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || c == '/' || c == '-' || c == '.' || c == '_' || c == '~' || c == ':') {
+            uri += c;
+        } else {
+            uri += '%';
+            uri += digits[byte >> 4];
+            uri += digits[byte & 0xF];
+        }
+    }
+    return uri;
+}
+
+/// An open editor buffer
+struct language_server::document {
+    fs::path path;
+    std::string text;
+    std::int64_t version = 0;
+    analysis::buffer_preamble preamble;
+};
+
+/// Detector configured for the client's workspace root
+struct language_server::workspace {
+    fs::path root;
+    analysis::ast_detector detector;
+    std::unique_ptr<analysis::matcher_set> matchers;
+    cli::detector_setup setup;
+};
+
+language_server::language_server(cli::analyze_args defaults) : defaults_(std::move(defaults)) {}
+
+language_server::~language_server() = default;
+
+void language_server::initialize(const json::object& params) {
+    fs::path root;
+    if (params.contains("rootUri") && params.at("rootUri").is_string()) {
+        root = path_from_uri(string_at(params, "rootUri"));
+    } else if (params.contains("rootPath") && params.at("rootPath").is_string()) {
+        root = string_at(params, "rootPath");
+    } else if (!defaults_.target_path.empty()) {
+        root = defaults_.target_path;
+    } else {
+        root = fs::current_path();
+    }
+
+    auto args = defaults_;
+    args.target_path = root.string();
+
+    auto ws = std::make_unique<workspace>();
+    ws->root = fs::absolute(root).lexically_normal();
+    ws->setup = cli::configure_detector(ws->detector, args);
+    cli::use_compilation_database(ws->detector, ws->root);
+    ws->matchers = std::make_unique<analysis::matcher_set>(
+        profile::loader::load_profile(args.profile),
+        analysis::match_scope::main_file,
+        args.match_instantiations ? analysis::match_traversal::all_nodes : analysis::match_traversal::as_spelled);
+    workspace_ = std::move(ws);
+}
+
+json::object language_server::publish(const std::string& uri, document& doc) {
+    if (!workspace_) {
+        initialize(json::object());  // Client skipped "initialize"
+    }
+
+    auto result = workspace_->detector.analyze_buffer(doc.path, doc.text, *workspace_->matchers, doc.preamble);
+
+    json::array diagnostics;
+    if (result.success) {
+        for (const auto& finding : result.findings) {
+            diagnostics.push_back(to_diagnostic(finding));
+        }
+    } else {
+        json::object diagnostic;
+        diagnostic["range"] = json::object{{"start", position(0, 0)}, {"end", position(0, 0)}};
+        diagnostic["severity"] = 2;
+        diagnostic["source"] = "boost-safeprofile";
+        diagnostic["message"] = "Not checked against the profile: " + result.error_message;
+        diagnostics.push_back(std::move(diagnostic));
+    }
+
+    auto message = diagnostics_for(uri, std::move(diagnostics));
+    message["params"].as_object()["version"] = doc.version;
+    return message;
+}
+
+void language_server::handle(const json::object& message, std::vector<json::object>& outgoing) {
+    std::string method = message.contains("method") && message.at("method").is_string()
+        ? string_at(message, "method") : std::string();
+    const json::value* id = message.if_contains("id");
+
+    auto respond = [&](json::value result) {
+        json::object response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = *id;
+        response["result"] = std::move(result);
+        outgoing.push_back(std::move(response));
+    };
+    auto fail = [&](int code, const std::string& text) {
+        json::object response;
+        response["jsonrpc"] = "2.0";
+        response["id"] = *id;
+        response["error"] = json::object{{"code", code}, {"message", text}};
+        outgoing.push_back(std::move(response));
+    };
+
+    static const json::object no_params;
+    const json::value* params_value = message.if_contains("params");
+    const json::object& params = params_value && params_value->is_object() ? params_value->as_object() : no_params;
+
+    try {
+        if (method == "initialize") {
+            initialize(params);
+
+            json::object sync;
+            sync["openClose"] = true;
+            sync["change"] = 1;  // Full text on every change
+            sync["save"] = true;
+            json::object result;
+            result["capabilities"] = json::object{{"textDocumentSync", std::move(sync)}};
+            result["serverInfo"] = json::object{{"name", "boost-safeprofile"}, {"version", version::string}};
+            respond(std::move(result));
+        } else if (method == "shutdown") {
+            shutdown_ = true;
+            respond(nullptr);
+        } else if (method == "exit") {
+            exited_ = true;
+        } else if (method == "textDocument/didOpen") {
+            const auto& item = params.at("textDocument").as_object();
+            std::string uri = string_at(item, "uri");
+
+            auto doc = std::make_unique<document>();
+            doc->path = path_from_uri(uri);
+            doc->text = string_at(item, "text");
+            doc->version = item.at("version").to_number<std::int64_t>();
+            outgoing.push_back(publish(uri, *doc));
+            documents_[uri] = std::move(doc);
+        } else if (method == "textDocument/didChange") {
+            const auto& item = params.at("textDocument").as_object();
+            auto it = documents_.find(string_at(item, "uri"));
+            const auto& changes = params.at("contentChanges").as_array();
+            if (it != documents_.end() && !changes.empty()) {
+                // Full sync: the last change carries the whole text
+                it->second->text = string_at(changes.back().as_object(), "text");
+                if (item.contains("version") && !item.at("version").is_null()) {
+                    it->second->version = item.at("version").to_number<std::int64_t>();
+                }
+                outgoing.push_back(publish(it->first, *it->second));
+            }
+        } else if (method == "textDocument/didSave") {
+            // Headers other documents include may have changed on disk
+            if (workspace_) {
+                workspace_->detector.refresh_file_cache();
+            }
+            auto it = documents_.find(string_at(params.at("textDocument").as_object(), "uri"));
+            if (it != documents_.end()) {
+                outgoing.push_back(publish(it->first, *it->second));
+            }
+        } else if (method == "textDocument/didClose") {
+            std::string uri = string_at(params.at("textDocument").as_object(), "uri");
+            documents_.erase(uri);
+            outgoing.push_back(diagnostics_for(uri, json::array()));
+        } else if (id && !method.empty()) {
+            fail(method_not_found, "Unsupported method: " + method);
+        }
+        // Other notifications ("initialized", "$/..." and so on) need no answer
+    } catch (const std::exception& e) {
+        if (id) {
+            fail(invalid_params, e.what());
+        } else {
+            std::cerr << method << ": " << e.what() << "\n";
+        }
+    }
+}
+
+int language_server::run(std::istream& in, std::ostream& out) {
+    while (!exited_) {
+        auto text = read_message(in);
+        if (!text) {
+            break;
+        }
+
+        std::vector<json::object> outgoing;
+        boost::system::error_code ec;
+        json::value message = json::parse(*text, ec);
+        if (ec || !message.is_object()) {
+            json::object response;
+            response["jsonrpc"] = "2.0";
+            response["id"] = nullptr;
+            response["error"] = json::object{{"code", parse_error}, {"message", "Invalid JSON-RPC message"}};
+            outgoing.push_back(std::move(response));
+        } else {
+            handle(message.as_object(), outgoing);
+        }
+
+        for (const auto& reply : outgoing) {
+            write_message(out, reply);
+        }
+    }
+    return shutdown_ ? 0 : 1;
+}
+
+} // namespace server
+} // namespace safeprofile
+} // namespace boost
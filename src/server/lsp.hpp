@@ -0,0 +1,83 @@
+// Boost.SafeProfile - C++ Safety Profile conformance analysis tool
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_SAFEPROFILE_SERVER_LSP_HPP
+#define BOOST_SAFEPROFILE_SERVER_LSP_HPP
+
+#include "cli/arguments.hpp"
+#include <boost/filesystem.hpp>
+#include <boost/json.hpp>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace safeprofile {
+namespace server {
+
+namespace fs = boost::filesystem;
+namespace json = boost::json;
+
+/// Read one JSON-RPC message framed with a Content-Length header
+/// Returns nullopt at end of stream; throws std::runtime_error on a
+/// malformed header
+std::optional<std::string> read_message(std::istream& in);
+
+/// Write one message with its Content-Length header
+void write_message(std::ostream& out, const json::object& message);
+
+/// Local path of a file:// URI (percent-escapes decoded)
+/// Throws std::runtime_error for other schemes
+fs::path path_from_uri(const std::string& uri);
+
+/// file:// URI of an absolute path
+std::string uri_from_path(const fs::path& path);
+
+/// Language Server Protocol front end publishing profile violations as
+/// diagnostics for open documents
+///
+/// Documents are synchronized in full. Every open or change re-analyzes
+/// the document's current text with ast_detector::analyze_buffer(), which
+/// keeps a precompiled preamble per document, and publishes the findings
+/// (or one diagnostic explaining why the text could not be analyzed).
+/// The workspace root from `initialize` locates compile_commands.json.
+class language_server {
+public:
+    /// `defaults` supplies the profile, limits and compiler settings
+    explicit language_server(cli::analyze_args defaults);
+    ~language_server();
+
+    /// Serve one client until it sends "exit" or closes the stream
+    /// Returns the process exit code: 0 if "shutdown" came first, else 1
+    int run(std::istream& in, std::ostream& out);
+
+    /// Handle one decoded message, appending responses and notifications
+    void handle(const json::object& message, std::vector<json::object>& outgoing);
+
+    /// True once "exit" was received
+    bool exited() const { return exited_; }
+
+private:
+    struct document;
+    struct workspace;
+
+    void initialize(const json::object& params);
+    json::object publish(const std::string& uri, document& doc);
+
+    cli::analyze_args defaults_;
+    std::unique_ptr<workspace> workspace_;
+    std::map<std::string, std::unique_ptr<document>> documents_;  // By URI
+    bool shutdown_ = false;
+    bool exited_ = false;
+};
+
+} // namespace server
+} // namespace safeprofile
+} // namespace boost
+
+#endif // BOOST_SAFEPROFILE_SERVER_LSP_HPP
@@ -4,8 +4,11 @@
 
 #include <boost/test/unit_test.hpp>
 #include "analysis/ast_detector.hpp"
+#include "analysis/result_cache.hpp"
+#include "intake/compile_commands.hpp"
 #include "profile/rule.hpp"
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <fstream>
 
 namespace fs = boost::filesystem;
@@ -30,6 +33,32 @@ struct temp_file {
     }
 };
 
+// One rule per AST check
+std::vector<profile::rule> all_rules() {
+    std::vector<profile::rule> rules(5);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-BOUNDS-001";
+    rules[3].id = "SP-TYPE-001";
+    rules[4].id = "SP-LIFE-003";
+    return rules;
+}
+
+// Two ways of running the same analysis report the same findings in the
+// same order
+void expect_same_findings(
+    const std::vector<analysis::ast_finding>& expected,
+    const std::vector<analysis::ast_finding>& actual
+) {
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_TEST(expected[i].file == actual[i].file);
+        BOOST_TEST(expected[i].line == actual[i].line);
+        BOOST_TEST(expected[i].column == actual[i].column);
+        BOOST_TEST(expected[i].rule_id == actual[i].rule_id);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_detect_naked_delete_scalar) {
     temp_file test_cpp("test_delete_scalar.cpp", R"(
 void leak() {
@@ -479,4 +508,583 @@ int& bad2() {
     BOOST_REQUIRE_EQUAL(result.findings.size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(test_fused_pass_reports_all_rules) {
+    temp_file test_cpp("test_fused_pass.cpp", R"(
+int* bad() {
+    int* p = new int(1);      // SP-OWN-001
+    delete p;                 // SP-OWN-002
+    int arr[4];               // SP-BOUNDS-001
+    double d = (double)arr[0]; // SP-TYPE-001
+    int x = 42;
+    return &x;                // SP-LIFE-003
+}
+)");
+
+    const auto rules = all_rules();
+
+    analysis::matcher_set matchers(rules);
+    BOOST_TEST(matchers.rules().size() == 5u);
+    BOOST_TEST(matchers.unsupported_rules().empty());
+
+    analysis::ast_detector detector;
+    auto result = detector.analyze_file(test_cpp.path, matchers);
+
+    BOOST_REQUIRE(result.success);
+    BOOST_REQUIRE_EQUAL(result.findings.size(), 5);
+    for (const auto& rule : rules) {
+        auto count = std::count_if(result.findings.begin(), result.findings.end(),
+            [&](const analysis::ast_finding& f) { return f.rule_id == rule.id; });
+        BOOST_TEST(count == 1, "expected one finding for " << rule.id);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_matcher_set_skips_unsupported_rules) {
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-UNKNOWN-999";
+
+    analysis::matcher_set matchers(rules);
+
+    BOOST_REQUIRE_EQUAL(matchers.rules().size(), 1u);
+    BOOST_TEST(matchers.rules()[0].id == "SP-OWN-001");
+    BOOST_REQUIRE_EQUAL(matchers.unsupported_rules().size(), 1u);
+    BOOST_TEST(matchers.unsupported_rules()[0] == "SP-UNKNOWN-999");
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_matches_serial) {
+    temp_file a("test_parallel_a.cpp", "void a() { int* p = new int(1); delete p; }\n");
+    temp_file b("test_parallel_b.cpp", "void b() { int arr[3]; (void)arr; }\n");
+    temp_file c("test_parallel_c.cpp", "void c( { }\n");  // compile error
+    temp_file d("test_parallel_d.cpp", "int* d() { int x = 0; return &x; }\n");
+
+    const auto rules = all_rules();
+
+    std::vector<fs::path> files = {a.path, b.path, c.path, d.path};
+
+    analysis::ast_detector serial;
+    serial.set_jobs(1);
+    std::vector<analysis::file_analysis_result> serial_failed;
+    auto serial_findings = serial.analyze_files(files, rules, serial_failed);
+
+    analysis::ast_detector parallel;
+    parallel.set_jobs(4);
+    std::vector<analysis::file_analysis_result> parallel_failed;
+    auto parallel_findings = parallel.analyze_files(files, rules, parallel_failed);
+
+    expect_same_findings(serial_findings, parallel_findings);
+
+    BOOST_REQUIRE_EQUAL(serial_failed.size(), 1u);
+    BOOST_REQUIRE_EQUAL(parallel_failed.size(), 1u);
+    BOOST_TEST(parallel_failed[0].file == c.path);
+}
+
+BOOST_AUTO_TEST_CASE(test_precompiled_prefix_matches_plain_parse) {
+    const std::string prefix = "#include <vector>\n// shared\n#include <memory>\n";
+    temp_file a("test_pch_a.cpp", prefix + "void a() { int* p = new int(1); delete p; }\n");
+    temp_file b("test_pch_b.cpp", prefix + "void b() { int arr[3]; (void)(long)arr[0]; }\n");
+    temp_file c("test_pch_c.cpp", "#include <vector>\nint* c() { int x = 0; return &x; }\n");
+
+    const auto rules = all_rules();
+
+    std::vector<fs::path> files = {a.path, b.path, c.path};
+
+    analysis::ast_detector plain;
+    plain.set_precompiled_preambles(false);
+    std::vector<analysis::file_analysis_result> plain_failed;
+    auto plain_findings = plain.analyze_files(files, rules, plain_failed);
+
+    analysis::ast_detector precompiled;
+    std::vector<analysis::file_analysis_result> precompiled_failed;
+    analysis::analysis_statistics stats;
+    auto precompiled_findings = precompiled.analyze_files(files, rules, precompiled_failed, &stats);
+
+    // a and b share both includes; c shares only <vector>
+    BOOST_TEST(stats.preambles >= 1u);
+    BOOST_TEST(stats.preamble_tus >= 2u);
+
+    expect_same_findings(plain_findings, precompiled_findings);
+    BOOST_TEST(plain_failed.size() == precompiled_failed.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_umbrella_attributes_to_headers) {
+    temp_file a("test_umbrella_a.hpp", "#pragma once\ninline void a() { int* p = new int(1); delete p; }\n");
+    temp_file b("test_umbrella_b.hpp", "#pragma once\ninline int b() { return (int)2.5; }\n");
+    temp_file broken("test_umbrella_broken.hpp", "#pragma once\nvoid broken( {\n");
+
+    std::vector<profile::rule> rules(3);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-TYPE-001";
+
+    std::vector<fs::path> files = {a.path, b.path, broken.path};
+
+    analysis::ast_detector standalone;
+    std::vector<analysis::file_analysis_result> standalone_failed;
+    auto standalone_findings = standalone.analyze_files(files, rules, standalone_failed);
+
+    analysis::ast_detector umbrella;
+    umbrella.set_umbrella_headers(true);
+    std::vector<analysis::file_analysis_result> umbrella_failed;
+    analysis::analysis_statistics stats;
+    auto umbrella_findings = umbrella.analyze_files(files, rules, umbrella_failed, &stats);
+
+    // The broken header is blamed, dropped from the umbrella and parsed alone
+    BOOST_TEST(stats.umbrella_headers == 2u);
+    BOOST_REQUIRE_EQUAL(umbrella_failed.size(), 1u);
+    BOOST_TEST(umbrella_failed[0].file == broken.path);
+
+    expect_same_findings(standalone_findings, umbrella_findings);
+}
+
+BOOST_AUTO_TEST_CASE(test_included_header_analyzed_once) {
+    temp_file header("test_dedup.hpp", "#pragma once\ninline int* make() { return new int(1); }\n");
+    temp_file first("test_dedup_1.cpp", "#include \"test_dedup.hpp\"\nvoid f() { delete make(); }\n");
+    temp_file second("test_dedup_2.cpp", "#include \"test_dedup.hpp\"\nvoid g() { delete make(); }\n");
+
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+
+    std::vector<fs::path> files = {first.path, header.path, second.path};
+
+    analysis::ast_detector detector;
+    detector.set_jobs(2);
+    detector.set_additional_include_paths({fs::temp_directory_path().string()});
+    std::vector<analysis::file_analysis_result> failed;
+    analysis::analysis_statistics stats;
+    auto findings = detector.analyze_files(files, rules, failed, &stats);
+
+    BOOST_TEST(failed.empty());
+    BOOST_TEST(stats.covered_headers == 1u);
+    BOOST_TEST(stats.duplicate_findings == 1u);
+
+    auto in_header = std::count_if(findings.begin(), findings.end(),
+        [&](const analysis::ast_finding& f) { return f.file == header.path; });
+    BOOST_TEST(in_header == 1);
+    BOOST_TEST(findings.size() == 3u);  // One new, two deletes
+}
+
+BOOST_AUTO_TEST_CASE(test_traversal_scope_keeps_findings) {
+    temp_file header("test_scope.hpp",
+        "#pragma once\n#define DECLARE(name) inline void name() { delete new int(1); }\n"
+        "inline long widen(int x) { return (long)x; }\n");
+    temp_file source("test_scope.cpp",
+        "#include <vector>\n#include \"test_scope.hpp\"\n"
+        "namespace app {\ntemplate <typename T> T* make() { return new T(); }\n"
+        "void use() { std::vector<int> v; delete make<int>(); }\n}\n"
+        "DECLARE(from_macro)\nint narrow(double d) { return (int)d; }\n");
+
+    std::vector<profile::rule> rules(3);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-TYPE-001";
+
+    // Whether headers are reported through the source or on their own, the
+    // restricted traversal must find exactly what a full traversal finds
+    for (bool dedup : {true, false}) {
+        std::vector<fs::path> files = {source.path, header.path};
+        std::vector<std::vector<analysis::ast_finding>> results;
+        for (bool scoped : {true, false}) {
+            analysis::ast_detector detector;
+            detector.set_jobs(1);
+            detector.set_additional_include_paths({fs::temp_directory_path().string()});
+            detector.set_header_deduplication(dedup);
+            detector.set_traversal_scope(scoped);
+            std::vector<analysis::file_analysis_result> failed;
+            results.push_back(detector.analyze_files(files, rules, failed));
+            BOOST_TEST(failed.empty());
+        }
+
+        BOOST_TEST(results[0].size() >= 5u);
+        expect_same_findings(results[0], results[1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_template_code_reported_once) {
+    temp_file source("test_instantiations.cpp", R"(
+template <typename T>
+struct holder {
+    long widen(T value) { return (long)value; }
+    T* escape() { T local{}; return &local; }
+};
+void use() {
+    holder<int>().widen(1);
+    holder<short>().widen(2);
+    holder<int>().escape();
+    holder<short>().escape();
+}
+)");
+
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-TYPE-001";
+    rules[1].id = "SP-LIFE-003";
+
+    for (auto traversal : {analysis::match_traversal::as_spelled, analysis::match_traversal::all_nodes}) {
+        analysis::ast_detector detector;
+        detector.set_jobs(1);
+        detector.set_match_traversal(traversal);
+        std::vector<analysis::file_analysis_result> failed;
+        auto findings = detector.analyze_files({source.path}, rules, failed);
+
+        BOOST_TEST(failed.empty());
+        BOOST_REQUIRE_EQUAL(findings.size(), 2u);
+        BOOST_TEST(findings[0].rule_id == "SP-TYPE-001");
+        BOOST_TEST(findings[0].line == 4u);
+        BOOST_TEST(findings[1].rule_id == "SP-LIFE-003");
+        BOOST_TEST(findings[1].line == 5u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_fast_parse_matches_full_parse) {
+    temp_file header("test_fast.hpp",
+        "#pragma once\ninline int* make() { return new int(1); }\n"
+        "template <typename T> T narrow(double d) { return (T)d; }\n");
+    temp_file source("test_fast.cpp",
+        "#include <vector>\n#include <string>\n#include \"test_fast.hpp\"\n"
+        "constexpr int twice(int x) { return x * 2; }\n"
+        "auto deduced() { return std::string(\"x\").size(); }\n"
+        "void use() { std::vector<int> v(twice(2)); delete make(); (void)narrow<int>((double)deduced()); }\n");
+
+    std::vector<fs::path> files = {source.path, header.path};
+    for (const auto& entry : fs::recursive_directory_iterator(SAFEPROFILE_FIXTURES_DIR)) {
+        if (entry.path().extension() == ".cpp") {
+            files.push_back(entry.path());
+        }
+    }
+
+    const auto rules = all_rules();
+
+    std::vector<std::vector<analysis::ast_finding>> findings;
+    std::vector<std::vector<analysis::file_analysis_result>> failures(2);
+    for (bool fast : {false, true}) {
+        analysis::ast_detector detector;
+        detector.set_jobs(1);
+        detector.set_additional_include_paths({fs::temp_directory_path().string()});
+        detector.set_fast_parse(fast);
+        findings.push_back(detector.analyze_files(files, rules, failures[fast ? 1 : 0]));
+    }
+
+    BOOST_TEST(findings[0].size() >= 4u);
+    expect_same_findings(findings[0], findings[1]);
+    BOOST_REQUIRE_EQUAL(failures[0].size(), failures[1].size());
+    for (std::size_t i = 0; i < failures[0].size(); ++i) {
+        BOOST_TEST(failures[0][i].file == failures[1][i].file);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_lexical_prefilter_keeps_findings) {
+    temp_file plain("test_prefilter_plain.cpp", "int add(int a, int b) { return a + b; }\n");
+    temp_file owning("test_prefilter_new.cpp",
+        "int* make() { return new int(1); }\nvoid drop(int* p) { delete p; }\n");
+    temp_file macro("test_prefilter_macro.cpp",
+        "#define MAKE(T) new T\nint* make_int() { return MAKE(int); }\n");
+    std::vector<fs::path> files = {plain.path, owning.path, macro.path};
+
+    std::vector<profile::rule> rules(3);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-TYPE-001";
+
+    std::vector<std::vector<analysis::ast_finding>> findings;
+    std::vector<analysis::analysis_statistics> stats(3);
+    const analysis::lexical_prefilter modes[] = {
+        analysis::lexical_prefilter::off, analysis::lexical_prefilter::prune, analysis::lexical_prefilter::skip
+    };
+    for (std::size_t i = 0; i < 3; ++i) {
+        analysis::ast_detector detector;
+        detector.set_jobs(1);
+        detector.set_lexical_prefilter(modes[i]);
+        std::vector<analysis::file_analysis_result> failed;
+        findings.push_back(detector.analyze_files(files, rules, failed, &stats[i]));
+        BOOST_TEST(failed.empty());
+    }
+
+    BOOST_REQUIRE_EQUAL(findings[0].size(), 3u);
+    for (std::size_t i = 1; i < 3; ++i) {
+        expect_same_findings(findings[0], findings[i]);
+    }
+    BOOST_TEST(stats[1].lexically_skipped == 0u);
+    BOOST_TEST(stats[2].lexically_skipped == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_header_triggers_follow_includes) {
+    // Only the TU that includes the header needs its triggers; the other
+    // TU has nothing that can fire and is not parsed
+    temp_file header("test_triggers_owning.hpp", "#pragma once\ninline int* make() { return new int(1); }\n");
+    temp_file user("test_triggers_user.cpp", "#include \"test_triggers_owning.hpp\"\nint* use() { return make(); }\n");
+    temp_file plain("test_triggers_plain.cpp", "int add(int a, int b) { return a + b; }\n");
+    std::vector<fs::path> files = {user.path, plain.path, header.path};
+
+    std::vector<profile::rule> rules(1);
+    rules[0].id = "SP-OWN-001";
+
+    analysis::ast_detector detector;
+    detector.set_jobs(1);
+    detector.set_lexical_prefilter(analysis::lexical_prefilter::skip);
+    std::vector<analysis::file_analysis_result> failed;
+    analysis::analysis_statistics stats;
+    auto findings = detector.analyze_files(files, rules, failed, &stats);
+
+    BOOST_TEST(failed.empty());
+    BOOST_REQUIRE_EQUAL(findings.size(), 1u);
+    BOOST_TEST(findings[0].file == header.path);
+    BOOST_TEST(stats.lexically_skipped == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_invocation_reuse_keeps_findings) {
+    temp_file first("test_reuse_a.cpp", "void f() { int* p = new int(1); delete p; }\n");
+    temp_file second("test_reuse_b.cpp", "int g(double d) { return (int)d; }\n");
+    temp_file broken("test_reuse_c.cpp", "void h() { undeclared(); }\n");
+    std::vector<fs::path> files = {first.path, second.path, broken.path};
+
+    std::vector<profile::rule> rules(3);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-TYPE-001";
+
+    std::vector<std::vector<analysis::ast_finding>> findings;
+    std::vector<analysis::analysis_statistics> stats(2);
+    for (bool reuse : {false, true}) {
+        analysis::ast_detector detector;
+        detector.set_jobs(1);
+        detector.set_precompiled_preambles(false);
+        detector.set_invocation_reuse(reuse);
+        std::vector<analysis::file_analysis_result> failed;
+        findings.push_back(detector.analyze_files(files, rules, failed, &stats[reuse ? 1 : 0]));
+        BOOST_REQUIRE_EQUAL(failed.size(), 1u);
+        BOOST_TEST(failed[0].file == broken.path);
+    }
+
+    BOOST_REQUIRE_EQUAL(findings[0].size(), 3u);
+    expect_same_findings(findings[0], findings[1]);
+    BOOST_TEST(stats[0].invocation_templates == 0u);
+    BOOST_TEST(stats[1].invocation_templates == 1u);  // Same arguments and extension
+    BOOST_TEST(stats[1].invocations_reused == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_clang_tool_uses_full_command_line) {
+    // A forced include and a relative include path: only the full command
+    // line, run in the entry's directory, compiles this file
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-clang-tool-%%%%%%%%");
+    fs::create_directories(dir / "include");
+    std::ofstream((dir / "prelude.hpp").string()) << "#pragma once\ninline int* make_int() { return nullptr; }\n";
+    std::ofstream((dir / "include" / "lib.hpp").string()) << "#pragma once\ninline constexpr int lib_value = 1;\n";
+    std::ofstream((dir / "main.cpp").string())
+        << "#include \"lib.hpp\"\n"
+           "void f() {\n    delete make_int();\n    int* q = new int(lib_value);\n    delete q;\n}\n";
+    std::ofstream((dir / "compile_commands.json").string())
+        << "[{\"directory\": \"" << dir.generic_string() << "\", "
+           "\"command\": \"c++ -std=c++17 -include prelude.hpp -Iinclude -c main.cpp\", "
+           "\"file\": \"main.cpp\"}]";
+
+    auto db = std::make_shared<intake::compile_commands_reader>();
+    BOOST_REQUIRE(db->load_from_directory(dir));
+
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+
+    for (bool clang_tool : {false, true}) {
+        analysis::ast_detector detector;
+        detector.set_jobs(1);
+        detector.set_compilation_database(db);
+        detector.set_clang_tool(clang_tool);
+        std::vector<analysis::file_analysis_result> failed;
+        auto findings = detector.analyze_files({dir / "main.cpp"}, rules, failed);
+
+        if (!clang_tool) {
+            BOOST_TEST(failed.size() == 1u);  // Include path and prelude are lost
+            continue;
+        }
+        BOOST_TEST(failed.empty());
+        BOOST_REQUIRE_EQUAL(findings.size(), 3u);
+        BOOST_TEST(findings[0].line == 3u);
+        BOOST_TEST(findings[0].rule_id == "SP-OWN-002");
+        BOOST_TEST(findings[1].line == 4u);
+        BOOST_TEST(findings[1].rule_id == "SP-OWN-001");
+    }
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_result_cache_skips_unchanged_files) {
+    temp_file header("test_cached.hpp", "#pragma once\ninline int* make() { return new int(1); }\n");
+    temp_file source("test_cached.cpp", "#include \"test_cached.hpp\"\nvoid f() { delete make(); }\n");
+    auto cache_dir = fs::temp_directory_path() / fs::unique_path("sp-results-%%%%%%%%");
+    auto cache = std::make_shared<analysis::result_cache>(cache_dir);
+
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+
+    auto run = [&](analysis::analysis_statistics& stats) {
+        analysis::ast_detector detector;  // Fresh file cache each run
+        detector.set_additional_include_paths({fs::temp_directory_path().string()});
+        detector.set_result_cache(cache);
+        std::vector<analysis::file_analysis_result> failed;
+        auto findings = detector.analyze_files({source.path}, rules, failed, &stats);
+        BOOST_TEST(failed.empty());
+        return findings;
+    };
+
+    analysis::analysis_statistics cold;
+    auto expected = run(cold);
+    BOOST_TEST(cold.cache_misses == 1u);
+    BOOST_TEST(expected.size() == 1u);  // The delete; the header is not a project file here
+
+    analysis::analysis_statistics warm;
+    auto cached = run(warm);
+    BOOST_TEST(warm.cache_hits == 1u);
+    BOOST_REQUIRE_EQUAL(cached.size(), expected.size());
+    BOOST_TEST(cached[0].line == expected[0].line);
+    BOOST_TEST(cached[0].rule_id == expected[0].rule_id);
+
+    // Editing the included header invalidates the entry
+    std::ofstream(header.path.string()) << "#pragma once\ninline int* make() { return nullptr; }\n";
+    analysis::analysis_statistics edited;
+    run(edited);
+    BOOST_TEST(edited.cache_misses == 1u);
+
+    fs::remove_all(cache_dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_result_cache_notices_created_header) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-missing-%%%%%%%%");
+    fs::create_directories(dir);
+    auto source = dir / "uses_generated.cpp";
+    auto header = dir / "generated.hpp";
+    std::ofstream(source.string()) << "#include \"generated.hpp\"\nvoid f() { delete make(); }\n";
+    auto cache = std::make_shared<analysis::result_cache>(dir / "cache");
+
+    std::vector<profile::rule> rules(1);
+    rules[0].id = "SP-OWN-002";
+
+    auto run = [&](analysis::analysis_statistics& stats) {
+        analysis::ast_detector detector;
+        detector.set_result_cache(cache);
+        std::vector<analysis::file_analysis_result> failed;
+        detector.analyze_files({source}, rules, failed, &stats);
+        return failed.size();
+    };
+
+    // The failure is cached while the header is still missing
+    analysis::analysis_statistics missing;
+    BOOST_TEST(run(missing) == 1u);
+    analysis::analysis_statistics still_missing;
+    BOOST_TEST(run(still_missing) == 1u);
+    BOOST_TEST(still_missing.cache_hits == 1u);
+
+    // Generating the header invalidates it
+    std::ofstream(header.string()) << "#pragma once\ninline int* make() { return new int(1); }\n";
+    analysis::analysis_statistics generated;
+    BOOST_TEST(run(generated) == 0u);
+    BOOST_TEST(generated.cache_misses == 1u);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_merge_findings_is_order_independent) {
+    auto make = [](const char* file, unsigned int line, unsigned int column, const char* rule) {
+        return analysis::ast_finding{file, line, column, "msg", rule, profile::severity::major, ""};
+    };
+
+    std::vector<std::vector<analysis::ast_finding>> one_worker = {{
+        make("b.cpp", 2, 1, "SP-TYPE-001"),
+        make("a.cpp", 9, 3, "SP-OWN-001"),
+        make("a.cpp", 9, 3, "SP-BOUNDS-001"),
+        make("a.cpp", 1, 7, "SP-OWN-002"),
+    }};
+
+    std::vector<std::vector<analysis::ast_finding>> three_workers = {
+        {make("a.cpp", 9, 3, "SP-OWN-001"), make("b.cpp", 2, 1, "SP-TYPE-001")},
+        {},
+        {make("a.cpp", 1, 7, "SP-OWN-002"), make("a.cpp", 9, 3, "SP-BOUNDS-001")},
+    };
+
+    auto serial = analysis::merge_findings(std::move(one_worker));
+    auto parallel = analysis::merge_findings(std::move(three_workers));
+
+    BOOST_REQUIRE_EQUAL(serial.size(), 4u);
+    BOOST_REQUIRE_EQUAL(parallel.size(), 4u);
+
+    BOOST_TEST(serial[0].line == 1u);
+    BOOST_TEST(serial[1].rule_id == "SP-BOUNDS-001");
+    BOOST_TEST(serial[2].rule_id == "SP-OWN-001");
+    BOOST_TEST(serial[3].file == fs::path("b.cpp"));
+
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        BOOST_TEST(serial[i].file == parallel[i].file);
+        BOOST_TEST(serial[i].line == parallel[i].line);
+        BOOST_TEST(serial[i].column == parallel[i].column);
+        BOOST_TEST(serial[i].rule_id == parallel[i].rule_id);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_file_size_limit) {
+    temp_file test_cpp("test_size_limit.cpp", "void f() { int* p = new int(1); delete p; }\n");
+
+    profile::rule new_rule;
+    new_rule.id = "SP-OWN-001";
+
+    analysis::analysis_limits limits;
+    limits.max_file_size_bytes = 8;
+
+    analysis::ast_detector detector;
+    detector.set_limits(limits);
+    auto result = detector.analyze_file(test_cpp.path, new_rule);
+
+    BOOST_TEST(!result.success);
+    BOOST_TEST((result.failure == analysis::failure_kind::limit_exceeded));
+    BOOST_TEST(result.findings.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_time_budget_cancels_parse) {
+    temp_file test_cpp("test_time_budget.cpp", "void f() { int* p = new int(1); delete p; }\n");
+
+    profile::rule new_rule;
+    new_rule.id = "SP-OWN-001";
+
+    analysis::analysis_limits limits;
+    limits.time_budget_seconds = 1e-9;  // Expires before the first check
+
+    analysis::ast_detector detector;
+    detector.set_limits(limits);
+    auto result = detector.analyze_file(test_cpp.path, new_rule);
+
+    BOOST_TEST(!result.success);
+    BOOST_TEST((result.failure == analysis::failure_kind::limit_exceeded));
+    BOOST_TEST(result.error_message.find("Time budget") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_preamble_reused_across_edits) {
+    temp_file on_disk("test_buffer.cpp", "int unrelated;\n");
+    const std::string prefix = "#include <vector>\n#include <memory>\n";
+
+    std::vector<profile::rule> rules(2);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    analysis::matcher_set matchers(rules);
+
+    analysis::ast_detector detector;
+    analysis::buffer_preamble preamble;
+
+    auto first = detector.analyze_buffer(on_disk.path, prefix + "void f() { int* p = new int(1); delete p; }\n",
+                                         matchers, preamble);
+    BOOST_REQUIRE(first.success);
+    BOOST_TEST(!preamble.reused());
+    BOOST_REQUIRE_EQUAL(first.findings.size(), 2u);
+    BOOST_TEST(first.findings[0].line == 3u);
+
+    // Editing below the includes keeps the preamble
+    auto second = detector.analyze_buffer(on_disk.path, prefix + "\nvoid f() { std::vector<int> v; }\n",
+                                          matchers, preamble);
+    BOOST_REQUIRE(second.success);
+    BOOST_TEST(preamble.reused());
+    BOOST_TEST(second.findings.empty());
+
+    auto broken = detector.analyze_buffer(on_disk.path, prefix + "void f( {\n", matchers, preamble);
+    BOOST_TEST(!broken.success);
+    BOOST_TEST((broken.failure == analysis::failure_kind::compilation_error));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,220 @@
+// Boost.SafeProfile - Result cache backend tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/cache_backend.hpp"
+#include "analysis/result_cache.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace fs = boost::filesystem;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(cache_backend_tests)
+
+namespace {
+
+// Stand-in for a shared cache server: GET/PUT /cas/<key>, blobs in memory,
+// one request per connection
+class stand_in_server {
+public:
+    explicit stand_in_server(std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+        : acceptor_(io_, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)), delay_(delay) {
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~stand_in_server() {
+        stopping_ = true;
+        boost::asio::io_context io;
+        tcp::socket wake(io);
+        boost::system::error_code ec;
+        wake.connect(acceptor_.local_endpoint(), ec);
+        thread_.join();
+    }
+
+    std::string url() const {
+        return "http://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + "/cache";
+    }
+
+    std::size_t blobs() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return blobs_.size();
+    }
+
+private:
+    void serve() {
+        while (!stopping_) {
+            tcp::socket socket(io_);
+            boost::system::error_code ec;
+            acceptor_.accept(socket, ec);
+            if (ec || stopping_) {
+                continue;
+            }
+
+            boost::beast::flat_buffer buffer;
+            http::request<http::string_body> request;
+            http::read(socket, buffer, request, ec);
+            if (ec) {
+                continue;
+            }
+            std::this_thread::sleep_for(delay_);
+
+            http::response<http::string_body> response{http::status::ok, request.version()};
+            std::string target(request.target());
+            const std::string prefix = "/cache/cas/";
+            if (target.compare(0, prefix.size(), prefix) != 0) {
+                response.result(http::status::bad_request);
+            } else if (request.method() == http::verb::put) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                blobs_[target.substr(prefix.size())] = request.body();
+                response.result(http::status::created);
+            } else {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = blobs_.find(target.substr(prefix.size()));
+                if (it == blobs_.end()) {
+                    response.result(http::status::not_found);
+                } else {
+                    response.body() = it->second;
+                }
+            }
+            response.prepare_payload();
+            http::write(socket, response, ec);
+            socket.shutdown(tcp::socket::shutdown_both, ec);
+        }
+    }
+
+    boost::asio::io_context io_;
+    tcp::acceptor acceptor_;
+    std::chrono::milliseconds delay_;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+    std::mutex mutex_;
+    std::map<std::string, std::string> blobs_;
+};
+
+analysis::cached_result make_entry(const fs::path& file) {
+    analysis::cached_result entry;
+    entry.result.file = file;
+    entry.result.success = true;
+    entry.result.findings.push_back(
+        analysis::ast_finding{file, 2, 1, "naked new", "SP-OWN-001", profile::severity::major, "new int"});
+    return entry;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_http_round_trip) {
+    stand_in_server server;
+    analysis::http_backend backend(server.url());
+
+    BOOST_TEST(!backend.get("abc123"));
+    backend.put("abc123", std::string("blob\0data", 9));
+    auto blob = backend.get("abc123");
+    BOOST_REQUIRE(blob);
+    BOOST_TEST(*blob == std::string("blob\0data", 9));
+    BOOST_TEST(backend.failures() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_http_rejects_bad_urls) {
+    BOOST_CHECK_THROW(analysis::http_backend("https://cache.example/"), std::runtime_error);
+    BOOST_CHECK_THROW(analysis::http_backend("http://:80/"), std::runtime_error);
+    BOOST_CHECK_THROW(analysis::http_backend("http://host:port/"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_slow_server_gives_up) {
+    stand_in_server server(std::chrono::milliseconds(500));
+    analysis::http_backend backend(server.url(), 0.05);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < analysis::http_backend::max_failures + 2; ++i) {
+        BOOST_TEST(!backend.get("key"));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Only the first few requests wait for the deadline
+    BOOST_TEST(!backend.available());
+    BOOST_TEST(backend.failures() == analysis::http_backend::max_failures);
+    BOOST_TEST(elapsed < std::chrono::milliseconds(400));
+}
+
+BOOST_AUTO_TEST_CASE(test_results_shared_between_checkouts) {
+    stand_in_server server;
+    auto root = fs::temp_directory_path() / fs::unique_path("sp-shared-%%%%%%%%");
+    for (const char* checkout : {"a", "b"}) {
+        fs::create_directories(root / checkout / "src");
+        std::ofstream((root / checkout / "src" / "x.hpp").string()) << "int x;\n";
+    }
+
+    auto make_cache = [&](const char* checkout) {
+        auto cache = std::make_shared<analysis::result_cache>(
+            std::make_shared<analysis::directory_backend>(root / checkout / ".cache"),
+            std::make_shared<analysis::http_backend>(server.url()));
+        cache->set_base_directory(root / checkout);
+        return cache;
+    };
+
+    // Machine A analyzes and publishes
+    {
+        auto cache = make_cache("a");
+        auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+        std::string key = "k" + cache->portable((root / "a" / "src" / "x.cpp").string());
+        cache->store(analysis::hash_builder().add(key).hex(),
+                     {(root / "a" / "src" / "x.hpp").string()},
+                     make_entry(root / "a" / "src" / "x.cpp"), *files);
+    }
+    BOOST_TEST(server.blobs() == 2u);  // Manifest and result
+
+    // Machine B, checked out elsewhere, reuses it through a prefetch
+    auto cache = make_cache("b");
+    auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    std::string key = analysis::hash_builder()
+        .add("k" + cache->portable((root / "b" / "src" / "x.cpp").string())).hex();
+    cache->prefetch({key}, files);
+    auto hit = cache->lookup(key, *files);
+    BOOST_REQUIRE(hit);
+    BOOST_TEST(hit->result.file == root / "b" / "src" / "x.cpp");
+    BOOST_REQUIRE_EQUAL(hit->result.findings.size(), 1u);
+    BOOST_TEST(hit->result.findings[0].file == root / "b" / "src" / "x.cpp");
+
+    // The hit was copied to B's local store
+    analysis::result_cache offline(root / "b" / ".cache");
+    offline.set_base_directory(root / "b");
+    BOOST_TEST(static_cast<bool>(offline.lookup(key, *files)));
+
+    fs::remove_all(root);
+}
+
+BOOST_AUTO_TEST_CASE(test_unreachable_remote_falls_back) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-remote-%%%%%%%%");
+    std::string url;
+    {
+        stand_in_server server;
+        url = server.url();
+    }  // Nothing listens on the port any more
+
+    analysis::result_cache cache(
+        std::make_shared<analysis::directory_backend>(dir),
+        std::make_shared<analysis::http_backend>(url, 0.5));
+    auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+
+    cache.prefetch({"key"}, files);
+    BOOST_TEST(!cache.lookup("key", *files));
+    cache.store("key", {}, make_entry(dir / "a.cpp"), *files);
+    BOOST_TEST(static_cast<bool>(cache.lookup("key", *files)));
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -66,6 +66,36 @@ BOOST_AUTO_TEST_CASE(test_online_mode) {
     BOOST_TEST(args->offline == false);
 }
 
+BOOST_AUTO_TEST_CASE(test_jobs_option) {
+    const char* argv[] = {"boost-safeprofile", "--jobs", "4", "."};
+    int argc = 4;
+
+    auto args = boost::safeprofile::cli::parse_arguments(argc, const_cast<char**>(argv));
+
+    BOOST_REQUIRE(args.has_value());
+    BOOST_TEST(args->jobs == 4u);
+}
+
+BOOST_AUTO_TEST_CASE(test_jobs_default) {
+    const char* argv[] = {"boost-safeprofile", "."};
+    int argc = 2;
+
+    auto args = boost::safeprofile::cli::parse_arguments(argc, const_cast<char**>(argv));
+
+    BOOST_REQUIRE(args.has_value());
+    BOOST_TEST(args->jobs == 0u); // 0 = hardware concurrency
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_limit_requires_isolate) {
+    const char* without[] = {"boost-safeprofile", "--memory-limit", "512", "."};
+    BOOST_TEST(!boost::safeprofile::cli::parse_arguments(4, const_cast<char**>(without)).has_value());
+
+    const char* with[] = {"boost-safeprofile", "--isolate", "--memory-limit", "512", "."};
+    auto args = boost::safeprofile::cli::parse_arguments(5, const_cast<char**>(with));
+    BOOST_REQUIRE(args.has_value());
+    BOOST_TEST(args->memory_limit_mb == 512u);
+}
+
 BOOST_AUTO_TEST_CASE(test_missing_path) {
     const char* argv[] = {"boost-safeprofile"};
     int argc = 1;
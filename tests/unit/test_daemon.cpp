@@ -0,0 +1,95 @@
+// Boost.SafeProfile - Resident daemon tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "server/daemon.hpp"
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace json = boost::json;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(daemon_tests)
+
+namespace {
+
+std::vector<json::object> ask(server::daemon& daemon, const json::object& request) {
+    std::vector<json::object> lines;
+    daemon.handle(json::serialize(request), [&](const json::object& line) { lines.push_back(line); });
+    return lines;
+}
+
+std::size_t count_type(const std::vector<json::object>& lines, const char* type) {
+    std::size_t n = 0;
+    for (const auto& line : lines) {
+        if (line.at("type").as_string() == type) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_repeated_requests_see_edits) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-daemon-%%%%%%%%");
+    fs::create_directories(dir);
+    std::ofstream((dir / "leak.cpp").string()) << "void f() { int* p = new int(1); (void)p; }\n";
+
+    cli::analyze_args defaults;
+    defaults.jobs = 1;
+    server::daemon daemon(defaults);
+    json::object request{{"command", "analyze"}, {"target", dir.string()}};
+
+    auto first = ask(daemon, request);
+    BOOST_REQUIRE(!first.empty());
+    BOOST_TEST(first.back().at("type").as_string() == "done");
+    BOOST_TEST(count_type(first, "finding") == 1u);
+
+    // The warm file cache must not hide the edit
+    std::ofstream((dir / "leak.cpp").string()) << "void f() { int value = 1; (void)value; }\n";
+    auto second = ask(daemon, request);
+    BOOST_REQUIRE(!second.empty());
+    BOOST_TEST(count_type(second, "finding") == 0u);
+    BOOST_TEST(second.back().at("type").as_string() == "done");
+
+    auto bad = ask(daemon, json::object{{"command", "analyze"}, {"target", (dir / "missing").string()}});
+    BOOST_REQUIRE_EQUAL(bad.size(), 1u);
+    BOOST_TEST(bad[0].at("type").as_string() == "error");
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_socket_round_trip) {
+    auto socket_path = fs::temp_directory_path() / fs::unique_path("sp-%%%%%%%%.sock");
+    server::daemon daemon{cli::analyze_args{}};
+    std::thread serving([&] { daemon.run(socket_path); });
+
+    // Wait for the daemon to listen
+    json::object status;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        try {
+            status = server::send_request(socket_path, json::object{{"command", "status"}},
+                                          [](const json::object&) {});
+            break;
+        } catch (const std::runtime_error&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    BOOST_TEST(status.at("requests").to_number<std::size_t>() == 1u);
+
+    BOOST_CHECK_THROW(server::send_request(socket_path, json::object{{"command", "bogus"}},
+                                           [](const json::object&) {}),
+                      std::runtime_error);
+
+    server::send_request(socket_path, json::object{{"command", "shutdown"}}, [](const json::object&) {});
+    serving.join();
+    BOOST_TEST(!fs::exists(socket_path));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
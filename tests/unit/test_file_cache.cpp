@@ -0,0 +1,120 @@
+// Boost.SafeProfile - Shared file cache tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/file_cache.hpp"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(file_cache_tests)
+
+BOOST_AUTO_TEST_CASE(test_contents_read_once) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-vfs-%%%%%%%%");
+    fs::create_directories(dir);
+    auto header = (dir / "a.hpp").string();
+    std::ofstream(header) << "int a;\n";
+
+    auto cache = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+
+    auto first = cache->getBufferForFile(header);
+    BOOST_REQUIRE(first);
+    BOOST_TEST((*first)->getBuffer().str() == "int a;\n");
+
+    // Later edits are not observed: the cache is a snapshot for the run
+    std::ofstream(header) << "int b;\n";
+    auto second = cache->getBufferForFile(header);
+    BOOST_REQUIRE(second);
+    BOOST_TEST((*second)->getBuffer().str() == "int a;\n");
+
+    auto stats = cache->statistics();
+    BOOST_TEST(stats.lookups == 4u);  // stat + read, twice
+    BOOST_TEST(stats.hits == 2u);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_missing_files_cached) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-vfs-%%%%%%%%");
+    fs::create_directories(dir);
+    auto missing = (dir / "missing.hpp").string();
+
+    auto cache = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+
+    BOOST_TEST(!cache->status(missing));
+    BOOST_TEST(!cache->status(missing));
+    BOOST_TEST(cache->statistics().hits == 1u);
+
+    // A failed probe stays failed until the cache is cleared
+    std::ofstream(missing) << "\n";
+    BOOST_TEST(!cache->status(missing));
+    cache->clear();
+    BOOST_TEST(static_cast<bool>(cache->status(missing)));
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_refresh_drops_changed_files) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-vfs-%%%%%%%%");
+    fs::create_directories(dir);
+    auto edited = (dir / "edited.hpp").string();
+    auto untouched = (dir / "untouched.hpp").string();
+    auto created = (dir / "created.hpp").string();
+    std::ofstream(edited) << "int a;\n";
+    std::ofstream(untouched) << "int b;\n";
+
+    auto cache = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    BOOST_REQUIRE(cache->getBufferForFile(edited));
+    BOOST_REQUIRE(cache->getBufferForFile(untouched));
+    BOOST_TEST(!cache->status(created));
+
+    std::ofstream(edited) << "int a = 42;\n";  // Different size
+    std::ofstream(created) << "\n";
+
+    auto changed = cache->refresh();
+    std::sort(changed.begin(), changed.end());
+    BOOST_REQUIRE_EQUAL(changed.size(), 2u);
+    BOOST_TEST(changed[0] == created);
+    BOOST_TEST(changed[1] == edited);
+
+    BOOST_TEST((*cache->getBufferForFile(edited))->getBuffer().str() == "int a = 42;\n");
+    BOOST_TEST(static_cast<bool>(cache->status(created)));
+    BOOST_TEST(cache->refresh().empty());
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_working_directory_fixed) {
+    auto cache = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    BOOST_TEST(static_cast<bool>(cache->setCurrentWorkingDirectory("/")));
+}
+
+BOOST_AUTO_TEST_CASE(test_working_directory_view) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-vfs-%%%%%%%%");
+    fs::create_directories(dir / "sub");
+    std::ofstream((dir / "sub" / "a.hpp").string()) << "int a;\n";
+
+    auto cache = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    auto view = llvm::makeIntrusiveRefCnt<analysis::working_directory_file_system>(cache);
+
+    // The shared cache keeps its directory; the view resolves against its own
+    BOOST_TEST(!view->setCurrentWorkingDirectory(dir.string()));
+    BOOST_TEST(*view->getCurrentWorkingDirectory() == dir.string());
+    auto lookups = cache->statistics().lookups;
+    auto buffer = view->getBufferForFile("sub/a.hpp");
+    BOOST_REQUIRE(buffer);
+    BOOST_TEST((*buffer)->getBuffer().str() == "int a;\n");
+    BOOST_TEST(cache->statistics().lookups == lookups + 2);  // Absolute stat + read in the cache
+
+    BOOST_TEST(!view->setCurrentWorkingDirectory("sub"));
+    BOOST_TEST(static_cast<bool>(view->status("a.hpp")));
+    BOOST_TEST(static_cast<bool>(view->setCurrentWorkingDirectory("a.hpp")));  // Not a directory
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Boost.SafeProfile - Concurrent finding set tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/finding_delta.hpp"
+#include "analysis/finding_set.hpp"
+#include <thread>
+
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(finding_set_tests)
+
+namespace {
+
+analysis::ast_finding make(unsigned int line, const char* message) {
+    return analysis::ast_finding{"a.hpp", line, 1, message, "SP-OWN-001", profile::severity::major, ""};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_duplicates_collapse) {
+    analysis::finding_set set(4);
+
+    BOOST_TEST(set.insert(make(1, "x")));
+    BOOST_TEST(set.insert(make(2, "x")));
+    BOOST_TEST(!set.insert(make(1, "x")));
+
+    BOOST_TEST(set.duplicates() == 1u);
+    auto findings = set.take();
+    BOOST_REQUIRE_EQUAL(findings.size(), 2u);
+    BOOST_TEST(findings[0].line == 1u);
+    BOOST_TEST(findings[1].line == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_winner_independent_of_order) {
+    analysis::finding_set forward;
+    forward.insert(make(1, "b"));
+    forward.insert(make(1, "a"));
+
+    analysis::finding_set backward;
+    backward.insert(make(1, "a"));
+    backward.insert(make(1, "b"));
+
+    BOOST_TEST(forward.take()[0].message == "a");
+    BOOST_TEST(backward.take()[0].message == "a");
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_inserts) {
+    analysis::finding_set set;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&set] {
+            for (unsigned int line = 1; line <= 1000; ++line) {
+                set.insert(make(line, "x"));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    BOOST_TEST(set.duplicates() == 3000u);
+    BOOST_TEST(set.take().size() == 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(test_tracked_findings_delta) {
+    auto at = [](const char* file, unsigned int line) {
+        return analysis::ast_finding{file, line, 1, "msg", "SP-OWN-001", profile::severity::major, ""};
+    };
+    analysis::file_analysis_result broken;
+    broken.file = "/p/c.cpp";
+    broken.error_message = "expected ';'";
+
+    analysis::tracked_findings tracked;
+    auto first = tracked.replace({at("/p/a.cpp", 1), at("/p/b.cpp", 2), at("/p/h.hpp", 3)}, {broken});
+    BOOST_TEST(first.added.size() == 3u);
+    BOOST_TEST(first.failed.size() == 1u);
+
+    // a.cpp re-analyzed: one finding moved, the header one reported again
+    // but out of scope; c.cpp compiles now; b.cpp was deleted
+    auto delta = tracked.update({"/p/a.cpp", "/p/c.cpp", "/p/b.cpp"},
+                                {at("/p/a.cpp", 5), at("/p/h.hpp", 3)}, {});
+    BOOST_REQUIRE_EQUAL(delta.added.size(), 1u);
+    BOOST_TEST(delta.added[0].line == 5u);
+    BOOST_REQUIRE_EQUAL(delta.resolved.size(), 2u);
+    BOOST_TEST(delta.resolved[0].line == 1u);
+    BOOST_TEST(delta.resolved[1].file == "/p/b.cpp");
+    BOOST_REQUIRE_EQUAL(delta.recovered.size(), 1u);
+    BOOST_TEST(delta.recovered[0] == "/p/c.cpp");
+
+    BOOST_REQUIRE_EQUAL(tracked.findings().size(), 2u);
+    BOOST_TEST(tracked.findings()[0].file == "/p/a.cpp");
+    BOOST_TEST(tracked.findings()[1].file == "/p/h.hpp");
+    BOOST_TEST(tracked.failures().empty());
+
+    // Nothing changed: an empty delta
+    BOOST_TEST(tracked.update({"/p/a.cpp"}, {at("/p/a.cpp", 5)}, {}).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
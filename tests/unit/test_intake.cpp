@@ -4,7 +4,12 @@
 
 #include <boost/test/unit_test.hpp>
 #include "intake/repository.hpp"
+#include "intake/compile_commands.hpp"
+#include "intake/include_graph.hpp"
+#include "intake/watcher.hpp"
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
 namespace fs = boost::filesystem;
@@ -96,4 +101,223 @@ BOOST_AUTO_TEST_CASE(test_root_path_accessor) {
     BOOST_TEST(repo.root() == test_path);
 }
 
+BOOST_AUTO_TEST_CASE(test_scan_includes_skips_comments) {
+    auto directives = boost::safeprofile::intake::scan_includes(
+        "#include <vector>\n"
+        "  #  include \"local.hpp\" // trailing\n"
+        "// #include \"commented.hpp\"\n"
+        "/* #include \"block.hpp\"\n"
+        "   #include \"still_block.hpp\" */\n"
+        "#if 0\n#include_next <next.h>\n#endif\n"
+        "const char* s = \"// not a comment\";\n"
+        "#include MACRO_NAME\n");
+
+    BOOST_REQUIRE_EQUAL(directives.size(), 3u);
+    BOOST_TEST(directives[0].name == "vector");
+    BOOST_TEST(directives[0].angled);
+    BOOST_TEST(directives[1].name == "local.hpp");
+    BOOST_TEST(!directives[1].angled);
+    BOOST_TEST(directives[2].name == "next.h");  // Conditionals are not evaluated
+}
+
+BOOST_FIXTURE_TEST_CASE(test_include_graph_affected_files, TempDirFixture) {
+    create_file("include/lib/base.hpp", "#pragma once\n");
+    create_file("include/lib/mid.hpp", "#include <lib/base.hpp>\n");
+    create_file("src/a.cpp", "#include \"../include/lib/mid.hpp\"\n");
+    create_file("src/b.cpp", "#include <lib/mid.hpp>\n");  // Resolved by suffix
+    create_file("src/c.cpp", "#include <vector>\n");
+
+    boost::safeprofile::intake::repository repo(temp_dir);
+    std::vector<fs::path> files;
+    for (const auto& src : repo.discover_sources()) {
+        files.push_back(src.path);
+    }
+
+    auto graph = boost::safeprofile::intake::include_graph::build(files, {temp_dir / "include"});
+    BOOST_TEST(graph.size() == 5u);
+    BOOST_REQUIRE_EQUAL(graph.includes(temp_dir / "src/a.cpp").size(), 1u);
+    BOOST_TEST(graph.includes(temp_dir / "src/a.cpp")[0] == temp_dir / "include/lib/mid.hpp");
+
+    auto affected = graph.affected_by({temp_dir / "include/lib/base.hpp"});
+    BOOST_REQUIRE_EQUAL(affected.size(), 4u);
+    BOOST_TEST(std::count(affected.begin(), affected.end(), temp_dir / "src/c.cpp") == 0);
+
+    // Only the changed file itself when nothing includes it
+    auto leaf = graph.affected_by({temp_dir / "src/c.cpp", temp_dir / "deleted.hpp"});
+    BOOST_REQUIRE_EQUAL(leaf.size(), 1u);
+    BOOST_TEST(leaf[0] == temp_dir / "src/c.cpp");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_include_graph_deleted_header, TempDirFixture) {
+    // Both headers were deleted or renamed away; their includers remain
+    create_file("include/lib/mid.hpp", "#include <lib/old_name.hpp>\n");
+    create_file("src/a.cpp", "#include \"gone.hpp\"\n");
+    create_file("src/b.cpp", "#include <lib/mid.hpp>\n");
+    create_file("src/c.cpp", "#include <vector>\n");
+
+    boost::safeprofile::intake::repository repo(temp_dir);
+    std::vector<fs::path> files;
+    for (const auto& src : repo.discover_sources()) {
+        files.push_back(src.path);
+    }
+    auto graph = boost::safeprofile::intake::include_graph::build(files, {temp_dir / "include"});
+
+    auto gone = graph.affected_by({temp_dir / "src/gone.hpp"});
+    BOOST_REQUIRE_EQUAL(gone.size(), 1u);
+    BOOST_TEST(gone[0] == temp_dir / "src/a.cpp");
+
+    auto renamed = graph.affected_by({temp_dir / "include/lib/old_name.hpp"});
+    BOOST_REQUIRE_EQUAL(renamed.size(), 2u);
+    BOOST_TEST(std::count(renamed.begin(), renamed.end(), temp_dir / "include/lib/mid.hpp") == 1);
+    BOOST_TEST(std::count(renamed.begin(), renamed.end(), temp_dir / "src/b.cpp") == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_split_command) {
+    using boost::safeprofile::intake::split_command;
+    auto args = split_command("c++  -DNAME=\"a b\" -I'dir with space' a\\ b.cpp\t-c");
+    BOOST_REQUIRE_EQUAL(args.size(), 5u);
+    BOOST_TEST(args[0] == "c++");
+    BOOST_TEST(args[1] == "-DNAME=a b");
+    BOOST_TEST(args[2] == "-Idir with space");
+    BOOST_TEST(args[3] == "a b.cpp");
+    BOOST_TEST(args[4] == "-c");
+    BOOST_TEST(split_command("").empty());
+    BOOST_TEST(split_command("cc \"\"").size() == 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_compile_commands_keep_full_command, TempDirFixture) {
+    create_file("src/a.cpp", "int a;\n");
+    create_file("compile_commands.json",
+        "[{\"directory\": \"" + temp_dir.generic_string() + "\", \"file\": \"src/a.cpp\","
+        " \"command\": \"clang++ -std=c++17 -I inc -include cfg.hpp -c src/a.cpp\"}]");
+
+    boost::safeprofile::intake::compile_commands_reader reader;
+    BOOST_REQUIRE(reader.load_from_directory(temp_dir));
+    auto flags = reader.get_flags_for_file(temp_dir / "src/a.cpp");
+    BOOST_REQUIRE(flags);
+    BOOST_TEST(flags->std_version == "c++17");
+    BOOST_TEST(flags->file == "src/a.cpp");
+    BOOST_REQUIRE_EQUAL(flags->arguments.size(), 8u);
+    BOOST_TEST(flags->arguments[4] == "-include");
+    BOOST_TEST(reader.files().size() == 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_compile_commands_index, TempDirFixture) {
+    using boost::safeprofile::intake::compile_commands_reader;
+    create_file("src/a.cpp", "int a;\n");
+    create_file("src/b.cpp", "int b;\n");
+    const std::string dir = temp_dir.generic_string();
+    auto database = [&](const char* std_version) {
+        return "[{\"directory\": \"" + dir + "\", \"file\": \"src/a.cpp\", \"output\": [\"x\"],"
+               " \"arguments\": [\"c++\", \"-std=" + std_version + "\", \"-DV=\\\"a b\\\"\", \"-c\", \"src/a.cpp\"]},"
+               " {\"directory\": \"" + dir + "/src\", \"file\": \"b.cpp\", \"command\": \"c++ -Iinc -c b.cpp\"},"
+               " {\"directory\": \"" + dir + "\", \"file\": \"missing.cpp\"}]";
+    };
+    create_file("compile_commands.json", database("c++17"));
+
+    // The first load parses the JSON and writes the index
+    compile_commands_reader first;
+    BOOST_REQUIRE(first.load_from_directory(temp_dir));
+    BOOST_TEST(!first.loaded_from_index());
+    BOOST_TEST(fs::exists(compile_commands_reader::index_path(temp_dir)));
+    BOOST_TEST(first.entry_count() == 2u);  // The entry without a command is skipped
+
+    // The second maps it and answers the same
+    compile_commands_reader second;
+    BOOST_REQUIRE(second.load_from_directory(temp_dir));
+    BOOST_TEST(second.loaded_from_index());
+    BOOST_TEST(second.entry_count() == 2u);
+    auto a = second.get_flags_for_file(temp_dir / "src" / ".." / "src" / "a.cpp");
+    BOOST_REQUIRE(a);
+    BOOST_TEST(a->std_version == "c++17");
+    BOOST_REQUIRE_EQUAL(a->defines.size(), 1u);
+    BOOST_TEST(a->defines[0] == "V=\"a b\"");
+    BOOST_TEST(a->arguments.size() == 5u);
+    auto b = second.get_flags_for_file(temp_dir / "src/b.cpp");
+    BOOST_REQUIRE(b);
+    BOOST_TEST(b->file == "b.cpp");
+    BOOST_REQUIRE_EQUAL(b->include_paths.size(), 1u);
+    BOOST_TEST(b->include_paths[0] == "inc");
+    BOOST_TEST(!second.get_flags_for_file(temp_dir / "missing.cpp"));
+
+    // Same size and modification time, different contents: the hash catches it
+    auto written = fs::last_write_time(temp_dir / "compile_commands.json");
+    create_file("compile_commands.json", database("c++20"));
+    fs::last_write_time(temp_dir / "compile_commands.json", written);
+    compile_commands_reader third;
+    BOOST_REQUIRE(third.load_from_directory(temp_dir));
+    BOOST_TEST(!third.loaded_from_index());
+    BOOST_TEST(third.get_flags_for_file(temp_dir / "src/a.cpp")->std_version == "c++20");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_compile_commands_rejects_non_array, TempDirFixture) {
+    create_file("compile_commands.json", "{\"entries\": [{\"directory\": \"/\", \"file\": \"a.cpp\", \"command\": \"cc\"}]}");
+    boost::safeprofile::intake::compile_commands_reader reader;
+    BOOST_TEST(!reader.load_from_directory(temp_dir));
+    BOOST_TEST(!reader.is_loaded());
+
+    create_file("compile_commands.json", "[{\"directory\": \"/\", \"file\": ");
+    BOOST_TEST(!reader.load_from_directory(temp_dir));
+}
+
+#ifdef __linux__
+BOOST_FIXTURE_TEST_CASE(test_watcher_collects_changes, TempDirFixture) {
+    create_file("src/a.cpp", "int a;\n");
+    create_file("src/b.cpp", "int b;\n");
+    boost::safeprofile::intake::tree_watcher watcher(temp_dir);
+    BOOST_TEST(watcher.directories() == 2u);
+
+    // A burst of edits is reported once, after it settles
+    create_file("src/a.cpp", "int a = 1;\n");
+    create_file("src/a.cpp", "int a = 2;\n");
+    fs::remove(temp_dir / "src/b.cpp");
+    create_file("new/c.hpp", "#pragma once\n");  // In a directory created after the watch
+
+    auto changed = watcher.wait(std::chrono::milliseconds(50));
+    BOOST_REQUIRE_EQUAL(changed.size(), 3u);
+    BOOST_TEST(changed[0] == temp_dir / "new/c.hpp");
+    BOOST_TEST(changed[1] == temp_dir / "src/a.cpp");
+    BOOST_TEST(changed[2] == temp_dir / "src/b.cpp");
+    BOOST_TEST(watcher.directories() == 3u);
+
+    // Files in the new directory are watched too
+    create_file("new/c.hpp", "#pragma once\nint c;\n");
+    changed = watcher.wait(std::chrono::milliseconds(50));
+    BOOST_REQUIRE_EQUAL(changed.size(), 1u);
+    BOOST_TEST(changed[0] == temp_dir / "new/c.hpp");
+}
+
+BOOST_FIXTURE_TEST_CASE(test_watcher_reports_removed_headers, TempDirFixture) {
+    create_file("src/a.cpp", "#include \"gone.hpp\"\n");
+    create_file("src/gone.hpp", "#pragma once\n");
+    create_file("src/b.cpp", "#include <lib/moved.hpp>\n");
+    create_file("include/lib/moved.hpp", "#pragma once\n");
+    boost::safeprofile::intake::tree_watcher watcher(temp_dir);
+
+    // Deleting a header and moving a directory out of the tree both
+    // report the files that disappeared
+    fs::remove(temp_dir / "src/gone.hpp");
+    fs::path outside = temp_dir.parent_path() / (temp_dir.filename().string() + "_moved");
+    fs::rename(temp_dir / "include/lib", outside);
+
+    auto changed = watcher.wait(std::chrono::milliseconds(50));
+    fs::remove_all(outside);
+    BOOST_REQUIRE_EQUAL(changed.size(), 2u);
+    BOOST_TEST(changed[0] == temp_dir / "include/lib/moved.hpp");
+    BOOST_TEST(changed[1] == temp_dir / "src/gone.hpp");
+
+    // Their former includers are what watch mode re-analyzes
+    boost::safeprofile::intake::repository repo(temp_dir);
+    std::vector<fs::path> files;
+    for (const auto& src : repo.discover_sources()) {
+        files.push_back(src.path);
+    }
+    auto graph = boost::safeprofile::intake::include_graph::build(files, {temp_dir / "include"});
+    auto affected = graph.affected_by(changed);
+    BOOST_REQUIRE_EQUAL(affected.size(), 2u);
+    BOOST_TEST(std::count(affected.begin(), affected.end(), temp_dir / "src/a.cpp") == 1);
+    BOOST_TEST(std::count(affected.begin(), affected.end(), temp_dir / "src/b.cpp") == 1);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
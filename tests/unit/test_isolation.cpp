@@ -0,0 +1,143 @@
+// Boost.SafeProfile - Process isolation tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/isolation.hpp"
+#include <chrono>
+#include <csignal>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(isolation_tests)
+
+#if defined(__unix__) || defined(__APPLE__)
+
+BOOST_AUTO_TEST_CASE(test_result_crosses_process_boundary) {
+    auto result = analysis::run_isolated("ok.cpp", [] {
+        analysis::file_analysis_result r;
+        r.file = "ok.cpp";
+        r.success = true;
+        r.findings.push_back({"ok.cpp", 3, 7, "message", "SP-OWN-001",
+                              profile::severity::blocker, "new int"});
+        return r;
+    }, 0);
+
+    BOOST_REQUIRE(result.success);
+    BOOST_REQUIRE_EQUAL(result.findings.size(), 1u);
+    BOOST_TEST(result.findings[0].line == 3u);
+    BOOST_TEST(result.findings[0].column == 7u);
+    BOOST_TEST(result.findings[0].rule_id == "SP-OWN-001");
+    BOOST_TEST(result.findings[0].snippet == "new int");
+}
+
+BOOST_AUTO_TEST_CASE(test_crash_is_contained) {
+    auto result = analysis::run_isolated("crash.cpp", []() -> analysis::file_analysis_result {
+        std::raise(SIGSEGV);
+        return {};
+    }, 0);
+
+    BOOST_TEST(!result.success);
+    BOOST_TEST((result.failure == analysis::failure_kind::crashed));
+    BOOST_TEST(result.file == "crash.cpp");
+    BOOST_TEST(result.error_message.find("signal") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_cap_reports_out_of_memory) {
+    auto result = analysis::run_isolated("huge.cpp", [] {
+        std::vector<char> hog(std::size_t{1} << 32);  // 4 GB, far above the cap
+        hog[0] = 1;
+        analysis::file_analysis_result r;
+        r.success = hog[0] == 1;
+        return r;
+    }, 256);
+
+    BOOST_TEST(!result.success);
+    BOOST_TEST((result.failure == analysis::failure_kind::out_of_memory));
+}
+
+BOOST_AUTO_TEST_CASE(test_memory_cap_excludes_inherited_mappings) {
+    // Reserved but untouched, so it costs address space and no memory
+    std::vector<char> inherited;
+    inherited.reserve(std::size_t{512} << 20);
+
+    auto result = analysis::run_isolated("moderate.cpp", [] {
+        std::vector<char> buffer(std::size_t{64} << 20);
+        buffer.back() = 1;
+        analysis::file_analysis_result r;
+        r.success = buffer.back() == 1;
+        return r;
+    }, 256);
+
+    BOOST_TEST(result.success);
+}
+
+BOOST_AUTO_TEST_CASE(test_pool_runs_workers_in_parallel) {
+    const std::size_t count = 6;
+    std::size_t next = 0;
+    std::vector<analysis::worker_output> outputs(count);
+
+    auto start = std::chrono::steady_clock::now();
+    analysis::run_isolated_pool(3, 0,
+        [&]() -> std::optional<analysis::isolated_job> {
+            if (next == count) {
+                return std::nullopt;
+            }
+            analysis::isolated_job job;
+            job.source_file = "job" + std::to_string(next) + ".cpp";
+            job.tag = next++;
+            job.analyze = [tag = job.tag] {
+                if (tag == 2) {
+                    std::raise(SIGSEGV);  // Fails alone
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                analysis::worker_output output;
+                output.result.success = true;
+                output.dependencies.push_back("dep" + std::to_string(tag) + ".hpp");
+                return output;
+            };
+            return job;
+        },
+        [&](const analysis::isolated_job& job, analysis::worker_output output) {
+            outputs[job.tag] = std::move(output);
+        });
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Five 300ms jobs on three workers take two rounds, not five
+    BOOST_TEST(elapsed < std::chrono::milliseconds(1200));
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i == 2) {
+            BOOST_TEST((outputs[i].result.failure == analysis::failure_kind::crashed));
+            BOOST_TEST(outputs[i].result.file == "job2.cpp");
+        } else {
+            BOOST_TEST(outputs[i].result.success);
+            BOOST_REQUIRE_EQUAL(outputs[i].dependencies.size(), 1u);
+            BOOST_TEST(outputs[i].dependencies[0] == "dep" + std::to_string(i) + ".hpp");
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_isolation_keeps_jobs) {
+    analysis::ast_detector detector;
+    detector.set_jobs(8);
+    detector.set_process_isolation(true);
+    BOOST_TEST(detector.effective_jobs() == 8u);
+}
+
+BOOST_AUTO_TEST_CASE(test_hard_timeout_kills_worker) {
+    auto result = analysis::run_isolated("slow.cpp", [] {
+        std::this_thread::sleep_for(std::chrono::seconds(30));
+        return analysis::file_analysis_result{};
+    }, 0, 0.2);
+
+    BOOST_TEST(!result.success);
+    BOOST_TEST((result.failure == analysis::failure_kind::limit_exceeded));
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
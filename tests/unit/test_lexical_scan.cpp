@@ -0,0 +1,121 @@
+// Boost.SafeProfile - Lexical prefilter tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/lexical_scan.hpp"
+#include "analysis/detector.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+
+namespace fs = boost::filesystem;
+using namespace boost::safeprofile;
+namespace triggers = analysis::triggers;
+
+BOOST_AUTO_TEST_SUITE(lexical_scan_tests)
+
+namespace {
+
+analysis::trigger_mask scan(const std::string& source) {
+    return analysis::scan_triggers(source);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_keywords) {
+    BOOST_TEST(scan("int* p = new int(1);") == triggers::new_keyword);
+    BOOST_TEST(scan("void f(int* p) { delete p; }") == triggers::delete_keyword);
+    BOOST_TEST(scan("int x = 1; int y = x + 2;") == 0u);
+
+    // Deleted functions are not delete expressions
+    BOOST_TEST(scan("struct s { s(const s&) = delete; };") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_comments_and_literals_ignored) {
+    BOOST_TEST(scan("// new int\n/* delete p; */\nconst char* s = \"new (int)x\";\n") == 0u);
+    BOOST_TEST(scan("auto s = R\"(delete p; return &x;)\";\n") == 0u);
+    BOOST_TEST(scan("#include <new>\n#if defined(NEW_API)\n#endif\n") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_casts) {
+    BOOST_TEST(scan("int i = (int)d;") == triggers::cast);
+    BOOST_TEST(scan("auto p = (const char*)&buffer;") == triggers::cast);
+    BOOST_TEST(scan("return (unsigned)-x;") == triggers::cast);
+    BOOST_TEST(scan("(void)[&] { run(); }();") == triggers::cast);
+
+    // Operator keywords, including the alternative spellings, precede operands
+    BOOST_TEST(scan("void f(void* p) { delete (int*)p; }") == (triggers::delete_keyword | triggers::cast));
+    BOOST_TEST((scan("auto p = new (int*)(q);") & triggers::cast));
+    for (const char* keyword : {"and", "or", "not", "xor", "bitand", "bitor", "compl"}) {
+        BOOST_TEST((scan(std::string("auto r = a ") + keyword + " (int)b;") & triggers::cast),
+                   "after " << keyword);
+    }
+
+    // Calls, conditions, declarators and grouping are not casts
+    BOOST_TEST(scan("f(x); if (x) y(); while (x) --x; int z = (a) / b;") == 0u);
+    BOOST_TEST(scan("std::size_t n = sizeof(int); void (*fp)(int) = nullptr;") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_returns) {
+    BOOST_TEST(scan("int* f() { int x = 0; return &x; }") == triggers::return_local);
+    BOOST_TEST(scan("int& f() { int x = 0; return x; }") == triggers::return_local);
+    BOOST_TEST(scan("int f() { return 1; }") == 0u);
+    BOOST_TEST(scan("int f(int x) { return x + 1; }") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_macros) {
+    // A macro from elsewhere may expand to anything
+    BOOST_TEST(scan("int* p = MAKE_INT(1);") == triggers::macro);
+
+    // One defined here is scanned where it is defined
+    BOOST_TEST(scan("#define MAKE_INT(v) new int(v)\nint* p = MAKE_INT(1);\n") == triggers::new_keyword);
+    BOOST_TEST(scan("#define LIMIT 10\nint a = LIMIT;\n") == 0u);
+    BOOST_TEST(scan("int line = __LINE__;") == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_may_fire) {
+    BOOST_TEST(analysis::may_fire(0, 0));
+    BOOST_TEST(analysis::may_fire(triggers::new_keyword, triggers::new_keyword | triggers::cast));
+    BOOST_TEST(!analysis::may_fire(triggers::new_keyword, triggers::delete_keyword));
+    BOOST_TEST(analysis::may_fire(triggers::new_keyword, triggers::macro));
+}
+
+BOOST_AUTO_TEST_CASE(test_find_triggers_in_order) {
+    const std::string source = "int* p = new int;\n// delete p;\nMACRO(x); delete p; int i = (int)d;\n";
+    auto matches = analysis::find_triggers(source);
+    BOOST_REQUIRE_EQUAL(matches.size(), 3u);
+    BOOST_TEST(matches[0].trigger == triggers::new_keyword);
+    BOOST_TEST(matches[0].offset == source.find("new"));
+    BOOST_TEST(matches[1].trigger == triggers::delete_keyword);
+    BOOST_TEST(matches[1].offset == source.rfind("delete"));
+    BOOST_TEST(matches[2].trigger == triggers::cast);
+    BOOST_TEST(matches[2].offset == source.find("(int)"));
+}
+
+BOOST_AUTO_TEST_CASE(test_triage_of_unparsable_file) {
+    auto path = fs::temp_directory_path() / fs::unique_path("sp-triage-%%%%%%%%.cpp");
+    std::ofstream(path.string()) << "void f( {\n"
+                                    "    int* p = new int(1);  // not: delete\n"
+                                    "    delete p; return (long)p;\n";
+
+    std::vector<profile::rule> rules(3);
+    rules[0].id = "SP-OWN-001";
+    rules[1].id = "SP-OWN-002";
+    rules[2].id = "SP-LIFE-003";  // Needs an AST: never reported
+
+    auto findings = analysis::detector().analyze({path}, rules);
+    BOOST_REQUIRE_EQUAL(findings.size(), 2u);
+    BOOST_TEST(findings[0].rule_id == "SP-OWN-001");
+    BOOST_TEST(findings[0].line_number == 2);
+    BOOST_TEST(findings[0].column_number == 14);
+    BOOST_TEST(findings[0].snippet == "int* p = new int(1);  // not: delete");
+    BOOST_TEST(findings[0].lexical);
+    BOOST_TEST(findings[1].rule_id == "SP-OWN-002");
+    BOOST_TEST(findings[1].line_number == 3);
+    BOOST_TEST(findings[1].column_number == 5);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+// Boost.SafeProfile - Language server tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "server/lsp.hpp"
+#include <boost/filesystem.hpp>
+#include <sstream>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace json = boost::json;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(lsp_tests)
+
+namespace {
+
+json::object request(int id, const char* method, json::object params) {
+    return json::object{{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", std::move(params)}};
+}
+
+json::object notification(const char* method, json::object params) {
+    return json::object{{"jsonrpc", "2.0"}, {"method", method}, {"params", std::move(params)}};
+}
+
+const json::array& published(const std::vector<json::object>& outgoing) {
+    BOOST_REQUIRE_EQUAL(outgoing.size(), 1u);
+    BOOST_REQUIRE(outgoing[0].at("method").as_string() == "textDocument/publishDiagnostics");
+    return outgoing[0].at("params").at("diagnostics").as_array();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_message_framing) {
+    std::stringstream stream;
+    server::write_message(stream, json::object{{"id", 1}});
+    server::write_message(stream, json::object{{"id", 2}});
+    BOOST_TEST(stream.str().rfind("Content-Length: 8\r\n\r\n{\"id\":1}", 0) == 0u);
+
+    auto first = server::read_message(stream);
+    auto second = server::read_message(stream);
+    BOOST_REQUIRE(first && second);
+    BOOST_TEST(*first == "{\"id\":1}");
+    BOOST_TEST(*second == "{\"id\":2}");
+    BOOST_TEST(!server::read_message(stream));
+
+    std::stringstream bad("Content-Length 5\r\n\r\nhello");
+    BOOST_CHECK_THROW(server::read_message(bad), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_uri_conversion) {
+    BOOST_TEST(server::uri_from_path("/src/my file.cpp") == "file:///src/my%20file.cpp");
+    BOOST_TEST(server::path_from_uri("file:///src/my%20file.cpp").generic_string() == "/src/my file.cpp");
+    BOOST_TEST(server::path_from_uri("file://localhost/src/a.cpp").generic_string() == "/src/a.cpp");
+    BOOST_TEST(server::path_from_uri("file:///C:/src/a.cpp").generic_string() == "C:/src/a.cpp");
+    BOOST_CHECK_THROW(server::path_from_uri("https://example.com/a.cpp"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_publishes_diagnostics) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-lsp-%%%%%%%%");
+    fs::create_directories(dir);
+    std::string uri = server::uri_from_path(dir / "edit.cpp");
+
+    server::language_server server{cli::analyze_args{}};
+    std::vector<json::object> outgoing;
+
+    server.handle(request(1, "initialize", json::object{{"rootUri", server::uri_from_path(dir)}}), outgoing);
+    BOOST_REQUIRE_EQUAL(outgoing.size(), 1u);
+    BOOST_TEST(outgoing[0].at("result").at("capabilities").at("textDocumentSync").at("change").as_int64() == 1);
+
+    // The buffer is analyzed, not the (nonexistent) file on disk
+    outgoing.clear();
+    json::object item{{"uri", uri}, {"languageId", "cpp"}, {"version", 1},
+                      {"text", "void f() {\n    int* p = new int(1);\n    delete p;\n}\n"}};
+    server.handle(notification("textDocument/didOpen", json::object{{"textDocument", item}}), outgoing);
+    const auto& opened = published(outgoing);
+    BOOST_REQUIRE_EQUAL(opened.size(), 2u);
+    BOOST_TEST(opened[0].at("code").as_string() == "SP-OWN-001");
+    BOOST_TEST(opened[0].at("range").at("start").at("line").as_int64() == 1);
+    BOOST_TEST(opened[0].at("severity").as_int64() == 1);
+
+    outgoing.clear();
+    json::object change{{"text", "void f() {\n    int value = 1;\n    (void)value;\n}\n"}};
+    server.handle(notification("textDocument/didChange", json::object{
+        {"textDocument", json::object{{"uri", uri}, {"version", 2}}},
+        {"contentChanges", json::array{change}}}), outgoing);
+    BOOST_TEST(published(outgoing).empty());
+    BOOST_TEST(outgoing[0].at("params").at("version").as_int64() == 2);
+
+    outgoing.clear();
+    server.handle(request(2, "textDocument/hover", json::object{}), outgoing);
+    BOOST_REQUIRE_EQUAL(outgoing.size(), 1u);
+    BOOST_TEST(outgoing[0].at("error").at("code").as_int64() == -32601);
+
+    outgoing.clear();
+    server.handle(request(3, "shutdown", json::object{}), outgoing);
+    server.handle(notification("exit", json::object{}), outgoing);
+    BOOST_REQUIRE_EQUAL(outgoing.size(), 1u);
+    BOOST_TEST(outgoing[0].at("result").is_null());
+    BOOST_TEST(server.exited());
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
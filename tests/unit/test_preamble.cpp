@@ -0,0 +1,63 @@
+// Boost.SafeProfile - Shared include prefix tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/preamble.hpp"
+
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(preamble_tests)
+
+BOOST_AUTO_TEST_CASE(test_scan_stops_at_first_other_line) {
+    std::string source =
+        "// Copyright\n"
+        "/* multi\n"
+        "   line */ #include <a.hpp>\n"
+        "#pragma once\n"
+        "#include<b.hpp> // why\n"
+        "#include \"local.hpp\"\n"
+        "#include <c.hpp>\n";
+
+    auto prefix = analysis::scan_include_prefix(source);
+
+    std::vector<std::string> expected = {"<a.hpp>", "<b.hpp>"};
+    BOOST_TEST(prefix.headers == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_blank_keeps_positions) {
+    std::string source = "/* x */ #include <a.hpp>\n#include <b.hpp>\nint x;\n";
+    auto prefix = analysis::scan_include_prefix(source);
+    BOOST_REQUIRE_EQUAL(prefix.headers.size(), 2u);
+
+    std::string blanked = source;
+    analysis::blank_include_prefix(blanked, prefix, 1);
+
+    BOOST_TEST(blanked.size() == source.size());
+    BOOST_TEST(blanked.substr(0, 8) == "/* x */ ");
+    BOOST_TEST(blanked.find("#include <a.hpp>") == std::string::npos);
+    BOOST_TEST(blanked.find("#include <b.hpp>") == source.find("#include <b.hpp>"));
+}
+
+BOOST_AUTO_TEST_CASE(test_plan_respects_flags) {
+    std::vector<analysis::include_prefix> prefixes(4);
+    prefixes[0].headers = {"<a>", "<b>", "<c>"};
+    prefixes[1].headers = {"<a>", "<b>", "<c>"};
+    prefixes[2].headers = {"<a>", "<b>"};
+    prefixes[3].headers = {"<a>", "<b>", "<c>"};
+
+    // TU 3 has the same includes but different flags
+    std::vector<std::string> keys = {"-std=c++20", "-std=c++20", "-std=c++20", "-std=c++17"};
+
+    auto plan = analysis::plan_preambles(keys, prefixes);
+
+    BOOST_REQUIRE_EQUAL(plan.preambles.size(), 1u);
+    BOOST_TEST(plan.preambles[0].headers.size() == 3u);
+    BOOST_TEST(plan.preambles[0].users == 2u);
+    BOOST_TEST(plan.assignment[0].has_value());
+    BOOST_TEST(plan.assignment[1].has_value());
+    BOOST_TEST(!plan.assignment[2].has_value());  // Alone at depth 2
+    BOOST_TEST(!plan.assignment[3].has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
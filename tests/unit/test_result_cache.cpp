@@ -0,0 +1,126 @@
+// Boost.SafeProfile - Persistent result cache tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/result_cache.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace fs = boost::filesystem;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(result_cache_tests)
+
+namespace {
+
+analysis::cached_result make_entry(const fs::path& file) {
+    analysis::cached_result entry;
+    entry.result.file = file;
+    entry.result.success = true;
+    entry.result.findings.push_back(
+        analysis::ast_finding{file, 3, 5, "naked new", "SP-OWN-001", profile::severity::major, "new int"});
+    entry.included.push_back(file.parent_path() / "a.hpp");
+    return entry;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_hash_builder_separates_fields) {
+    analysis::hash_builder joined;
+    joined.add("ab").add("c");
+    analysis::hash_builder split;
+    split.add("a").add("bc");
+    analysis::hash_builder again;
+    again.add("ab").add("c");
+
+    auto first = joined.hex();
+    BOOST_TEST(first.size() == 40u);
+    BOOST_TEST(first != split.hex());
+    BOOST_TEST(first == again.hex());
+}
+
+BOOST_AUTO_TEST_CASE(test_dependency_edit_invalidates) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-cache-%%%%%%%%");
+    fs::create_directories(dir);
+    auto header = (dir / "a.hpp").string();
+    std::ofstream(header) << "int a;\n";
+
+    analysis::result_cache cache(dir / "cache");
+    {
+        auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+        BOOST_TEST(!cache.lookup("key", *files));
+        cache.store("key", {header}, make_entry(dir / "a.cpp"), *files);
+    }
+
+    // A later run with the same inputs hits
+    {
+        auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+        auto hit = cache.lookup("key", *files);
+        BOOST_REQUIRE(hit);
+        BOOST_TEST(hit->result.success);
+        BOOST_REQUIRE_EQUAL(hit->result.findings.size(), 1u);
+        BOOST_TEST(hit->result.findings[0].line == 3u);
+        BOOST_TEST(hit->result.findings[0].rule_id == "SP-OWN-001");
+        BOOST_REQUIRE_EQUAL(hit->included.size(), 1u);
+        BOOST_TEST(hit->included[0] == dir / "a.hpp");
+        BOOST_TEST(!cache.lookup("other", *files));
+    }
+
+    // Editing an included file misses
+    std::ofstream(header) << "int b;\n";
+    {
+        auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+        BOOST_TEST(!cache.lookup("key", *files));
+    }
+
+    BOOST_TEST(cache.hits() == 1u);
+    BOOST_TEST(cache.misses() == 3u);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_project_header_membership_invalidates) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-cache-%%%%%%%%");
+    fs::create_directories(dir);
+    auto header = (dir / "a.hpp").string();
+    auto other = (dir / "b.hpp").string();
+    std::ofstream(header) << "int a;\n";
+    std::ofstream(other) << "int b;\n";
+
+    analysis::result_cache cache(dir / "cache");
+    auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    auto entry = make_entry(dir / "a.cpp");
+    entry.attributed.push_back(header);
+    cache.store("key", {header, other}, entry, *files);
+
+    auto unrelated = [&](const fs::path& file) { return file == header || file == dir / "c.hpp"; };
+    auto a_and_b = [&](const fs::path& file) { return file == header || file == other; };
+    auto none = [](const fs::path&) { return false; };
+
+    // Headers the TU did not read may come and go
+    BOOST_TEST(static_cast<bool>(cache.lookup("key", *files, unrelated)));
+    // A file it read that changed membership either way misses
+    BOOST_TEST(!cache.lookup("key", *files, a_and_b));
+    BOOST_TEST(!cache.lookup("key", *files, none));
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_corrupt_entry_is_a_miss) {
+    auto dir = fs::temp_directory_path() / fs::unique_path("sp-cache-%%%%%%%%");
+    fs::create_directories(dir / "ke");
+    std::ofstream((dir / "ke" / "key").string()) << "{not json";
+
+    analysis::result_cache cache(dir);
+    auto files = llvm::makeIntrusiveRefCnt<analysis::caching_file_system>();
+    BOOST_TEST(!cache.lookup("key", *files));
+
+    // The next store replaces it
+    cache.store("key", {}, make_entry(dir / "a.cpp"), *files);
+    BOOST_TEST(static_cast<bool>(cache.lookup("key", *files)));
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+// Boost.SafeProfile - TU scheduler tests
+// Copyright (c) 2025 The Boost Authors
+// Distributed under the Boost Software License, Version 1.0.
+
+#include <boost/test/unit_test.hpp>
+#include "analysis/scheduler.hpp"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <set>
+
+namespace fs = boost::filesystem;
+using namespace boost::safeprofile;
+
+BOOST_AUTO_TEST_SUITE(scheduler_tests)
+
+BOOST_AUTO_TEST_CASE(test_queue_runs_longest_first) {
+    std::vector<double> costs = {1.0, 5.0, 3.0, 4.0};
+    analysis::work_queue queue(costs, 1);
+
+    std::vector<std::size_t> order;
+    while (auto index = queue.next(0)) {
+        order.push_back(*index);
+    }
+
+    std::vector<std::size_t> expected = {1, 3, 2, 0};
+    BOOST_TEST(order == expected, boost::test_tools::per_element());
+    BOOST_TEST(queue.steals() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_idle_worker_steals) {
+    std::vector<double> costs = {9.0, 8.0, 7.0, 6.0};
+    analysis::work_queue queue(costs, 2);
+
+    // Worker 1 drains its own lane, then steals worker 0's remaining item
+    std::set<std::size_t> seen;
+    while (auto index = queue.next(1)) {
+        BOOST_TEST(seen.insert(*index).second);
+    }
+
+    BOOST_TEST(seen.size() == 4u);
+    BOOST_TEST(queue.steals() == 2u);
+    BOOST_TEST(!queue.next(0).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(test_groups_run_back_to_back) {
+    // Two groups interleaved in discovery order; group 7 is too big for one worker
+    std::vector<double> costs = {4.0, 1.0, 3.0, 1.0, 2.0, 1.0};
+    std::vector<std::size_t> groups = {7, 3, 7, 3, 7, 3};
+    analysis::work_queue queue(costs, groups, 2);
+
+    auto take = [&](std::size_t worker, std::size_t count) {
+        std::vector<std::size_t> order;
+        while (order.size() < count) {
+            order.push_back(queue.next(worker).value());
+        }
+        return order;
+    };
+
+    // The share is 6: group 7 splits into {0} and {2, 4}, group 3 stays
+    // whole, and the runs go to the least loaded lane longest first
+    std::vector<std::size_t> expected_first = {2, 4};
+    std::vector<std::size_t> expected_second = {0, 1, 3, 5};
+    BOOST_TEST(take(0, 2) == expected_first, boost::test_tools::per_element());
+    BOOST_TEST(take(1, 4) == expected_second, boost::test_tools::per_element());
+    BOOST_TEST(!queue.next(0).has_value());
+    BOOST_TEST(queue.steals() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_cost_history_round_trip) {
+    fs::path file = fs::temp_directory_path() / fs::unique_path("safeprofile_costs_%%%%-%%%%.json");
+
+    analysis::cost_history history;
+    history.record("a.cpp", analysis::tu_timing{1.5, 0.25});
+    history.save(file);
+
+    analysis::cost_history loaded;
+    BOOST_REQUIRE(loaded.load(file));
+    auto timing = loaded.lookup("a.cpp");
+    BOOST_REQUIRE(timing.has_value());
+    BOOST_TEST(timing->parse_seconds == 1.5);
+    BOOST_TEST(timing->match_seconds == 0.25);
+    BOOST_TEST(!loaded.lookup("b.cpp").has_value());
+
+    fs::remove(file);
+}
+
+BOOST_AUTO_TEST_CASE(test_estimate_prefers_history) {
+    fs::path dir = fs::temp_directory_path() / fs::unique_path("safeprofile_sched_%%%%-%%%%");
+    fs::create_directories(dir);
+
+    fs::path small = dir / "small.cpp";
+    fs::path large = dir / "large.cpp";
+    std::ofstream(small.string()) << "int x;\n";
+    std::ofstream(large.string()) << "#include <vector>\n#include <map>\nint y;\n";
+
+    // Without history, the file with more includes is estimated as costlier
+    auto heuristic = analysis::estimate_costs({small, large}, nullptr);
+    BOOST_TEST(heuristic[1] > heuristic[0]);
+
+    // Recorded timings win over the heuristic
+    analysis::cost_history history;
+    history.record(small, analysis::tu_timing{10.0, 0.0});
+    history.record(large, analysis::tu_timing{1.0, 0.0});
+    auto measured = analysis::estimate_costs({small, large}, &history);
+    BOOST_TEST(measured[0] == 10.0);
+    BOOST_TEST(measured[1] == 1.0);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_estimate_scales_unknown_to_history) {
+    fs::path dir = fs::temp_directory_path() / fs::unique_path("safeprofile_sched_%%%%-%%%%");
+    fs::create_directories(dir);
+
+    // The timed file does not exist; it must not need to be read
+    fs::path timed = dir / "timed.cpp";
+    fs::path fresh = dir / "fresh.cpp";
+    std::ofstream(fresh.string()) << "int z;\n";
+
+    analysis::cost_history history;
+    history.record(timed, analysis::tu_timing{4.0, 0.0});
+    auto costs = analysis::estimate_costs({timed, fresh}, &history);
+    BOOST_TEST(costs[0] == 4.0);
+    BOOST_TEST(costs[1] == 4.0);
+
+    fs::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()